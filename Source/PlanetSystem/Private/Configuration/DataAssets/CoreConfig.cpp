@@ -37,6 +37,12 @@ void UPlanetCoreConfig::InitializeDefaultValues()
     BiomeConfig.SnowAltitudeThreshold = 0.8f;
     BiomeConfig.ForestHumidityThreshold = 0.6f;
     BiomeConfig.PlainsSlopeThreshold = 0.3f;
+    BiomeConfig.SnowTemperatureThreshold = 0.15f;
+    BiomeConfig.MaxAltitude = 200.0f;
+    BiomeConfig.AltitudeTemperatureLapse = 0.5f;
+    BiomeConfig.bSmoothTransitions = true;
+    BiomeConfig.TransitionWidth = 0.05f;
+    BiomeConfig.TransitionBlurRadius = 1;
     
     // Configurações de debug e performance
     bEnableDebugVisualization = false;
@@ -0,0 +1,93 @@
+#include "Core/Cache/PlanetCacheInstrumentation.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+    TAutoConsoleVariable<int32> CVarCacheTraceSampleRate(
+        TEXT("planet.Cache.TraceSampleRate"),
+        256,
+        TEXT("Rastreia 1 a cada N operações dos caches de chunks (eventos, profiler, log). 0 desliga."),
+        ECVF_Default);
+
+    TAutoConsoleVariable<bool> CVarCacheVerbose(
+        TEXT("planet.Cache.Verbose"),
+        false,
+        TEXT("Log, eventos e profiler em toda operação dos caches de chunks (lento)."),
+        ECVF_Default);
+}
+
+bool FPlanetCacheInstrumentation::ShouldTrace()
+{
+    if (CVarCacheVerbose.GetValueOnAnyThread())
+    {
+        return true;
+    }
+
+    const int32 SampleRate = GetSampleRate();
+    if (SampleRate <= 0)
+    {
+        return false;
+    }
+
+    // contador por thread: amostrar não disputa nenhuma linha de cache
+    static thread_local uint32 Sequence = 0;
+    return ++Sequence % uint32(SampleRate) == 0;
+}
+
+bool FPlanetCacheInstrumentation::IsVerbose()
+{
+    return CVarCacheVerbose.GetValueOnAnyThread();
+}
+
+int32 FPlanetCacheInstrumentation::GetSampleRate()
+{
+    return CVarCacheTraceSampleRate.GetValueOnAnyThread();
+}
+
+FPlanetCacheInstrumentation::FOpStats FPlanetCacheInstrumentation::GetStats(EPlanetCacheOp Op) const
+{
+    const FCounters& Counter = Counters[uint8(Op)];
+
+    FOpStats Stats;
+    Stats.Calls = Counter.Calls.load(std::memory_order_relaxed);
+    Stats.Hits = Counter.Hits.load(std::memory_order_relaxed);
+    Stats.Sampled = Counter.Sampled.load(std::memory_order_relaxed);
+    Stats.SampledSeconds = FPlatformTime::ToSeconds64(Counter.SampledCycles.load(std::memory_order_relaxed));
+    return Stats;
+}
+
+void FPlanetCacheInstrumentation::ResetStats()
+{
+    for (FCounters& Counter : Counters)
+    {
+        Counter.Calls.store(0, std::memory_order_relaxed);
+        Counter.Hits.store(0, std::memory_order_relaxed);
+        Counter.Sampled.store(0, std::memory_order_relaxed);
+        Counter.SampledCycles.store(0, std::memory_order_relaxed);
+    }
+}
+
+FString FPlanetCacheInstrumentation::GetReport() const
+{
+    FString Report;
+    for (uint8 Op = 0; Op < uint8(EPlanetCacheOp::Num); ++Op)
+    {
+        const FOpStats Stats = GetStats(EPlanetCacheOp(Op));
+        const double AverageMicros = Stats.Sampled > 0 ? Stats.SampledSeconds / Stats.Sampled * 1000000.0 : 0.0;
+        Report += FString::Printf(TEXT("- %s: %lld calls, %lld hits, %.3f us avg (%lld samples)\n"),
+            GetOpName(EPlanetCacheOp(Op)), Stats.Calls, Stats.Hits, AverageMicros, Stats.Sampled);
+    }
+    return Report;
+}
+
+const TCHAR* FPlanetCacheInstrumentation::GetOpName(EPlanetCacheOp Op)
+{
+    switch (Op)
+    {
+    case EPlanetCacheOp::Find: return TEXT("Find");
+    case EPlanetCacheOp::Add:  return TEXT("Add");
+    case EPlanetCacheOp::Has:  return TEXT("Has");
+    default:                   return TEXT("Unknown");
+    }
+}
@@ -0,0 +1,109 @@
+#include "Core/Cache/PlanetCacheMemory.h"
+#include "Debug/Logging/PlanetSystemLogger.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Containers/Ticker.h"
+#include "Misc/CoreDelegates.h"
+#include <atomic>
+
+LLM_DEFINE_TAG(PlanetRenderChunkCache);
+LLM_DEFINE_TAG(PlanetChunkCache);
+LLM_DEFINE_TAG(PlanetNetworkChunkCache);
+
+namespace
+{
+    std::atomic<int64> LowMemoryThreshold { 512ll * 1024 * 1024 };
+
+    // estado da histerese (game thread)
+    bool bLowMemory = false;
+    double LastTrimTime = 0.0;
+}
+
+FPlanetCacheMemory::FOnTrim& FPlanetCacheMemory::OnTrim()
+{
+    static FOnTrim Delegate;
+    static bool bHooked = false;
+    if (!bHooked)
+    {
+        bHooked = true;
+
+        // A engine pede trim sob pressão de memória (ex.: aviso do SO): mantém metade
+        FCoreDelegates::GetMemoryTrimDelegate().AddStatic([]() { TrimAll(0.5f); });
+
+        // Uma verificação para o processo inteiro, qualquer que seja o número de planetas e caches
+        FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([](float)
+        {
+            CheckMemoryPressure();
+            return true;
+        }), CheckIntervalSeconds);
+    }
+    return Delegate;
+}
+
+void FPlanetCacheMemory::TrimAll(float KeepFraction)
+{
+    check(IsInGameThread());
+
+    KeepFraction = FMath::Clamp(KeepFraction, 0.0f, 1.0f);
+    if (KeepFraction >= 1.0f)
+    {
+        return;
+    }
+
+    UPlanetSystemLogger::LogWarning(TEXT("PlanetCacheMemory"),
+        FString::Printf(TEXT("Memory pressure: trimming chunk caches to %.0f%%"), KeepFraction * 100.0f));
+    OnTrim().Broadcast(KeepFraction);
+}
+
+float FPlanetCacheMemory::CheckMemoryPressure()
+{
+    check(IsInGameThread());
+
+    const int64 Threshold = LowMemoryThreshold;
+    if (Threshold <= 0)
+    {
+        bLowMemory = false;
+        return 1.0f;
+    }
+
+    const int64 Available = int64(FPlatformMemory::GetStats().AvailablePhysical);
+    if (bLowMemory && Available >= int64(Threshold * double(RecoveryFactor)))
+    {
+        bLowMemory = false;
+        return 1.0f;
+    }
+    if (Available >= Threshold)
+    {
+        return 1.0f;
+    }
+
+    // Abaixo do limite: trim ao entrar no estado; depois só a cada TrimCooldownSeconds, dando tempo
+    // para a memória liberada aparecer antes de cortar de novo
+    const double Now = FPlatformTime::Seconds();
+    if (bLowMemory && Now - LastTrimTime < TrimCooldownSeconds)
+    {
+        return 1.0f;
+    }
+    bLowMemory = true;
+    LastTrimTime = Now;
+
+    // Quanto maior o déficit, menor a fração mantida
+    const float KeepFraction = FMath::Max(MinKeepFraction, float(double(Available) / double(Threshold)));
+    TrimAll(KeepFraction);
+    return KeepFraction;
+}
+
+bool FPlanetCacheMemory::IsLowMemory()
+{
+    return bLowMemory;
+}
+
+void FPlanetCacheMemory::SetLowMemoryThreshold(int64 Bytes)
+{
+    LowMemoryThreshold = FMath::Max<int64>(0, Bytes);
+}
+
+int64 FPlanetCacheMemory::GetLowMemoryThreshold()
+{
+    return LowMemoryThreshold;
+}
@@ -0,0 +1,158 @@
+#include "Core/Cache/PlanetCacheTrace.h"
+#include "Core/Cache/PlanetShardedCache.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+    constexpr uint32 TraceMagic = 0x54434350; // "PCCT"
+    constexpr uint32 TraceVersion = 1;
+
+    const TCHAR* GetPolicyName(EPlanetCachePolicy Policy)
+    {
+        switch (Policy)
+        {
+            case EPlanetCachePolicy::LRU:      return TEXT("LRU");
+            case EPlanetCachePolicy::LFU:      return TEXT("LFU");
+            case EPlanetCachePolicy::Random:   return TEXT("Random");
+            case EPlanetCachePolicy::Priority: return TEXT("Priority");
+            case EPlanetCachePolicy::GDSF:     return TEXT("GDSF");
+            default:                           return TEXT("Unknown");
+        }
+    }
+}
+
+void FPlanetCacheTrace::RecordLookup(uint64 Key)
+{
+    FScopeLock Lock(&Mutex);
+    Events.Add(FEvent{ Key, -1, 0.0f });
+}
+
+void FPlanetCacheTrace::RecordStore(uint64 Key, int64 Bytes, double Cost)
+{
+    FScopeLock Lock(&Mutex);
+    Events.Add(FEvent{ Key, FMath::Max<int64>(Bytes, 0), float(Cost) });
+}
+
+int32 FPlanetCacheTrace::Num() const
+{
+    FScopeLock Lock(&Mutex);
+    return Events.Num();
+}
+
+bool FPlanetCacheTrace::Save(const FString& FilePath) const
+{
+    TArray<uint8> Bytes;
+    FMemoryWriter Ar(Bytes);
+
+    uint32 Magic = TraceMagic;
+    uint32 Version = TraceVersion;
+    Ar << Magic << Version;
+    {
+        FScopeLock Lock(&Mutex);
+        Ar << const_cast<TArray<FEvent>&>(Events);
+    }
+    return FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+}
+
+bool FPlanetCacheTrace::Load(const FString& FilePath)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+    {
+        return false;
+    }
+
+    FMemoryReader Ar(Bytes);
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    Ar << Magic << Version;
+    if (Magic != TraceMagic || Version != TraceVersion)
+    {
+        return false;
+    }
+
+    TArray<FEvent> Loaded;
+    Ar << Loaded;
+    if (Ar.IsError())
+    {
+        return false;
+    }
+
+    FScopeLock Lock(&Mutex);
+    Events = MoveTemp(Loaded);
+    return true;
+}
+
+FPlanetCacheTrace::FResult FPlanetCacheTrace::Replay(EPlanetCachePolicy Policy, int64 MaxBytes) const
+{
+    FScopeLock Lock(&Mutex);
+
+    // tamanho e custo de cada chave (última inserção registrada)
+    TMap<uint64, TPair<int64, float>> Sizes;
+    for (const FEvent& Event : Events)
+    {
+        if (Event.Bytes >= 0)
+        {
+            Sizes.Add(Event.Key, TPair<int64, float>(Event.Bytes, Event.Cost));
+        }
+    }
+
+    // um shard: o replay é sequencial e o resultado não depende da distribuição das chaves
+    TPlanetShardedCache<uint64, uint8> Cache(1);
+    Cache.SetMaxEntries(MAX_int32);
+    Cache.SetMaxBytes(MaxBytes);
+    Cache.SetPolicy(Policy);
+    const TSharedRef<const uint8, ESPMode::ThreadSafe> Dummy = MakeShared<const uint8, ESPMode::ThreadSafe>(uint8(0));
+
+    FResult Result;
+    Result.Policy = Policy;
+    for (const FEvent& Event : Events)
+    {
+        const TPair<int64, float>* Size = Event.Bytes < 0 ? Sizes.Find(Event.Key) : nullptr;
+        if (!Size)
+        {
+            // inserções são simuladas pelas falhas; consultas sem tamanho conhecido não contam
+            continue;
+        }
+
+        Result.Lookups++;
+        Result.TotalCost += Size->Value;
+        if (Cache.Find(Event.Key).IsValid())
+        {
+            Result.Hits++;
+            Result.SavedCost += Size->Value;
+        }
+        else
+        {
+            Cache.Store(Event.Key, Dummy, Size->Key, 1.0f, Size->Value);
+        }
+    }
+    return Result;
+}
+
+FString FPlanetCacheTrace::Compare(int64 MaxBytes) const
+{
+    const EPlanetCachePolicy Policies[] = {
+        EPlanetCachePolicy::LRU, EPlanetCachePolicy::LFU, EPlanetCachePolicy::Random,
+        EPlanetCachePolicy::Priority, EPlanetCachePolicy::GDSF };
+
+    FString Report = FString::Printf(TEXT("Cache trace replay: %d events, budget %.1f MB\n"), Num(), MaxBytes / (1024.0 * 1024.0));
+    Report += TEXT("Policy     Hit rate   Cost hit rate   vs LRU (cost)\n");
+
+    double LRUCostHitRate = 0.0;
+    for (EPlanetCachePolicy Policy : Policies)
+    {
+        const FResult Result = Replay(Policy, MaxBytes);
+        if (Policy == EPlanetCachePolicy::LRU)
+        {
+            LRUCostHitRate = Result.GetCostHitRate();
+        }
+
+        Report += FString::Printf(TEXT("%-10s %7.2f%%   %12.2f%%   %+8.2f%%\n"),
+            GetPolicyName(Policy), Result.GetHitRate() * 100.0, Result.GetCostHitRate() * 100.0,
+            (Result.GetCostHitRate() - LRUCostHitRate) * 100.0);
+    }
+    return Report;
+}
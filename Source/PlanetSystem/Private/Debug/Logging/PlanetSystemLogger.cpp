@@ -2,6 +2,7 @@
 #include "HAL/PlatformFilemanager.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
 
 UPlanetSystemLogger* UPlanetSystemLogger::Instance = nullptr;
 
@@ -55,7 +56,10 @@ void UPlanetSystemLogger::Initialize(const FString& InLogFilePath)
     // Escreve cabeçalho do log
     FString Header = FString::Printf(TEXT("=== PlanetSystem Log Started at %s ===\n"), 
                                     *FDateTime::Now().ToString());
-    WriteToFile(Header);
+    {
+        FScopeLock Lock(&LogLock);
+        WriteToFile(Header);
+    }
     
     Log(TEXT("Logging system initialized"), EPlanetLogLevel::Info, EPlanetLogCategory::General);
 }
@@ -67,8 +71,12 @@ void UPlanetSystemLogger::Shutdown()
         Log(TEXT("Logging system shutting down"), EPlanetLogLevel::Info, EPlanetLogCategory::General);
         
         // Escreve estatísticas finais
+        TMap<EPlanetLogLevel, int32> Counts;
+        FString Path;
+        GetLogStatistics(Counts, Path);
+        
         FString Stats;
-        for (const auto& Pair : LogCounts)
+        for (const auto& Pair : Counts)
         {
             if (Pair.Value > 0)
             {
@@ -86,6 +94,7 @@ void UPlanetSystemLogger::Shutdown()
         
         FString Footer = FString::Printf(TEXT("=== PlanetSystem Log Ended at %s ===\n"), 
                                         *FDateTime::Now().ToString());
+        FScopeLock Lock(&LogLock);
         WriteToFile(Footer);
     }
     
@@ -98,20 +107,26 @@ void UPlanetSystemLogger::Shutdown()
 
 void UPlanetSystemLogger::SetMinLogLevel(EPlanetLogLevel Level)
 {
-    MinLogLevel = Level;
+    {
+        FScopeLock Lock(&LogLock);
+        MinLogLevel = Level;
+    }
     Log(FString::Printf(TEXT("Minimum log level set to: %s"), *GetLogLevelName(Level)), 
         EPlanetLogLevel::Info, EPlanetLogCategory::General);
 }
 
 void UPlanetSystemLogger::SetCategoryEnabled(EPlanetLogCategory Category, bool bEnabled)
 {
-    if (bEnabled)
     {
-        EnabledCategories.Add(Category);
-    }
-    else
-    {
-        EnabledCategories.Remove(Category);
+        FScopeLock Lock(&LogLock);
+        if (bEnabled)
+        {
+            EnabledCategories.Add(Category);
+        }
+        else
+        {
+            EnabledCategories.Remove(Category);
+        }
     }
     
     Log(FString::Printf(TEXT("Category %s %s"), 
@@ -122,7 +137,10 @@ void UPlanetSystemLogger::SetCategoryEnabled(EPlanetLogCategory Category, bool b
 
 void UPlanetSystemLogger::SetLoggingEnabled(bool bEnabled)
 {
-    bEnableLogging = bEnabled;
+    {
+        FScopeLock Lock(&LogLock);
+        bEnableLogging = bEnabled;
+    }
     Log(FString::Printf(TEXT("Logging %s"), bEnabled ? TEXT("enabled") : TEXT("disabled")), 
         EPlanetLogLevel::Info, EPlanetLogCategory::General);
 }
@@ -192,21 +210,25 @@ void UPlanetSystemLogger::LogEvent(const FString& EventName, const FString& Deta
 
 void UPlanetSystemLogger::GetLogStatistics(TMap<EPlanetLogLevel, int32>& OutLogCounts, FString& OutLogFilePath)
 {
+    FScopeLock Lock(&LogLock);
     OutLogCounts = LogCounts;
     OutLogFilePath = LogFilePath;
 }
 
 bool UPlanetSystemLogger::ExportLogs(const FString& FilePath)
 {
-    if (LogBuffer.Num() == 0)
-    {
-        return false;
-    }
-    
     FString ExportContent;
-    for (const FString& LogEntry : LogBuffer)
     {
-        ExportContent += LogEntry + TEXT("\n");
+        FScopeLock Lock(&LogLock);
+        if (LogBuffer.Num() == 0)
+        {
+            return false;
+        }
+        
+        for (const FString& LogEntry : LogBuffer)
+        {
+            ExportContent += LogEntry + TEXT("\n");
+        }
     }
     
     return FFileHelper::SaveStringToFile(ExportContent, *FilePath);
@@ -214,12 +236,16 @@ bool UPlanetSystemLogger::ExportLogs(const FString& FilePath)
 
 void UPlanetSystemLogger::ClearLogBuffer()
 {
-    LogBuffer.Empty();
+    {
+        FScopeLock Lock(&LogLock);
+        LogBuffer.Empty();
+    }
     Log(TEXT("Log buffer cleared"), EPlanetLogLevel::Info, EPlanetLogCategory::General);
 }
 
 void UPlanetSystemLogger::GetLogBuffer(TArray<FString>& OutLogs, int32 MaxCount)
 {
+    FScopeLock Lock(&LogLock);
     if (MaxCount <= 0 || MaxCount > LogBuffer.Num())
     {
         OutLogs = LogBuffer;
@@ -232,6 +258,7 @@ void UPlanetSystemLogger::GetLogBuffer(TArray<FString>& OutLogs, int32 MaxCount)
 
 bool UPlanetSystemLogger::IsCategoryEnabled(EPlanetLogCategory Category) const
 {
+    FScopeLock Lock(&LogLock);
     return EnabledCategories.Contains(Category);
 }
 
@@ -242,21 +269,28 @@ double UPlanetSystemLogger::GetUptime() const
 
 void UPlanetSystemLogger::WriteLog(const FString& Message, EPlanetLogLevel Level, EPlanetLogCategory Category)
 {
-    if (!bEnableLogging || !ShouldLog(Level, Category))
     {
-        return;
+        FScopeLock Lock(&LogLock);
+        if (!bEnableLogging || !ShouldLog(Level, Category))
+        {
+            return;
+        }
     }
     
+    // formatação fora do lock; buffer, arquivo e contadores são compartilhados entre threads
     FString FormattedMessage = FormatLogMessage(Message, Level, Category);
-    
-    // Adiciona ao buffer
-    AddToBuffer(FormattedMessage);
-    
-    // Escreve no arquivo
-    WriteToFile(FormattedMessage);
-    
-    // Atualiza contadores
-    LogCounts[Level]++;
+    {
+        FScopeLock Lock(&LogLock);
+        
+        // Adiciona ao buffer
+        AddToBuffer(FormattedMessage);
+        
+        // Escreve no arquivo (a ordem das linhas segue a do buffer)
+        WriteToFile(FormattedMessage);
+        
+        // Atualiza contadores
+        LogCounts[Level]++;
+    }
     
     // Output para console se for erro ou warning
     if (Level >= EPlanetLogLevel::Warning)
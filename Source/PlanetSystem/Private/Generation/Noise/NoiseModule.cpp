@@ -40,3 +40,14 @@ float UNoiseModule::GetHeight(const FVector& Dir) const
     }
     return h * 200.f;
 }
+
+float UNoiseModule::GetMaxAmplitude() const
+{
+    float amp=1.f, sum=0.f;
+    for(int32 i=0;i<Octaves;++i)
+    {
+        sum += amp;
+        amp *= Persistence;
+    }
+    return sum * 200.f;
+}
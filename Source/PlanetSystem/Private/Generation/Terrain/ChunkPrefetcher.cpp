@@ -0,0 +1,189 @@
+#include "Generation/Terrain/ChunkPrefetcher.h"
+#include "Generation/Terrain/PatchNode.h"
+#include "Generation/Terrain/ProceduralPlanet.h"
+#include "Generation/Noise/NoiseModule.h"
+#include "Rendering/Culling/PlanetCulling.h"
+
+void FChunkPrefetcher::Update(const TArray<FPatchNode*>& Roots, TArrayView<const FPlanetLODViewer> Viewers, const FTransform& PlanetTransform,
+                              const FParams& Params, const UChunkCache& Cache)
+{
+    TArray<FRequest> NewQueue;
+    TSet<FChunkKey> Index;
+
+    if (Params.HorizonSeconds > 0.f)
+    {
+        for (const FPlanetLODViewer& Viewer : Viewers)
+        {
+            if (Viewer.Velocity.SizeSquared() < FMath::Square(MinSpeed))
+            {
+                continue;
+            }
+
+            // amostras ao longo da trajetória: o mesmo patch previsto em vários instantes fica com o mais cedo
+            for (int32 Step = 1; Step <= TrajectorySteps; ++Step)
+            {
+                const float Time = Params.HorizonSeconds * Step / TrajectorySteps;
+                const FVector Origin = Viewer.View.ViewOrigin + Viewer.Velocity * Time;
+                CollectLeaves(Roots, Origin, Viewer.View.PlanetCenter, Viewer.View.OccluderRadius, PlanetTransform, Params,
+                              Viewer.PatchBudget, Time, Cache, Index, NewQueue);
+            }
+        }
+    }
+
+    NewQueue.Sort([](const FRequest& A, const FRequest& B)
+    {
+        return A.Time != B.Time ? A.Time < B.Time : A.Distance < B.Distance;
+    });
+
+    // o que ainda estava pendente e saiu da previsão é cancelado; o resto segue com a nova urgência
+    TSet<FChunkKey> Previous;
+    for (int32 i = Head; i < Queue.Num(); ++i)
+    {
+        Previous.Add(Queue[i].Key);
+        if (!Index.Contains(Queue[i].Key))
+        {
+            Cancelled++;
+        }
+    }
+    for (const FRequest& Request : NewQueue)
+    {
+        if (!Previous.Contains(Request.Key))
+        {
+            Requested++;
+        }
+    }
+
+    Queue = MoveTemp(NewQueue);
+    Head = 0;
+}
+
+void FChunkPrefetcher::CollectLeaves(const TArray<FPatchNode*>& Roots, const FVector& Origin, const FVector& PlanetCenter, float OccluderRadius,
+                                     const FTransform& PlanetTransform, const FParams& Params, int32 PatchBudget, float Time,
+                                     const UChunkCache& Cache, TSet<FChunkKey>& Index, TArray<FRequest>& OutRequests) const
+{
+    FPlanetCullingView View;
+    View.ViewOrigin = Origin;
+    View.SetPlanet(PlanetCenter, OccluderRadius);
+
+    struct FPendingNode
+    {
+        uint8 Face;
+        int32 Level;
+        FVector2D UVMin;
+        FVector2D UVMax;
+    };
+
+    TArray<FPendingNode> Pending;
+    for (const FPatchNode* Root : Roots)
+    {
+        Pending.Add({ Root->Face, Root->Level, Root->UVMin, Root->UVMax });
+    }
+
+    // mesma travessia em largura do UpdateLOD, com limites estimados (a maioria desses patches não existe ainda)
+    int32 UsedBudget = 0;
+    for (int32 Next = 0; Next < Pending.Num(); ++Next)
+    {
+        const FPendingNode Node = Pending[Next];
+
+        FPatchNode Probe(Node.Level, Node.UVMin, Node.UVMax);
+        Probe.EstimateBounds(Params.PlanetRadius, Params.MinAltitude, Params.MaxAltitude);
+        const FSphere WorldSphere = Probe.BoundingSphere.TransformBy(PlanetTransform);
+        if (!View.IsVisible(WorldSphere))
+        {
+            continue;
+        }
+
+        const float Distance = FVector::Dist(Origin, WorldSphere.Center);
+        if (Distance < WorldSphere.W * Params.SplitFactor && Node.Level < Params.MaxLOD && UsedBudget + 3 <= PatchBudget)
+        {
+            UsedBudget += 3;
+            for (int32 Child = 0; Child < 4; ++Child)
+            {
+                FPendingNode& ChildNode = Pending.AddDefaulted_GetRef();
+                ChildNode.Face = Node.Face;
+                ChildNode.Level = Node.Level + 1;
+                FPatchNode::GetChildUV(Child, Node.UVMin, Node.UVMax, ChildNode.UVMin, ChildNode.UVMax);
+            }
+            continue;
+        }
+
+        const FChunkKey Key = FChunkKey::FromUV(Node.Face, Node.UVMin, Node.UVMax, Node.Level, Params.KeySeed);
+        if (Index.Contains(Key) || Cache.ContainsChunk(Key))
+        {
+            continue;
+        }
+
+        Index.Add(Key);
+        FRequest& Request = OutRequests.AddDefaulted_GetRef();
+        Request.Key = Key;
+        Request.Face = Node.Face;
+        Request.Level = Node.Level;
+        Request.UVMin = Node.UVMin;
+        Request.UVMax = Node.UVMax;
+        Request.Time = Time;
+        Request.Distance = Distance;
+    }
+}
+
+int32 FChunkPrefetcher::Process(const TArray<FPatchNode*>& Roots, UChunkCache& Cache, float PlanetRadius, UNoiseModule* Noise, double BudgetSeconds)
+{
+    if (!Noise || BudgetSeconds <= 0.0)
+    {
+        return 0;
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    int32 Done = 0;
+    while (Head < Queue.Num() && FPlatformTime::Seconds() - StartTime < BudgetSeconds)
+    {
+        const FRequest Request = Queue[Head++];
+        if (Cache.ContainsChunk(Request.Key))
+        {
+            continue;
+        }
+
+        // nos tiers frios (comprimido em memória ou disco): a promoção é bem mais barata que regenerar.
+        // PromoteChunk não conta como acesso: estatísticas e traces refletem só o que o LOD pediu.
+        if (Cache.PromoteChunk(Request.Key, CachePriority))
+        {
+            Promoted++;
+            Done++;
+            continue;
+        }
+
+        const FPatchNode* Root = Roots.IsValidIndex(Request.Face) ? Roots[Request.Face] : nullptr;
+        FPatchNode Probe(Request.Level, Request.UVMin, Request.UVMax);
+        Probe.Face = Request.Face;
+        Probe.ErosionModule = Root ? Root->ErosionModule : nullptr;
+        Probe.BiomeSystem = Root ? Root->BiomeSystem : nullptr;
+
+        Cache.StoreChunkData(Request.Key, Probe.BuildRenderData(PlanetRadius, Noise), CachePriority);
+        Generated++;
+        Done++;
+    }
+
+    if (Head >= Queue.Num())
+    {
+        Queue.Reset();
+        Head = 0;
+    }
+    return Done;
+}
+
+void FChunkPrefetcher::Cancel()
+{
+    Cancelled += Queue.Num() - Head;
+    Queue.Reset();
+    Head = 0;
+}
+
+FChunkPrefetcher::FStats FChunkPrefetcher::GetStats() const
+{
+    FStats Stats;
+    Stats.Queued = Queue.Num() - Head;
+    Stats.Requested = Requested;
+    Stats.Generated = Generated;
+    Stats.Promoted = Promoted;
+    Stats.Cancelled = Cancelled;
+    return Stats;
+}
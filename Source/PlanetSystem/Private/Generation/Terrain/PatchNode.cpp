@@ -1,29 +1,193 @@
 #include "Generation/Terrain/PatchNode.h"
 #include "Generation/Noise/NoiseModule.h"
 #include "Services/Terrain/ErosionModule.h"
+#include "Services/Environment/BiomeSystem.h"
+#include "Core/Cache/PlanetCacheMemory.h"
 #include "ProceduralMeshComponent.h"
 
 void FPatchNode::Subdivide()
 {
     if (bIsSplit) return;
-    FVector2D Mid = (UVMin + UVMax) * 0.5f;
-    Children[0] = new FPatchNode(Level+1, UVMin, Mid);
-    Children[1] = new FPatchNode(Level+1, FVector2D(Mid.X,UVMin.Y), FVector2D(UVMax.X,Mid.Y));
-    Children[2] = new FPatchNode(Level+1, FVector2D(UVMin.X,Mid.Y), FVector2D(Mid.X,UVMax.Y));
-    Children[3] = new FPatchNode(Level+1, Mid, UVMax);
+    for (int32 i = 0; i < 4; ++i)
+    {
+        FVector2D ChildMin, ChildMax;
+        GetChildUV(i, UVMin, UVMax, ChildMin, ChildMax);
+        Children[i] = new FPatchNode(Level+1, ChildMin, ChildMax);
+    }
+    for (FPatchNode* Child : Children)
+    {
+        Child->Face = Face;
+        Child->ErosionModule = ErosionModule;
+        Child->BiomeSystem = BiomeSystem;
+    }
     bIsSplit = true;
 }
 
-void FPatchNode::GenerateMesh(UProceduralMeshComponent* MeshComp, float PlanetRadius, UNoiseModule* Noise)
+void FPatchNode::GetChildUV(int32 Index, const FVector2D& InMin, const FVector2D& InMax, FVector2D& OutMin, FVector2D& OutMax)
+{
+    const FVector2D Mid = (InMin + InMax) * 0.5f;
+    switch (Index)
+    {
+    case 0:  OutMin = InMin;                       OutMax = Mid;                         break;
+    case 1:  OutMin = FVector2D(Mid.X, InMin.Y);   OutMax = FVector2D(InMax.X, Mid.Y);   break;
+    case 2:  OutMin = FVector2D(InMin.X, Mid.Y);   OutMax = FVector2D(Mid.X, InMax.Y);   break;
+    default: OutMin = Mid;                         OutMax = InMax;                       break;
+    }
+}
+
+void FPatchNode::Merge()
 {
-    Vertices.Empty();
-    Indices.Empty();
-    const int32 Res = FMath::Clamp(8 >> Level, 2, 16);
+    if (!bIsSplit) return;
+    for (auto*& Child : Children)
+    {
+        delete Child;
+        Child = nullptr;
+    }
+    bIsSplit = false;
+}
+
+void FPatchNode::SetRenderData(const FChunkDataRef& Data)
+{
+    RenderData = Data;
+    Resolution = GetRenderResolution();
+    MinAltitude = Data->MinAltitude;
+    MaxAltitude = Data->MaxAltitude;
+    Bounds = Data->Bounds;
+    BoundingSphere = Data->BoundingSphere;
+    bHasExactBounds = true;
+}
+
+void FPatchNode::ComputeBounds(float PlanetRadius, TArrayView<const FVector> Points)
+{
+    MinAltitude = MAX_flt;
+    MaxAltitude = -MAX_flt;
+    Bounds = FBox(ForceInit);
+    for (const FVector& V : Points)
+    {
+        const float Altitude = V.Size() - PlanetRadius;
+        MinAltitude = FMath::Min(MinAltitude, Altitude);
+        MaxAltitude = FMath::Max(MaxAltitude, Altitude);
+        Bounds += V;
+    }
+
+    // esfera centrada na caixa, raio até o vértice mais distante
+    const FVector Center = Bounds.GetCenter();
+    float RadiusSq = 0.f;
+    for (const FVector& V : Points)
+    {
+        RadiusSq = FMath::Max(RadiusSq, FVector::DistSquared(V, Center));
+    }
+    BoundingSphere = FSphere(Center, FMath::Sqrt(RadiusSq));
+    bHasExactBounds = Points.Num() > 0;
+}
 
+void FPatchNode::EstimateBounds(float PlanetRadius, float InMinAltitude, float InMaxAltitude)
+{
+    // cantos, pontos médios das bordas e centro nas duas altitudes
+    Bounds = FBox(ForceInit);
+    TArray<FVector, TInlineAllocator<18>> Points;
+    for (int32 y = 0; y <= 2; ++y)
+    {
+        const float v = FMath::Lerp(UVMin.Y, UVMax.Y, y * 0.5f);
+        for (int32 x = 0; x <= 2; ++x)
+        {
+            const float u = FMath::Lerp(UVMin.X, UVMax.X, x * 0.5f);
+            const FVector Dir = FVector((u-0.5f)*2.f, (v-0.5f)*2.f, 1.f).GetSafeNormal();
+            Points.Add(Dir * (PlanetRadius + InMinAltitude));
+            Points.Add(Dir * (PlanetRadius + InMaxAltitude));
+        }
+    }
+    for (const FVector& P : Points)
+    {
+        Bounds += P;
+    }
+
+    // a curvatura entre as amostras fica fora da caixa: margem de 10% no raio
+    const FVector Center = Bounds.GetCenter();
+    float RadiusSq = 0.f;
+    for (const FVector& P : Points)
+    {
+        RadiusSq = FMath::Max(RadiusSq, FVector::DistSquared(P, Center));
+    }
+    BoundingSphere = FSphere(Center, FMath::Sqrt(RadiusSq) * 1.1f);
+    Bounds = Bounds.ExpandBy(FMath::Sqrt(RadiusSq) * 0.1f);
+
+    MinAltitude = InMinAltitude;
+    MaxAltitude = InMaxAltitude;
+    bHasExactBounds = false;
+}
+
+void FPatchNode::GenerateMesh(UProceduralMeshComponent* MeshComp, int32 SectionIndex, float PlanetRadius, UNoiseModule* Noise)
+{
+    const FChunkDataRef Data = BuildRenderData(PlanetRadius, Noise);
+
+    // criar seção (pesos de bioma em vertex color, índices em UV1)
+    MeshComp->CreateMeshSection(SectionIndex, Data->Vertices, Data->Indices, {}, {}, Data->BiomeIndices, {}, {}, Data->BiomeWeights, {}, false);
+    RenderData = Data;
+}
+
+FChunkDataRef FPatchNode::BuildRenderData(float PlanetRadius, UNoiseModule* Noise)
+{
+    // o payload é montado aqui e depois só lido (seção, cache, vegetação, consultas de altura);
+    // é o mesmo bloco que o cache de render guarda, então é contabilizado na tag dele
+    LLM_SCOPE_BYTAG(PlanetRenderChunkCache);
+    const double StartTime = FPlatformTime::Seconds();
+    TSharedRef<FChunkData, ESPMode::ThreadSafe> Data = MakeShared<FChunkData, ESPMode::ThreadSafe>();
+    TArray<FVector>& Vertices = Data->Vertices;
+    TArray<int32>& Indices = Data->Indices;
+    const int32 Res = GetRenderResolution();
+    Resolution = Res;
+
+    // noise e erosão determinísticos
+    BuildSurface(PlanetRadius, Noise, Res, Vertices);
+    if (ErosionModule)
+    {
+        // Notify plugins about erosion
+        UPlanetSystemServiceLocator::GetInstance()->BroadcastErosionApplied(Vertices, PatchSeed);
+    }
+
+    // índices
+    for (int32 y=0; y<Res; ++y)
+        for (int32 x=0; x<Res; ++x)
+        {
+            int i0=y*(Res+1)+x, i1=i0+1, i2=i0+Res+1, i3=i2+1;
+            Indices.Append({i0,i2,i1, i1,i2,i3});
+        }
+
+    // faixa de altitude e limites do patch (água, vegetação e culling)
+    ComputeBounds(PlanetRadius, Vertices);
+
+    // biomas por vértice
+    if (BiomeSystem)
+    {
+        FBiomeBlendStream Blend;
+        BiomeSystem->ClassifyPatch(Vertices, Res, PlanetRadius, Data->BiomeMap, &Blend);
+        Data->BiomeWeights = MoveTemp(Blend.Weights);
+        Data->BiomeIndices = MoveTemp(Blend.Indices);
+    }
+
+    Data->MinAltitude = MinAltitude;
+    Data->MaxAltitude = MaxAltitude;
+    Data->Bounds = Bounds;
+    Data->BoundingSphere = BoundingSphere;
+    Data->Seed = PatchSeed;
+    Data->LODLevel = Level;
+    Data->UVMin = UVMin;
+    Data->UVMax = UVMax;
+    Data->UpdateAccessTime();
+
+    // custo de regenerar (noise + erosão + biomas), usado pela política GDSF dos caches
+    Data->GenerationSeconds = float(FPlatformTime::Seconds() - StartTime);
+    return Data;
+}
+
+void FPatchNode::BuildSurface(float PlanetRadius, UNoiseModule* Noise, int32 Res, TArray<FVector>& OutVertices) const
+{
     // configure noise seed
     Noise->SetSeed(PatchSeed);
 
     // gerar grid UV
+    OutVertices.Reset((Res+1)*(Res+1));
     for (int32 y=0; y<=Res; ++y)
     {
         float v = FMath::Lerp(UVMin.Y, UVMax.Y, float(y)/Res);
@@ -33,27 +197,74 @@ void FPatchNode::GenerateMesh(UProceduralMeshComponent* MeshComp, float PlanetRa
             FVector Dir((u-0.5f)*2.f, (v-0.5f)*2.f, 1.f);
             Dir.Normalize();
             float Alt = Noise->GetHeight(Dir);
-            Vertices.Add(Dir*(PlanetRadius+Alt));
+            OutVertices.Add(Dir*(PlanetRadius+Alt));
         }
     }
 
-    // índices
+    // erosão na própria resolução da grade (render ou colisão)
+    if (ErosionModule)
+    {
+        ErosionModule->ApplyHydraulicErosion(OutVertices, Res, PatchSeed);
+    }
+}
+
+int32 FPatchNode::GetCollisionResolution(int32 ResolutionShift) const
+{
+    return FPlanetGenerationConfig::GetGridResolution(BaseResolution, Level, ResolutionShift);
+}
+
+void FPatchNode::GenerateCollision(float PlanetRadius, UNoiseModule* Noise, int32 ResolutionShift)
+{
+    const int32 Res = GetCollisionResolution(ResolutionShift);
+    CollisionResolution = Res;
+
+    TArray<FVector> Points;
+    const int32 RenderRes = GetRenderResolution();
+    if (HasRenderData() && RenderData->Vertices.Num() == (RenderRes+1)*(RenderRes+1))
+    {
+        // payload de render já pronto: subamostra a superfície erodida. O vértice mais próximo por eixo
+        // cai exatamente nas bordas para qualquer razão entre as resoluções (sem frestas entre patches)
+        const TArray<FVector>& RenderPoints = RenderData->Vertices;
+        Points.Reserve((Res+1)*(Res+1));
+        for (int32 y=0; y<=Res; ++y)
+        {
+            const int32 SourceY = FMath::RoundToInt(y * RenderRes / float(Res));
+            for (int32 x=0; x<=Res; ++x)
+            {
+                const int32 SourceX = FMath::RoundToInt(x * RenderRes / float(Res));
+                Points.Add(RenderPoints[SourceY*(RenderRes+1) + SourceX]);
+            }
+        }
+    }
+    else
+    {
+        // sem render (servidor dedicado): noise e erosão direto na resolução de colisão, (RenderRes/Res)^2
+        // menos células. A erosão varia um pouco com a resolução, limitada por UErosionModule::MaxHeightChange
+        BuildSurface(PlanetRadius, Noise, Res, Points);
+    }
+
+    CollisionIndices.Reset((Res)*(Res)*6);
     for (int32 y=0; y<Res; ++y)
         for (int32 x=0; x<Res; ++x)
         {
             int i0=y*(Res+1)+x, i1=i0+1, i2=i0+Res+1, i3=i2+1;
-            Indices.Append({i0,i2,i1, i1,i2,i3});
+            CollisionIndices.Append({i0,i2,i1, i1,i2,i3});
         }
 
-    // erosão determinística
-    if (ErosionModule)
+    ComputeBounds(PlanetRadius, Points);
+
+    CollisionHeights.SetNumUninitialized(Points.Num());
+    for (int32 i = 0; i < Points.Num(); ++i)
     {
-        ErosionModule->ApplyHydraulicErosion(Vertices, Res, PatchSeed);
-        
-        // Notify plugins about erosion
-        UPlanetSystemServiceLocator::GetInstance()->BroadcastErosionApplied(Vertices, PatchSeed);
+        CollisionHeights[i] = Points[i].Size() - PlanetRadius;
     }
+}
 
-    // criar seção
-    MeshComp->CreateMeshSection_LinearColor(Level, Vertices, Indices, {}, {}, {}, {}, false);
+FVector FPatchNode::GetCollisionVertex(int32 Index, float PlanetRadius) const
+{
+    const int32 Res = CollisionResolution;
+    const float u = FMath::Lerp(UVMin.X, UVMax.X, float(Index % (Res+1))/Res);
+    const float v = FMath::Lerp(UVMin.Y, UVMax.Y, float(Index / (Res+1))/Res);
+    const FVector Dir = FVector((u-0.5f)*2.f, (v-0.5f)*2.f, 1.f).GetSafeNormal();
+    return Dir*(PlanetRadius+CollisionHeights[Index]);
 }
@@ -3,6 +3,7 @@
 #include "Services/Terrain/ErosionModule.h"
 #include "Services/Environment/BiomeSystem.h"
 #include "Services/Environment/VegetationSystem.h"
+#include "Services/Environment/PoissonDiskSampler.h"
 #include "Services/Environment/WaterComponent.h"
 #include "Debug/Logging/PlanetSystemLogger.h"
 #include "Core/Events/PlanetEventBus.h"
@@ -72,13 +73,11 @@ FPlanetChunk UPlanetTerrainGenerator::GenerateTerrainChunk(const FVector& Center
         
         // 3. Gerar mapa de biomas
         TArray<EBiomeType> BiomeMap;
-        GenerateBiomeMap(HeightMap, BiomeMap);
+        GenerateBiomeMap(Center, HeightMap, BiomeMap);
         Chunk.BiomeMap = BiomeMap;
         
         // 4. Gerar vegetação
-        TArray<FVegetationInstance> Vegetation;
-        GenerateVegetationMap(BiomeMap, Vegetation);
-        Chunk.Vegetation = Vegetation;
+        GenerateVegetationMap(Center, HeightMap, BiomeMap, Chunk.Vegetation, Chunk.VegetationBounds);
         
         // 5. Gerar sistema de água
         FWaterSystem WaterSystem;
@@ -106,6 +105,64 @@ FPlanetChunk UPlanetTerrainGenerator::GenerateTerrainChunk(const FVector& Center
     }
 }
 
+FPlanetChunk UPlanetTerrainGenerator::GenerateCollisionChunk(const FVector& Center, int32 LODLevel)
+{
+    const double StartTime = FPlatformTime::Seconds();
+    
+    if (!ValidateParameters(Center, LODLevel))
+    {
+        LogGenerationEvent(EPlanetEventType::Error, TEXT("Parâmetros inválidos para geração de colisão"));
+        return FPlanetChunk();
+    }
+    
+    FPlanetChunk Chunk;
+    Chunk.Center = Center;
+    Chunk.LODLevel = LODLevel;
+    Chunk.GenerationTime = FDateTime::Now();
+    
+    // 1. Alturas e erosão direto na resolução de colisão: (render / colisão)^2 menos células que a
+    //    superfície de render. A erosão varia um pouco com a resolução; a física não precisa do detalhe
+    const int32 Resolution = GetCollisionResolution(LODLevel);
+    GenerateHeightGrid(Center, Resolution, Chunk.HeightMap);
+    if (Chunk.HeightMap.Num() != Resolution * Resolution)
+    {
+        return FPlanetChunk();
+    }
+    
+    if (CurrentConfig && CurrentConfig->ErosionConfig.bEnableErosion)
+    {
+        ApplyErosion(Chunk.HeightMap, CurrentConfig->ErosionConfig);
+    }
+    
+    // 2. Triângulos da grade; biomas, vegetação e água ficam de fora
+    Chunk.CollisionIndices.Reserve((Resolution - 1) * (Resolution - 1) * 6);
+    for (int32 Y = 0; Y < Resolution - 1; Y++)
+    {
+        for (int32 X = 0; X < Resolution - 1; X++)
+        {
+            const int32 I0 = Y * Resolution + X;
+            const int32 I1 = I0 + 1;
+            const int32 I2 = I0 + Resolution;
+            const int32 I3 = I2 + 1;
+            Chunk.CollisionIndices.Append({ I0, I2, I1, I1, I2, I3 });
+        }
+    }
+    
+    const float GenerationTime = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+    TotalGenerationTime += GenerationTime;
+    ChunksGenerated++;
+    AverageGenerationTime = TotalGenerationTime / ChunksGenerated;
+    
+    return Chunk;
+}
+
+int32 UPlanetTerrainGenerator::GetCollisionResolution(int32 LODLevel) const
+{
+    const int32 BaseResolution = CurrentConfig ? CurrentConfig->GenerationConfig.BaseResolution : 8;
+    const int32 Shift = CurrentConfig ? CurrentConfig->GenerationConfig.CollisionResolutionShift : 1;
+    return FPlanetGenerationConfig::GetGridResolution(BaseResolution, LODLevel, Shift);
+}
+
 void UPlanetTerrainGenerator::ApplyBiomesToChunk(FPlanetChunk& Chunk, const FBiomeConfig& BiomeConfig)
 {
     try
@@ -118,7 +175,7 @@ void UPlanetTerrainGenerator::ApplyBiomesToChunk(FPlanetChunk& Chunk, const FBio
         
         // Gerar mapa de biomas baseado na altura
         TArray<EBiomeType> BiomeMap;
-        GenerateBiomeMap(Chunk.HeightMap, BiomeMap);
+        GenerateBiomeMap(Chunk.Center, Chunk.HeightMap, BiomeMap);
         
         // Aplicar regras de bioma
         if (BiomeSystem)
@@ -137,7 +194,7 @@ void UPlanetTerrainGenerator::ApplyBiomesToChunk(FPlanetChunk& Chunk, const FBio
     }
 }
 
-void UPlanetTerrainGenerator::GenerateVegetationForChunk(const FPlanetChunk& Chunk, TArray<FVegetationInstance>& OutVegetation)
+void UPlanetTerrainGenerator::GenerateVegetationForChunk(const FPlanetChunk& Chunk, TArray<FPackedVegetationInstance>& OutVegetation, FBox& OutBounds)
 {
     try
     {
@@ -148,7 +205,7 @@ void UPlanetTerrainGenerator::GenerateVegetationForChunk(const FPlanetChunk& Chu
         }
         
         // Gerar vegetação baseada no mapa de biomas
-        GenerateVegetationMap(Chunk.BiomeMap, OutVegetation);
+        GenerateVegetationMap(Chunk.Center, Chunk.HeightMap, Chunk.BiomeMap, OutVegetation, OutBounds);
         
         // Otimizar densidade se necessário
         if (CurrentConfig && CurrentConfig->VegetationConfig.bOptimizeDensity)
@@ -182,12 +239,12 @@ void UPlanetTerrainGenerator::GenerateWaterSystem(const FPlanetChunk& Chunk, FWa
         {
             // Gerar sistema de oceanos
             FOceanSystem OceanSystem;
-            WaterSystem->GenerateOceanSystem(Chunk, OceanSystem);
+            WaterSystem->GenerateOceanSystem(Chunk, CurrentConfig ? CurrentConfig->GenerationConfig.ChunkSize : 1000.0f, OceanSystem);
             OutWaterSystem.OceanSystem = OceanSystem;
             
             // Gerar sistema de rios
             FRiverSystem RiverSystem;
-            WaterSystem->GenerateRiverSystem(Chunk, RiverSystem);
+            WaterSystem->GenerateRiverSystem(Chunk, CurrentConfig ? CurrentConfig->GenerationConfig.ChunkSize : 1000.0f, RiverSystem);
             OutWaterSystem.RiverSystem = RiverSystem;
         }
         
@@ -200,6 +257,14 @@ void UPlanetTerrainGenerator::GenerateWaterSystem(const FPlanetChunk& Chunk, FWa
     }
 }
 
+void UPlanetTerrainGenerator::ReleaseChunk(const FPlanetChunk& Chunk)
+{
+    if (WaterSystem)
+    {
+        WaterSystem->ReleaseRiverChunk(Chunk, CurrentConfig ? CurrentConfig->GenerationConfig.ChunkSize : 1000.0f);
+    }
+}
+
 void UPlanetTerrainGenerator::SetGenerationConfig(const UPlanetCoreConfig* Config)
 {
     CurrentConfig = Config;
@@ -279,7 +344,17 @@ void UPlanetTerrainGenerator::GenerateHeightMap(const FVector& Center, int32 LOD
     
     // Calcular resolução baseada no LOD
     const int32 BaseResolution = CurrentConfig->GenerationConfig.BaseResolution;
-    const int32 Resolution = FMath::Max(2, BaseResolution >> LODLevel);
+    GenerateHeightGrid(Center, FPlanetGenerationConfig::GetGridResolution(BaseResolution, LODLevel), OutHeightMap);
+}
+
+void UPlanetTerrainGenerator::GenerateHeightGrid(const FVector& Center, int32 Resolution, TArray<float>& OutHeightMap)
+{
+    if (!NoiseModule || !CurrentConfig)
+    {
+        LogGenerationEvent(EPlanetEventType::Error, TEXT("NoiseModule ou CurrentConfig não disponível"));
+        return;
+    }
+    
     const int32 TotalVertices = Resolution * Resolution;
     
     OutHeightMap.SetNum(TotalVertices);
@@ -364,114 +439,179 @@ void UPlanetTerrainGenerator::ApplyErosion(TArray<float>& HeightMap, const FEros
     }
 }
 
-void UPlanetTerrainGenerator::GenerateBiomeMap(const TArray<float>& HeightMap, TArray<EBiomeType>& OutBiomeMap)
+void UPlanetTerrainGenerator::GenerateBiomeMap(const FVector& Center, const TArray<float>& HeightMap, TArray<EBiomeType>& OutBiomeMap)
 {
-    if (!CurrentConfig)
+    if (!CurrentConfig || !BiomeSystem)
     {
-        LogGenerationEvent(EPlanetEventType::Error, TEXT("CurrentConfig não disponível para geração de biomas"));
+        LogGenerationEvent(EPlanetEventType::Error, TEXT("CurrentConfig ou BiomeSystem não disponível para geração de biomas"));
         return;
     }
     
     const int32 NumVertices = HeightMap.Num();
+    const int32 Resolution = FMath::RoundToInt(FMath::Sqrt(static_cast<float>(NumVertices)));
     OutBiomeMap.SetNum(NumVertices);
     
+    if (NumVertices == 0 || Resolution * Resolution != NumVertices)
+    {
+        LogGenerationEvent(EPlanetEventType::Warning, TEXT("Mapa de altura não é quadrado, biomas não classificados"));
+        return;
+    }
+    
     const FBiomeConfig& BiomeConfig = CurrentConfig->BiomeConfig;
+    const float InvMaxAltitude = 1.0f / FMath::Max(BiomeConfig.MaxAltitude, 1.0f);
+    const float InvStep = (Resolution - 1) / FMath::Max(CurrentConfig->GenerationConfig.ChunkSize, 1.0f);
     
-    for (int32 i = 0; i < NumVertices; i++)
+    // Temperatura base pela latitude do centro do chunk
+    const float Latitude = FMath::Asin(FMath::Clamp(Center.GetSafeNormal().Z, -1.0f, 1.0f));
+    const float LatitudeTemperature = CalculateTemperature(Latitude);
+    
+    // Atributos em SoA para a classificação vetorizada
+    TArray<float> Slopes, Temperatures, Humidities;
+    Slopes.SetNumUninitialized(NumVertices);
+    Temperatures.SetNumUninitialized(NumVertices);
+    Humidities.SetNumUninitialized(NumVertices);
+    
+    for (int32 Y = 0; Y < Resolution; Y++)
     {
-        const float Height = HeightMap[i];
-        
-        // Determinar bioma baseado na altura
-        EBiomeType BiomeType = EBiomeType::Ocean;
-        
-        if (Height > BiomeConfig.OceanThreshold)
+        for (int32 X = 0; X < Resolution; X++)
         {
-            if (Height < BiomeConfig.BeachThreshold)
-            {
-                BiomeType = EBiomeType::Beach;
-            }
-            else if (Height < BiomeConfig.PlainsThreshold)
-            {
-                BiomeType = EBiomeType::Plains;
-            }
-            else if (Height < BiomeConfig.ForestThreshold)
-            {
-                BiomeType = EBiomeType::Forest;
-            }
-            else if (Height < BiomeConfig.MountainThreshold)
-            {
-                BiomeType = EBiomeType::Mountain;
-            }
-            else
-            {
-                BiomeType = EBiomeType::Peak;
-            }
+            const int32 Index = Y * Resolution + X;
+            
+            // Gradiente por diferença central (unilateral nas bordas)
+            const int32 X0 = FMath::Max(X - 1, 0), X1 = FMath::Min(X + 1, Resolution - 1);
+            const int32 Y0 = FMath::Max(Y - 1, 0), Y1 = FMath::Min(Y + 1, Resolution - 1);
+            const float GradX = (HeightMap[Y * Resolution + X1] - HeightMap[Y * Resolution + X0]) * InvStep / FMath::Max(X1 - X0, 1);
+            const float GradY = (HeightMap[Y1 * Resolution + X] - HeightMap[Y0 * Resolution + X]) * InvStep / FMath::Max(Y1 - Y0, 1);
+            
+            const float Height01 = FMath::Clamp(HeightMap[Index] * InvMaxAltitude, 0.0f, 1.0f);
+            const float Temperature = FMath::Clamp(LatitudeTemperature - Height01 * BiomeConfig.AltitudeTemperatureLapse, 0.0f, 1.0f);
+            
+            Slopes[Index] = 1.0f - FMath::InvSqrt(1.0f + GradX * GradX + GradY * GradY);
+            Temperatures[Index] = Temperature;
+            Humidities[Index] = CalculateHumidity(Height01, Temperature);
         }
-        
-        OutBiomeMap[i] = BiomeType;
     }
     
+    // EBiomeType é uint8: classifica direto no mapa empacotado
+    BiomeSystem->ClassifyBiomes(HeightMap, Slopes, Temperatures, Humidities,
+        TArrayView<uint8>(reinterpret_cast<uint8*>(OutBiomeMap.GetData()), NumVertices));
+    
     // Aplicar suavização de transições se habilitada
     if (BiomeConfig.bSmoothTransitions)
     {
-        if (BiomeSystem)
-        {
-            BiomeSystem->SmoothBiomeTransitions(OutBiomeMap);
-        }
+        BiomeSystem->SmoothBiomeTransitions(OutBiomeMap);
     }
 }
 
-void UPlanetTerrainGenerator::GenerateVegetationMap(const TArray<EBiomeType>& BiomeMap, TArray<FVegetationInstance>& OutVegetation)
+void UPlanetTerrainGenerator::GenerateVegetationMap(const FVector& Center, const TArray<float>& HeightMap, const TArray<EBiomeType>& BiomeMap,
+                                                    TArray<FPackedVegetationInstance>& OutVegetation, FBox& OutBounds)
 {
+    OutVegetation.Reset();
+    OutBounds = FBox(Center, Center);
+    
     if (!CurrentConfig || !VegetationSystem)
     {
         LogGenerationEvent(EPlanetEventType::Warning, TEXT("Configuração ou VegetationSystem não disponível"));
         return;
     }
     
-    const FVegetationConfig& VegetationConfig = CurrentConfig->VegetationConfig;
+    const int32 Size = FMath::RoundToInt(FMath::Sqrt(static_cast<float>(BiomeMap.Num())));
+    if (Size < 2 || Size * Size != BiomeMap.Num())
+    {
+        return;
+    }
+    
+    // Seed global: a mesma amostra tem o mesmo hash em qualquer chunk que a cubra
+    const uint32 Seed = static_cast<uint32>(CurrentConfig->NoiseConfig.GlobalSeed);
+    
+    // Ladrilho Poisson-disk ancorado no plano XY do mundo, com o espaçamento da grade de LOD 0:
+    // chunks vizinhos (de qualquer LOD) recortam o mesmo ladrilho e o raio vale através das bordas
+    const int32 BaseResolution = FMath::Max(2, CurrentConfig->GenerationConfig.BaseResolution);
+    const float ChunkSize = CurrentConfig->GenerationConfig.ChunkSize;
+    const float TileWorldSize = ChunkSize / (BaseResolution - 1) / FPoissonDiskSampler::TileRadius;
+    const float Step = ChunkSize / (Size - 1);
+    const FVector2D ChunkOrigin(Center.X - Size / 2.0f * Step, Center.Y - Size / 2.0f * Step);
+    const float Extent = ChunkSize / TileWorldSize;
+    
+    const bool bHasHeights = HeightMap.Num() == BiomeMap.Num();
     
-    for (int32 i = 0; i < BiomeMap.Num(); i++)
+    // Posições em mundo primeiro: os limites da quantização saem das próprias instâncias
+    struct FPlacedInstance
     {
-        const EBiomeType BiomeType = BiomeMap[i];
-        
-        // Obter tipos de vegetação para este bioma
-        TArray<FVegetationType> VegetationTypes = VegetationSystem->GetVegetationForBiome(BiomeType);
-        
-        for (const FVegetationType& VegetationType : VegetationTypes)
+        uint16 TypeIndex;
+        FVector Position;
+        float Yaw;
+    };
+    TArray<FPlacedInstance> Placed;
+    
+    // Tipos de vegetação por bioma resolvidos uma vez por chunk, não por amostra
+    TArray<FVegetationType> VegetationByBiome[BiomeTypeCount];
+    for (int32 Biome = 0; Biome < BiomeTypeCount; ++Biome)
+    {
+        VegetationByBiome[Biome] = VegetationSystem->GetVegetationForBiome(static_cast<EBiomeType>(Biome));
+    }
+    
+    FPoissonDiskSampler::ForEachSample(ChunkOrigin / TileWorldSize, Extent, Extent, Seed,
+        [&](const FVector2D& Sample, float Rank, uint32 SampleHash)
         {
-            // Calcular probabilidade de spawn
-            const float SpawnChance = FMath::FRand();
-            if (SpawnChance <= VegetationType.SpawnProbability)
+            const float U = Sample.X / Extent;
+            const float V = Sample.Y / Extent;
+            // Vértice mais próximo: a grade tem Size-1 passos sobre o Extent
+            const int32 X = FMath::Clamp(FMath::RoundToInt(U * (Size - 1)), 0, Size - 1);
+            const int32 Y = FMath::Clamp(FMath::RoundToInt(V * (Size - 1)), 0, Size - 1);
+            const EBiomeType BiomeType = BiomeMap[Y * Size + X];
+            
+            const TArray<FVegetationType>& VegetationTypes = VegetationByBiome[static_cast<int32>(BiomeType)];
+            
+            for (int32 TypeIndex = 0; TypeIndex < VegetationTypes.Num(); ++TypeIndex)
             {
-                FVegetationInstance Instance;
-                Instance.VegetationType = VegetationType;
-                Instance.Position = FVector::ZeroVector; // Será calculado pelo sistema de vegetação
-                Instance.Rotation = FRotator::ZeroRotator;
-                Instance.Scale = FVector::OneVector;
+                const FVegetationType& VegetationType = VegetationTypes[TypeIndex];
                 
-                OutVegetation.Add(Instance);
+                // Rank progressivo deslocado por tipo: cada tipo fica com um subconjunto blue-noise próprio
+                const float TypeRank = FMath::Frac(Rank + TypeIndex * 0.618034f);
+                if (TypeRank < VegetationType.SpawnProbability)
+                {
+                    const FVector2D World = ChunkOrigin + Sample * TileWorldSize;
+                    const float Height = bHasHeights ? HeightMap[Y * Size + X] : 0.0f;
+                    
+                    FPlacedInstance& Instance = Placed.AddDefaulted_GetRef();
+                    Instance.TypeIndex = FPackedVegetationInstance::MakeTypeIndex(static_cast<uint8>(BiomeType), static_cast<uint8>(TypeIndex));
+                    Instance.Position = FVector(World.X, World.Y, Center.Z + Height);
+                    Instance.Yaw = float(SampleHash & 0xFFFF) / 65535.0f * UE_TWO_PI;
+                    break;
+                }
             }
-        }
+        });
+    
+    if (Placed.Num() == 0)
+    {
+        return;
+    }
+    
+    OutBounds = FBox(ForceInit);
+    for (const FPlacedInstance& Instance : Placed)
+    {
+        OutBounds += Instance.Position;
+    }
+    const FVector BoundsSize = OutBounds.GetSize().ComponentMax(FVector(KINDA_SMALL_NUMBER));
+    
+    OutVegetation.Reserve(Placed.Num());
+    for (const FPlacedInstance& Instance : Placed)
+    {
+        OutVegetation.Add(FPackedVegetationInstance::Pack(Instance.TypeIndex, (Instance.Position - OutBounds.Min) / BoundsSize, Instance.Yaw, 1.0f));
     }
 }
 
 float UPlanetTerrainGenerator::CalculateTemperature(float Latitude)
 {
-    // Simular temperatura baseada na latitude
-    // Equador = quente, polos = frio
-    const float NormalizedLatitude = FMath::Abs(FMath::Sin(Latitude));
-    return 1.0f - NormalizedLatitude; // 1 = quente, 0 = frio
+    // Equador = quente, polos = frio (mesma regra usada na classificação por vértice)
+    return UBiomeSystem::CalculateTemperature(Latitude);
 }
 
 float UPlanetTerrainGenerator::CalculateHumidity(float Height, float Temperature)
 {
-    // Simular umidade baseada na altura e temperatura
     // Altura baixa + temperatura alta = alta umidade
-    const float HeightFactor = 1.0f - FMath::Clamp(Height, 0.0f, 1.0f);
-    const float TemperatureFactor = Temperature;
-    
-    return (HeightFactor + TemperatureFactor) * 0.5f;
+    return UBiomeSystem::CalculateHumidity(Height, Temperature);
 }
 
 void UPlanetTerrainGenerator::ApplyDetailNoise(TArray<float>& HeightMap, float DetailScale, float DetailStrength)
@@ -1,7 +1,15 @@
 #include "Generation/Terrain/ProceduralPlanet.h"
 #include "ProceduralMeshComponent.h"
 #include "TimerManager.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/Engine.h"
+#include "UnrealClient.h"
+#include "Rendering/Culling/PlanetCulling.h"
 #include "Services/Core/ServiceLocator.h"
+#include "Services/Environment/BiomeSystem.h"
 #include "Rendering/Chunks/ChunkCache.h"
 #include "Debug/Logging/PlanetSystemLogger.h"
 
@@ -51,18 +59,54 @@ void AProceduralPlanet::InitializeServices()
 
 void AProceduralPlanet::InitializeQuadTrees()
 {
+    Prefetcher.Cancel();
     Roots.Empty();
+    
+    // Cached chunks are only valid for the config that produced them
+    ChunkKeySeed = ComputeChunkKeySeed();
+    
     TArray<FVector2D> Mins = {{0,0},{0.5f,0},{0,0.5f},{0.5f,0.5f},{1,0},{1,0.5f}};
     TArray<FVector2D> Maxs = {{0.5f,0.5f},{1,0.5f},{0.5f,1},{1,1},{0.5f,0.5f},{1,1}};
     
     for(int i=0;i<6;++i)
     {
         FPatchNode* Root = new FPatchNode(0, Mins[i], Maxs[i]);
+        Root->Face = uint8(i);
         Root->ErosionModule = UPlanetSystemServiceLocator::GetErosionService();
+        Root->BiomeSystem = UPlanetSystemServiceLocator::GetBiomeService();
         Roots.Add(Root);
     }
 }
 
+uint32 AProceduralPlanet::ComputeChunkKeySeed() const
+{
+    if (!CoreConfig)
+    {
+        return 0;
+    }
+    
+    const FNoiseConfig& NoiseConfig = CoreConfig->NoiseConfig;
+    uint32 Seed = HashCombine(GetTypeHash(NoiseConfig.GlobalSeed), GetTypeHash(CoreConfig->GenerationConfig.BaseRadius));
+    Seed = HashCombine(Seed, GetTypeHash(NoiseConfig.BaseFrequency));
+    Seed = HashCombine(Seed, GetTypeHash(NoiseConfig.Octaves));
+    Seed = HashCombine(Seed, GetTypeHash(NoiseConfig.Lacunarity));
+    Seed = HashCombine(Seed, GetTypeHash(NoiseConfig.Persistence));
+    Seed = HashCombine(Seed, GetTypeHash(NoiseConfig.WarpStrength));
+    Seed = HashCombine(Seed, GetTypeHash(NoiseConfig.bEnableWarp));
+    Seed = HashCombine(Seed, GetTypeHash(CoreConfig->GenerationConfig.bEnableErosion));
+    
+    // Erosion parameters (the same hash that versions the erosion delta cache) and the biome rules/lookup
+    if (const UErosionModule* Erosion = UPlanetSystemServiceLocator::GetErosionService())
+    {
+        Seed = HashCombine(Seed, Erosion->GetConfigHash());
+    }
+    if (const UBiomeSystem* Biomes = UPlanetSystemServiceLocator::GetBiomeService())
+    {
+        Seed = HashCombine(Seed, Biomes->GetConfigHash());
+    }
+    return Seed;
+}
+
 void AProceduralPlanet::UpdateLOD()
 {
     double StartTime = FPlatformTime::Seconds();
@@ -74,82 +118,264 @@ void AProceduralPlanet::UpdateLOD()
     UVegetationSystem* Vegetation = UPlanetSystemServiceLocator::GetVegetationService();
     UWaterComponent* Water = UPlanetSystemServiceLocator::GetWaterService();
     
-    if (!Noise || !Biomes || !Vegetation || !Water)
+    const bool bCollisionOnly = IsCollisionOnly();
+    if (!Noise || (!bCollisionOnly && (!Biomes || !Vegetation || !Water)))
     {
         UPlanetSystemLogger::LogError(TEXT("ProceduralPlanet"), TEXT("Required services not initialized"));
         return;
     }
     
+    // Erosion or biome settings edited at runtime: new keys for every tier, and patches drop the payloads
+    // they hold so nothing built with the old settings is reused
+    const uint32 NewChunkKeySeed = ComputeChunkKeySeed();
+    if (NewChunkKeySeed != ChunkKeySeed)
+    {
+        ChunkKeySeed = NewChunkKeySeed;
+        Prefetcher.Cancel();
+        for (FPatchNode* Root : Roots)
+        {
+            Root->Merge();
+            Root->RenderData.Reset();
+        }
+        ActivePatches.Reset();
+        HeightQuery.Reset();
+        if (Vegetation)
+        {
+            Vegetation->ClearAllPatches();
+        }
+    }
+    
     float PlanetRadius = CoreConfig ? CoreConfig->GenerationConfig.BaseRadius : 1000.0f;
     int32 MaxLOD = CoreConfig ? CoreConfig->GenerationConfig.MaxLODLevel : 8;
     
-    for(FPatchNode* Root : Roots)
+    const bool bVegetationEnabled = CoreConfig && CoreConfig->GenerationConfig.bEnableVegetation;
+    TArray<FPlanetLODViewer> Viewers;
+    const int32 NumViewers = BuildLODViewers(Viewers, PlanetRadius);
+    const FTransform& PlanetTransform = GetActorTransform();
+    TSet<uint64> ActiveVegetationPatches;
+    TArray<FPatchNode*> VisiblePatches;
+    int32 PatchesCulled = 0;
+    
+    const float SplitFactor = CoreConfig ? CoreConfig->GenerationConfig.LODSplitFactor : 2.5f;
+    const float AltitudeBound = GetAltitudeBound();
+    
+    // Breadth-first quadtree traversal refining the union of all viewers in one pass.
+    // Each node carries the mask of viewers that still see it: a node no viewer sees skips
+    // its whole subtree, so nothing below it is generated, uploaded or populated.
+    // Without viewers the roots are drawn as before.
+    struct FPendingNode
+    {
+        FPatchNode* Node;
+        uint64 ViewerMask;
+    };
+    const uint64 AllViewers = NumViewers >= MaxLODViewers ? ~uint64(0) : (uint64(1) << NumViewers) - 1;
+    
+    TArray<FPendingNode> Queue;
+    for (FPatchNode* Root : Roots)
+    {
+        Queue.Add({ Root, AllViewers });
+    }
+    
+    TArray<int32> UsedBudget;
+    UsedBudget.SetNumZeroed(NumViewers);
+    
+    for (int32 Head = 0; Head < Queue.Num(); ++Head)
     {
-        if (Root->Level < MaxLOD) Root->Subdivide();
+        const FPendingNode Pending = Queue[Head];
+        FPatchNode* Node = Pending.Node;
+        
+        // Frustum + horizon culling on the patch bounds (estimated until the patch is first built)
+        if (!Node->bHasExactBounds)
+        {
+            Node->EstimateBounds(PlanetRadius, -AltitudeBound, AltitudeBound);
+        }
+        const FSphere WorldSphere = Node->BoundingSphere.TransformBy(PlanetTransform);
+        
+        uint64 VisibleMask = 0;
+        int32 RefiningViewer = INDEX_NONE;
+        float RefiningDistance = MAX_flt;
+        for (int32 ViewerIndex = 0; ViewerIndex < NumViewers; ++ViewerIndex)
+        {
+            const uint64 Bit = uint64(1) << ViewerIndex;
+            if (!(Pending.ViewerMask & Bit) || !Viewers[ViewerIndex].View.IsVisible(WorldSphere))
+            {
+                continue;
+            }
+            VisibleMask |= Bit;
+            
+            // A split adds three leaves, charged once to the nearest viewer that wants it and can pay
+            const float Distance = FVector::Dist(Viewers[ViewerIndex].View.ViewOrigin, WorldSphere.Center);
+            if (Distance < WorldSphere.W * SplitFactor && Distance < RefiningDistance
+                && UsedBudget[ViewerIndex] + 3 <= Viewers[ViewerIndex].PatchBudget)
+            {
+                RefiningViewer = ViewerIndex;
+                RefiningDistance = Distance;
+            }
+        }
+        
+        if (NumViewers > 0 && VisibleMask == 0)
+        {
+            // Nothing below a culled node is drawn: drop its subtree and its payload (the cache keeps a copy)
+            Node->Merge();
+            Node->RenderData.Reset();
+            PatchesCulled++;
+            continue;
+        }
+        
+        if (RefiningViewer != INDEX_NONE && Node->Level < MaxLOD)
+        {
+            UsedBudget[RefiningViewer] += 3;
+            Node->Subdivide();
+            for (FPatchNode* Child : Node->Children)
+            {
+                Queue.Add({ Child, VisibleMask });
+            }
+            continue;
+        }
+        
+        // Leaf for this frame: children of a previous, finer split are no longer needed
+        Node->Merge();
+        VisiblePatches.Add(Node);
+    }
+    
+    ActivePatches = VisiblePatches;
+    
+    // Servers only need the physical surface: heights and indices, generated once per patch
+    if (bCollisionOnly)
+    {
+        const int32 ResolutionShift = CoreConfig ? CoreConfig->GenerationConfig.CollisionResolutionShift : 1;
+        int32 CollisionGenerated = 0;
+        for (FPatchNode* Patch : VisiblePatches)
+        {
+            if (!Patch->HasCollision())
+            {
+                Patch->GenerateCollision(PlanetRadius, Noise, ResolutionShift);
+                CollisionGenerated++;
+                TotalChunksGenerated++;
+            }
+        }
+        
+        LastLODUpdateTime = FPlatformTime::Seconds() - StartTime;
+        UPlanetSystemLogger::LogPerformance(TEXT("ProceduralPlanet"), 
+            FString::Printf(TEXT("Collision LOD Update took %.3fms, Patches: %d, Generated: %d, Culled: %d, Viewers: %d"), 
+            LastLODUpdateTime * 1000.0, VisiblePatches.Num(), CollisionGenerated, PatchesCulled, NumViewers));
+        return;
+    }
+    
+    for (int32 SectionIndex = 0; SectionIndex < VisiblePatches.Num(); ++SectionIndex)
+    {
+        FPatchNode* Patch = VisiblePatches[SectionIndex];
         
         // Try to get from cache first
-        FChunkKey CacheKey(Root->UVMin, Root->UVMax, Root->Level, Root->PatchSeed);
-        FChunkData CachedData;
+        const FChunkKey CacheKey = FChunkKey::FromUV(Patch->Face, Patch->UVMin, Patch->UVMax, Patch->Level, ChunkKeySeed);
+        FChunkDataPtr CachedData = ChunkCache ? ChunkCache->FindChunkData(CacheKey) : nullptr;
         
-        if (ChunkCache && ChunkCache->GetChunk(CacheKey, CachedData))
+        if (CachedData.IsValid())
         {
-            // Use cached data
-            MeshComp->CreateMeshSection_LinearColor(Root->Level, CachedData.Vertices, CachedData.Indices, 
-                                                   CachedData.Normals, CachedData.UVs, {}, {}, false);
+            // Use cached data: the patch shares the cached payload, no array copies
+            MeshComp->CreateMeshSection(SectionIndex, CachedData->Vertices, CachedData->Indices, CachedData->Normals,
+                                        CachedData->UVs, CachedData->BiomeIndices, {}, {}, CachedData->BiomeWeights, {}, false);
+            Patch->SetRenderData(CachedData.ToSharedRef());
+            CachedChunksUsed++;
+        }
+        else if (Patch->HasRenderData())
+        {
+            // Evicted from the cache but still held by the patch: re-upload and store it back instead of regenerating
+            const FChunkData& Data = *Patch->RenderData;
+            MeshComp->CreateMeshSection(SectionIndex, Data.Vertices, Data.Indices, Data.Normals,
+                                        Data.UVs, Data.BiomeIndices, {}, {}, Data.BiomeWeights, {}, false);
+            if (ChunkCache)
+            {
+                ChunkCache->StoreChunkData(CacheKey, Patch->RenderData.ToSharedRef());
+            }
             CachedChunksUsed++;
         }
         else
         {
             // Generate new chunk
-            Root->GenerateMesh(MeshComp, PlanetRadius, Noise);
+            Patch->GenerateMesh(MeshComp, SectionIndex, PlanetRadius, Noise);
             
-            // Cache the generated data
-            if (ChunkCache)
+            // Cache the generated payload by reference
+            if (ChunkCache && Patch->HasRenderData())
             {
-                FChunkData NewChunkData;
-                NewChunkData.Vertices = Root->Vertices;
-                NewChunkData.Indices = Root->Indices;
-                NewChunkData.Seed = Root->PatchSeed;
-                NewChunkData.LODLevel = Root->Level;
-                NewChunkData.UVMin = Root->UVMin;
-                NewChunkData.UVMax = Root->UVMax;
-                NewChunkData.UpdateAccessTime();
-                
-                ChunkCache->StoreChunk(CacheKey, NewChunkData);
+                ChunkCache->StoreChunkData(CacheKey, Patch->RenderData.ToSharedRef());
             }
             
             TotalChunksGenerated++;
         }
         
-        // Calculate biome and populate vegetation
-        uint32 Seed = Root->PatchSeed;
-        float Height = Noise->GetHeight(FVector::ZeroVector);
-        EBiomeType Biome = Biomes->GetBiome(Height, 0.f, 0.f);
-        
-        if (CoreConfig && CoreConfig->GenerationConfig.bEnableVegetation)
+        // Vegetation tier from patch level and viewer distance; placement runs on a worker
+        if (bVegetationEnabled && Patch->HasRenderData() && Patch->RenderData->Vertices.Num() > 0)
         {
-            Vegetation->Populate(Root->Vertices, Root->Indices, Biome, Seed);
+            const FVector PatchCenter = PlanetTransform.TransformPosition(Patch->BoundingSphere.Center);
+            float ViewerDistance = NumViewers > 0 ? MAX_flt : 0.0f;
+            for (const FPlanetLODViewer& Viewer : Viewers)
+            {
+                ViewerDistance = FMath::Min(ViewerDistance, FVector::Dist(Viewer.View.ViewOrigin, PatchCenter));
+            }
+            
+            // Samples anchored in face UV space so neighbouring patches share them across borders
+            FVegetationPatchRegion Region;
+            Region.UVMin = Patch->UVMin;
+            Region.UVMax = Patch->UVMax;
+            Region.FaceWorldSize = PlanetRadius * UE_HALF_PI;
+            Region.Seed = HashCombine(ChunkKeySeed, GetTypeHash(Patch->Face));
+            
+            Vegetation->UpdatePatch(Patch->GetPatchId(), Patch->Level, ViewerDistance, Patch->RenderData->Vertices, Patch->RenderData->BiomeMap, Region);
+            ActiveVegetationPatches.Add(Patch->GetPatchId());
         }
         
         // Notify plugins
         UPlanetSystemServiceLocator::GetInstance()->BroadcastChunkGenerated(
-            Root->Vertices.Num() > 0 ? Root->Vertices[0] : FVector::ZeroVector, 
-            Root->Level
+            Patch->HasRenderData() && Patch->RenderData->Vertices.Num() > 0 ? Patch->RenderData->Vertices[0] : FVector::ZeroVector, 
+            Patch->Level
         );
     }
     
+    // Retire patches that split or merged away (their instances stay until the replacements commit), then commit finished buffers
+    if (bVegetationEnabled)
+    {
+        Vegetation->PruneStalePatches(ActiveVegetationPatches);
+        Vegetation->CommitPendingPatches();
+    }
+    
     // Generate water if enabled
     if (CoreConfig && CoreConfig->GenerationConfig.bEnableWater)
     {
-        Water->GenerateOcean(MeshComp, PlanetRadius);
+        // Ocean sections follow the terrain sections; patches above sea level are skipped
+        Water->GenerateOcean(MeshComp, PlanetRadius, VisiblePatches, VisiblePatches.Num());
+    }
+    
+    // Low priority: warm the cache along the viewers' trajectories with what is left of the budget.
+    // The queue is rebuilt every update, so requests for a trajectory that changed are dropped unbuilt.
+    int32 ChunksPrefetched = 0;
+    const float PrefetchSeconds = CoreConfig ? CoreConfig->GenerationConfig.PrefetchSeconds : 0.0f;
+    if (ChunkCache && PrefetchSeconds > 0.0f)
+    {
+        FChunkPrefetcher::FParams Params;
+        Params.PlanetRadius = PlanetRadius;
+        Params.MaxLOD = MaxLOD;
+        Params.SplitFactor = SplitFactor;
+        Params.MinAltitude = -AltitudeBound;
+        Params.MaxAltitude = AltitudeBound;
+        Params.HorizonSeconds = PrefetchSeconds;
+        Params.KeySeed = ChunkKeySeed;
+        Prefetcher.Update(Roots, Viewers, PlanetTransform, Params, *ChunkCache);
+        
+        const double BudgetSeconds = CoreConfig->GenerationConfig.PrefetchBudgetMs / 1000.0;
+        ChunksPrefetched = Prefetcher.Process(Roots, *ChunkCache, PlanetRadius, Noise, BudgetSeconds);
+    }
+    else
+    {
+        Prefetcher.Cancel();
     }
     
     LastLODUpdateTime = FPlatformTime::Seconds() - StartTime;
     
     // Log performance metrics
     UPlanetSystemLogger::LogPerformance(TEXT("ProceduralPlanet"), 
-        FString::Printf(TEXT("LOD Update took %.3fms, Generated: %d, Cached: %d"), 
-        LastLODUpdateTime * 1000.0, TotalChunksGenerated, CachedChunksUsed));
+        FString::Printf(TEXT("LOD Update took %.3fms, Generated: %d, Cached: %d, Prefetched: %d, Culled: %d, Viewers: %d"), 
+        LastLODUpdateTime * 1000.0, TotalChunksGenerated, CachedChunksUsed, ChunksPrefetched, PatchesCulled, NumViewers));
     
     if (CoreConfig && CoreConfig->bEnablePerformanceProfiling)
     {
@@ -158,6 +384,132 @@ void AProceduralPlanet::UpdateLOD()
     }
 }
 
+float AProceduralPlanet::GetAltitudeBound() const
+{
+    // Erosion moves each vertex by at most its configured change, so noise amplitude plus that bounds every patch
+    const UNoiseModule* Noise = UPlanetSystemServiceLocator::GetNoiseService();
+    const UErosionModule* Erosion = UPlanetSystemServiceLocator::GetErosionService();
+    return (Noise ? Noise->GetMaxAmplitude() : 0.0f) + (Erosion ? Erosion->GetMaxHeightChange() : 0.0f);
+}
+
+int32 AProceduralPlanet::BuildLODViewers(TArray<FPlanetLODViewer>& OutViewers, float PlanetRadius) const
+{
+    OutViewers.Reset();
+    const UWorld* World = GetWorld();
+    if (!World)
+    {
+        return 0;
+    }
+    
+    const int32 DefaultBudget = CoreConfig ? CoreConfig->GenerationConfig.MaxPatchesPerViewer : 256;
+    
+    // The lowest possible surface occludes everything behind the horizon
+    const FVector PlanetCenter = GetActorLocation();
+    const float OccluderRadius = (PlanetRadius - GetAltitudeBound()) * GetActorScale3D().GetMin();
+    
+    float AspectRatio = 16.0f / 9.0f;
+    if (GEngine && GEngine->GameViewport && GEngine->GameViewport->Viewport)
+    {
+        const FIntPoint ViewportSize = GEngine->GameViewport->Viewport->GetSizeXY();
+        if (ViewportSize.Y > 0)
+        {
+            AspectRatio = float(ViewportSize.X) / float(ViewportSize.Y);
+        }
+    }
+    
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PC = It->Get();
+        if (!PC)
+        {
+            continue;
+        }
+        
+        FPlanetLODViewer Viewer;
+        if (PC->IsLocalController() && PC->PlayerCameraManager)
+        {
+            const APlayerCameraManager* Camera = PC->PlayerCameraManager;
+            Viewer.View.SetFrustum(Camera->GetCameraLocation(), Camera->GetCameraRotation(), Camera->GetFOVAngle(), AspectRatio);
+        }
+        else if (const APawn* Pawn = PC->GetPawn())
+        {
+            // Remote players on a server need collision all around them: horizon culling only
+            Viewer.View.ViewOrigin = Pawn->GetActorLocation();
+        }
+        else
+        {
+            continue;
+        }
+        
+        if (const APawn* Pawn = PC->GetPawn())
+        {
+            Viewer.Velocity = Pawn->GetVelocity();
+        }
+        
+        const int32* Budget = ViewerBudgets.Find(PC);
+        Viewer.PatchBudget = Budget ? *Budget : DefaultBudget;
+        Viewer.View.SetPlanet(PlanetCenter, OccluderRadius);
+        OutViewers.Add(MoveTemp(Viewer));
+    }
+    
+    for (const FVector& Location : AdditionalViewers)
+    {
+        FPlanetLODViewer& Viewer = OutViewers.AddDefaulted_GetRef();
+        Viewer.View.ViewOrigin = Location;
+        Viewer.View.SetPlanet(PlanetCenter, OccluderRadius);
+        Viewer.PatchBudget = DefaultBudget;
+    }
+    
+    if (OutViewers.Num() > MaxLODViewers)
+    {
+        UPlanetSystemLogger::LogWarning(TEXT("ProceduralPlanet"), 
+            FString::Printf(TEXT("%d viewers, only the first %d drive LOD"), OutViewers.Num(), MaxLODViewers));
+        OutViewers.SetNum(MaxLODViewers);
+    }
+    return OutViewers.Num();
+}
+
+float AProceduralPlanet::GetSurfaceHeight(const FVector& Dir)
+{
+    const float PlanetRadius = CoreConfig ? CoreConfig->GenerationConfig.BaseRadius : 1000.0f;
+    return HeightQuery.GetHeight(Roots, Dir, PlanetRadius, UPlanetSystemServiceLocator::GetNoiseService());
+}
+
+void AProceduralPlanet::GetSurfaceHeights(const TArray<FVector>& Dirs, TArray<float>& OutHeights)
+{
+    const float PlanetRadius = CoreConfig ? CoreConfig->GenerationConfig.BaseRadius : 1000.0f;
+    OutHeights.SetNumUninitialized(Dirs.Num());
+    HeightQuery.GetHeights(Roots, Dirs, PlanetRadius, UPlanetSystemServiceLocator::GetNoiseService(), OutHeights);
+}
+
+bool AProceduralPlanet::IsCollisionOnly() const
+{
+    return GenerationMode == EPlanetGenerationMode::CollisionOnly
+        || (GenerationMode == EPlanetGenerationMode::Auto && GetNetMode() == NM_DedicatedServer);
+}
+
+void AProceduralPlanet::SetAdditionalViewers(const TArray<FVector>& Locations)
+{
+    AdditionalViewers = Locations;
+}
+
+void AProceduralPlanet::SetViewerPatchBudget(APlayerController* Player, int32 Budget)
+{
+    if (!Player)
+    {
+        return;
+    }
+    
+    if (Budget < 0)
+    {
+        ViewerBudgets.Remove(Player);
+    }
+    else
+    {
+        ViewerBudgets.Add(Player, Budget);
+    }
+}
+
 void AProceduralPlanet::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
     Super::EndPlay(EndPlayReason);
@@ -168,12 +520,25 @@ void AProceduralPlanet::EndPlay(const EEndPlayReason::Type EndPlayReason)
     GetWorldTimerManager().ClearTimer(LODTimer);
     GetWorldTimerManager().ClearTimer(CacheCleanupTimer);
     
+    if (UVegetationSystem* Vegetation = UPlanetSystemServiceLocator::GetVegetationService())
+    {
+        Vegetation->ClearAllPatches();
+    }
+    
     // Cleanup quad tree
     for (FPatchNode* Root : Roots)
     {
         delete Root;
     }
     Roots.Empty();
+    ActivePatches.Empty();
+    HeightQuery.Reset();
+    
+    // Persist erosion results so the next session skips the simulation
+    if (UErosionModule* Erosion = UPlanetSystemServiceLocator::GetErosionService())
+    {
+        Erosion->FlushDeltaCache();
+    }
     
     UPlanetSystemLogger::LogInfo(TEXT("ProceduralPlanet"), TEXT("EndPlay completed - resources cleaned up"));
 }
@@ -0,0 +1,234 @@
+#include "Generation/Terrain/SurfaceHeightQuery.h"
+#include "Generation/Terrain/PatchNode.h"
+#include "Generation/Noise/NoiseModule.h"
+
+namespace
+{
+    bool ContainsUV(const FPatchNode& Node, const FVector2D& UV)
+    {
+        // raízes podem ter UVMin > UVMax em um eixo
+        return UV.X >= FMath::Min(Node.UVMin.X, Node.UVMax.X) && UV.X <= FMath::Max(Node.UVMin.X, Node.UVMax.X)
+            && UV.Y >= FMath::Min(Node.UVMin.Y, Node.UVMax.Y) && UV.Y <= FMath::Max(Node.UVMin.Y, Node.UVMax.Y);
+    }
+
+    bool HasRenderHeights(const FPatchNode& Node)
+    {
+        return Node.RenderData.IsValid() && Node.RenderData->Vertices.Num() == FMath::Square(Node.Resolution + 1);
+    }
+
+    FVector UVToDir(const FVector2D& UV)
+    {
+        return FVector((UV.X-0.5f)*2.f, (UV.Y-0.5f)*2.f, 1.f).GetSafeNormal();
+    }
+
+    /** Bilinear em uma grade (Res+1)^2; T em [0,1]^2 */
+    template <typename GetFn>
+    float SampleGrid(int32 Res, const FVector2D& T, GetFn&& Get)
+    {
+        const float FX = FMath::Clamp(T.X, 0.f, 1.f) * Res;
+        const float FY = FMath::Clamp(T.Y, 0.f, 1.f) * Res;
+        const int32 X0 = FMath::Min(int32(FX), Res - 1);
+        const int32 Y0 = FMath::Min(int32(FY), Res - 1);
+        const float AX = FX - X0;
+        const float AY = FY - Y0;
+        const int32 I0 = Y0 * (Res + 1) + X0;
+        const int32 I2 = I0 + Res + 1;
+        return FMath::Lerp(FMath::Lerp(Get(I0), Get(I0 + 1), AX), FMath::Lerp(Get(I2), Get(I2 + 1), AX), AY);
+    }
+}
+
+FSurfaceHeightQuery::FSurfaceHeightQuery(int32 InMaxTiles)
+    : MaxTiles(FMath::Max(InMaxTiles, 1))
+{
+}
+
+float FSurfaceHeightQuery::GetHeight(const TArray<FPatchNode*>& Roots, const FVector& Dir, float PlanetRadius, UNoiseModule* Noise)
+{
+    FVector2D UV;
+    if (!DirToUV(Dir, UV))
+    {
+        // fora da face coberta pela quadtree: avaliação direta
+        return Noise ? Noise->GetHeight(Dir.GetSafeNormal()) : 0.f;
+    }
+
+    if (const FPatchNode* Patch = FindPatch(Roots, UV, true))
+    {
+        PatchHits++;
+        return SamplePatch(*Patch, UV, PlanetRadius);
+    }
+
+    return Noise ? SampleTile(Roots, UV, Noise) : 0.f;
+}
+
+void FSurfaceHeightQuery::GetHeights(const TArray<FPatchNode*>& Roots, TArrayView<const FVector> Dirs, float PlanetRadius,
+                                     UNoiseModule* Noise, TArrayView<float> OutHeights)
+{
+    check(Dirs.Num() == OutHeights.Num());
+
+    // consultas vizinhas costumam cair no mesmo patch: testa o último antes de descer a árvore
+    const FPatchNode* LastPatch = nullptr;
+    for (int32 i = 0; i < Dirs.Num(); ++i)
+    {
+        FVector2D UV;
+        if (!DirToUV(Dirs[i], UV))
+        {
+            OutHeights[i] = Noise ? Noise->GetHeight(Dirs[i].GetSafeNormal()) : 0.f;
+            continue;
+        }
+
+        const FPatchNode* Patch = (LastPatch && !LastPatch->bIsSplit && ContainsUV(*LastPatch, UV))
+            ? LastPatch : FindPatch(Roots, UV, true);
+        if (Patch)
+        {
+            PatchHits++;
+            OutHeights[i] = SamplePatch(*Patch, UV, PlanetRadius);
+            LastPatch = Patch;
+        }
+        else
+        {
+            OutHeights[i] = Noise ? SampleTile(Roots, UV, Noise) : 0.f;
+        }
+    }
+}
+
+void FSurfaceHeightQuery::Reset()
+{
+    Tiles.Empty();
+    TileIndex.Empty();
+    UseCounter = 0;
+}
+
+void FSurfaceHeightQuery::GetStats(int32& OutPatchHits, int32& OutTileHits, int32& OutTileMisses) const
+{
+    OutPatchHits = PatchHits;
+    OutTileHits = TileHits;
+    OutTileMisses = TileMisses;
+}
+
+bool FSurfaceHeightQuery::DirToUV(const FVector& Dir, FVector2D& OutUV)
+{
+    if (Dir.Z <= KINDA_SMALL_NUMBER)
+    {
+        return false;
+    }
+
+    // inverso de Dir = normalize((u-0.5)*2, (v-0.5)*2, 1)
+    OutUV = FVector2D(Dir.X / Dir.Z * 0.5f + 0.5f, Dir.Y / Dir.Z * 0.5f + 0.5f);
+    return OutUV.X >= 0.f && OutUV.X <= 1.f && OutUV.Y >= 0.f && OutUV.Y <= 1.f;
+}
+
+const FPatchNode* FSurfaceHeightQuery::FindPatch(const TArray<FPatchNode*>& Roots, const FVector2D& UV, bool bWithData)
+{
+    const FPatchNode* Best = nullptr;
+    for (const FPatchNode* Root : Roots)
+    {
+        const FPatchNode* Node = (Root && ContainsUV(*Root, UV)) ? Root : nullptr;
+        while (Node)
+        {
+            const bool bHasData = HasRenderHeights(*Node) || Node->HasCollision();
+            if ((!bWithData || bHasData) && (!Best || Node->Level > Best->Level))
+            {
+                Best = Node;
+            }
+
+            const FPatchNode* Next = nullptr;
+            if (Node->bIsSplit)
+            {
+                for (const FPatchNode* Child : Node->Children)
+                {
+                    if (Child && ContainsUV(*Child, UV))
+                    {
+                        Next = Child;
+                        break;
+                    }
+                }
+            }
+            Node = Next;
+        }
+    }
+    return Best;
+}
+
+float FSurfaceHeightQuery::SamplePatch(const FPatchNode& Patch, const FVector2D& UV, float PlanetRadius)
+{
+    const FVector2D Size = Patch.UVMax - Patch.UVMin;
+    const FVector2D T((UV.X - Patch.UVMin.X) / Size.X, (UV.Y - Patch.UVMin.Y) / Size.Y);
+
+    if (HasRenderHeights(Patch))
+    {
+        const TArray<FVector>& Vertices = Patch.RenderData->Vertices;
+        return SampleGrid(Patch.Resolution, T, [&](int32 i) { return Vertices[i].Size() - PlanetRadius; });
+    }
+    return SampleGrid(Patch.CollisionResolution, T, [&](int32 i) { return Patch.CollisionHeights[i]; });
+}
+
+float FSurfaceHeightQuery::SampleTile(const TArray<FPatchNode*>& Roots, const FVector2D& UV, UNoiseModule* Noise)
+{
+    const int32 NumCells = 1 << TileLevel;
+    const int32 CellX = FMath::Clamp(int32(UV.X * NumCells), 0, NumCells - 1);
+    const int32 CellY = FMath::Clamp(int32(UV.Y * NumCells), 0, NumCells - 1);
+
+    const FTile& Tile = FindOrBuildTile(Roots, CellX, CellY, Noise);
+    const FVector2D T(UV.X * NumCells - CellX, UV.Y * NumCells - CellY);
+    return SampleGrid(TileResolution, T, [&](int32 i) { return Tile.Heights[i]; });
+}
+
+FSurfaceHeightQuery::FTile& FSurfaceHeightQuery::FindOrBuildTile(const TArray<FPatchNode*>& Roots, int32 CellX, int32 CellY, UNoiseModule* Noise)
+{
+    // o noise é semeado por patch: usa a seed do patch que cobre o tile, como o render faria.
+    // O dono muda com o LOD, então a seed faz parte da chave: um tile de outra seed nunca é reaproveitado
+    const float CellSize = 1.f / (1 << TileLevel);
+    const FVector2D CellMin(CellX * CellSize, CellY * CellSize);
+    const FPatchNode* Owner = FindPatch(Roots, CellMin + FVector2D(CellSize * 0.5f), false);
+    const int32 PreviousSeed = Noise->Seed;
+    const uint32 TileSeed = Owner ? Owner->PatchSeed : uint32(PreviousSeed);
+
+    const uint64 Key = (uint64(TileSeed) << 32) | (uint32(CellX) << 16) | uint32(CellY);
+    if (const int32* Found = TileIndex.Find(Key))
+    {
+        TileHits++;
+        FTile& Tile = Tiles[*Found];
+        Tile.LastUsed = ++UseCounter;
+        return Tile;
+    }
+    TileMisses++;
+
+    // slot livre ou o tile usado há mais tempo
+    int32 Slot = Tiles.Num();
+    if (Tiles.Num() < MaxTiles)
+    {
+        Tiles.AddDefaulted();
+    }
+    else
+    {
+        Slot = 0;
+        for (int32 i = 1; i < Tiles.Num(); ++i)
+        {
+            if (Tiles[i].LastUsed < Tiles[Slot].LastUsed)
+            {
+                Slot = i;
+            }
+        }
+        TileIndex.Remove(Tiles[Slot].Key);
+    }
+
+    FTile& Tile = Tiles[Slot];
+    Tile.Key = Key;
+    Tile.LastUsed = ++UseCounter;
+    TileIndex.Add(Key, Slot);
+
+    Noise->SetSeed(int32(TileSeed));
+
+    Tile.Heights.SetNumUninitialized(FMath::Square(TileResolution + 1));
+    for (int32 y = 0; y <= TileResolution; ++y)
+    {
+        for (int32 x = 0; x <= TileResolution; ++x)
+        {
+            const FVector2D UV = CellMin + FVector2D(x, y) * (CellSize / TileResolution);
+            Tile.Heights[y * (TileResolution + 1) + x] = Noise->GetHeight(UVToDir(UV));
+        }
+    }
+
+    Noise->SetSeed(PreviousSeed);
+    return Tile;
+}
@@ -3,6 +3,7 @@
 #include "Core/Events/PlanetEventBus.h"
 #include "Configuration/DataAssets/CoreConfig.h"
 #include "Core/Cache/PlanetCachePolicy.h"
+#include "Core/Cache/PlanetCacheMemory.h"
 #include "Engine/World.h"
 #include "HAL/PlatformTime.h"
 
@@ -14,15 +15,18 @@ UPlanetChunkNetworkCache::UPlanetChunkNetworkCache()
     
     // Inicializar configuração
     MaxCacheSize = 1000;
+    MaxCacheBytes = 256ll * 1024 * 1024;
     ReplacementPolicy = EPlanetCachePolicy::LRU;
     MaxChunkAge = 300.0f; // 5 minutos
     
+    Cache.SetMaxEntries(MaxCacheSize);
+    Cache.SetMaxBytes(MaxCacheBytes);
+    Cache.SetPolicy(ReplacementPolicy);
+    
     // Inicializar estatísticas
-    CacheHits = 0;
-    CacheMisses = 0;
     ChunksSynchronized = 0;
     ChunksRemoved = 0;
-    TotalOperationTime = 0.0f;
+    TotalOperationCycles = 0;
     
     // Log de inicialização
     if (Logger)
@@ -31,9 +35,25 @@ UPlanetChunkNetworkCache::UPlanetChunkNetworkCache()
     }
 }
 
+void UPlanetChunkNetworkCache::PostInitProperties()
+{
+    Super::PostInitProperties();
+    
+    if (!HasAnyFlags(RF_ClassDefaultObject))
+    {
+        MemoryTrimHandle = FPlanetCacheMemory::OnTrim().AddUObject(this, &UPlanetChunkNetworkCache::HandleMemoryTrim);
+    }
+}
+
+void UPlanetChunkNetworkCache::BeginDestroy()
+{
+    FPlanetCacheMemory::OnTrim().Remove(MemoryTrimHandle);
+    Super::BeginDestroy();
+}
+
 void UPlanetChunkNetworkCache::SynchronizeChunk(const FVector& Position, const FPlanetChunk& Chunk)
 {
-    const double StartTime = FPlatformTime::Seconds();
+    const uint64 StartCycles = FPlatformTime::Cycles64();
     
     try
     {
@@ -43,43 +63,22 @@ void UPlanetChunkNetworkCache::SynchronizeChunk(const FVector& Position, const F
             return;
         }
         
-        // Verificar se cache está cheio
-        if (IsCacheFull())
+        // Armazenar chunk; o núcleo aplica a política de substituição se o shard estiver cheio
         {
-            // Aplicar política de substituição
-            switch (ReplacementPolicy)
-            {
-                case EPlanetCachePolicy::LRU:
-                    RemoveLeastRecentlyUsed();
-                    break;
-                case EPlanetCachePolicy::LFU:
-                    RemoveLeastFrequentlyUsed();
-                    break;
-                case EPlanetCachePolicy::Random:
-                    RemoveRandomChunk();
-                    break;
-                default:
-                    RemoveLeastRecentlyUsed();
-                    break;
-            }
+            LLM_SCOPE_BYTAG(PlanetNetworkChunkCache);
+            Cache.Store(Position, MakeShared<const FPlanetChunk, ESPMode::ThreadSafe>(Chunk), Chunk.GetAllocatedSize());
         }
         
-        // Armazenar chunk
-        NetworkedChunks.Add(Position, Chunk);
-        ChunkTimestamps.Add(Position, FPlatformTime::Seconds());
-        ChunkAccessCounts.Add(Position, 0);
-        
-        // Atualizar ordem de acesso
-        AccessOrder.Remove(Position);
-        AccessOrder.Add(Position);
-        
-        ChunksSynchronized++;
+        FPlatformAtomics::InterlockedIncrement(&ChunksSynchronized);
+        AddOperationTime(StartCycles);
+        Instrumentation.Count(EPlanetCacheOp::Add, true);
         
-        // Calcular tempo de operação
-        const double EndTime = FPlatformTime::Seconds();
-        TotalOperationTime += static_cast<float>(EndTime - StartTime);
-        
-        LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Chunk sincronizado: %s"), *Position.ToString()));
+        // caminho quente das threads de rede: mensagem só nas operações rastreadas
+        if (FPlanetCacheInstrumentation::ShouldTrace())
+        {
+            Instrumentation.AddSample(EPlanetCacheOp::Add, FPlatformTime::Cycles64() - StartCycles);
+            LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Chunk sincronizado: %s"), *Position.ToString()));
+        }
     }
     catch (const std::exception& e)
     {
@@ -90,7 +89,7 @@ void UPlanetChunkNetworkCache::SynchronizeChunk(const FVector& Position, const F
 
 bool UPlanetChunkNetworkCache::GetChunk(const FVector& Position, FPlanetChunk& OutChunk)
 {
-    const double StartTime = FPlatformTime::Seconds();
+    const uint64 StartCycles = FPlatformTime::Cycles64();
     
     try
     {
@@ -100,34 +99,24 @@ bool UPlanetChunkNetworkCache::GetChunk(const FVector& Position, FPlanetChunk& O
             return false;
         }
         
-        // Buscar chunk no cache
-        FPlanetChunk* FoundChunk = NetworkedChunks.Find(Position);
+        // Buscar chunk no cache (atualiza recência, acessos e hits/misses)
+        TSharedPtr<const FPlanetChunk, ESPMode::ThreadSafe> FoundChunk = Cache.Find(Position);
+        AddOperationTime(StartCycles);
+        Instrumentation.Count(EPlanetCacheOp::Find, FoundChunk.IsValid());
+        
+        if (FPlanetCacheInstrumentation::ShouldTrace())
+        {
+            Instrumentation.AddSample(EPlanetCacheOp::Find, FPlatformTime::Cycles64() - StartCycles);
+            LogCacheEvent(FoundChunk ? EPlanetEventType::Info : EPlanetEventType::Warning,
+                FString::Printf(TEXT("Cache %s: %s"), FoundChunk ? TEXT("hit") : TEXT("miss"), *Position.ToString()));
+        }
+        
         if (FoundChunk)
         {
             OutChunk = *FoundChunk;
-            
-            // Atualizar estatísticas
-            UpdateAccessStats(Position);
-            CacheHits++;
-            
-            // Calcular tempo de operação
-            const double EndTime = FPlatformTime::Seconds();
-            TotalOperationTime += static_cast<float>(EndTime - StartTime);
-            
-            LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Cache hit: %s"), *Position.ToString()));
             return true;
         }
-        else
-        {
-            CacheMisses++;
-            
-            // Calcular tempo de operação
-            const double EndTime = FPlatformTime::Seconds();
-            TotalOperationTime += static_cast<float>(EndTime - StartTime);
-            
-            LogCacheEvent(EPlanetEventType::Warning, FString::Printf(TEXT("Cache miss: %s"), *Position.ToString()));
-            return false;
-        }
+        return false;
     }
     catch (const std::exception& e)
     {
@@ -139,100 +128,65 @@ bool UPlanetChunkNetworkCache::GetChunk(const FVector& Position, FPlanetChunk& O
 
 void UPlanetChunkNetworkCache::RemoveChunk(const FVector& Position)
 {
-    try
+    if (!ValidatePosition(Position))
     {
-        if (!ValidatePosition(Position))
-        {
-            LogCacheEvent(EPlanetEventType::Error, TEXT("Posição inválida para remoção"));
-            return;
-        }
-        
-        // Remover chunk
-        NetworkedChunks.Remove(Position);
-        ChunkTimestamps.Remove(Position);
-        ChunkAccessCounts.Remove(Position);
-        AccessOrder.Remove(Position);
-        
-        ChunksRemoved++;
-        
-        LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Chunk removido: %s"), *Position.ToString()));
+        LogCacheEvent(EPlanetEventType::Error, TEXT("Posição inválida para remoção"));
+        return;
     }
-    catch (const std::exception& e)
+    
+    if (Cache.Remove(Position))
     {
-        const FString ErrorMsg = FString::Printf(TEXT("Erro na remoção de chunk: %s"), UTF8_TO_TCHAR(e.what()));
-        LogCacheEvent(EPlanetEventType::Error, ErrorMsg);
+        FPlatformAtomics::InterlockedIncrement(&ChunksRemoved);
+        LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Chunk removido: %s"), *Position.ToString()));
     }
 }
 
 void UPlanetChunkNetworkCache::CleanupOldChunks(float MaxAge)
 {
-    try
-    {
-        const double CurrentTime = FPlatformTime::Seconds();
-        TArray<FVector> ChunksToRemove;
-        
-        // Identificar chunks antigos
-        for (const auto& Pair : ChunkTimestamps)
-        {
-            const float Age = static_cast<float>(CurrentTime - Pair.Value);
-            if (Age > MaxAge)
-            {
-                ChunksToRemove.Add(Pair.Key);
-            }
-        }
-        
-        // Remover chunks antigos
-        for (const FVector& Position : ChunksToRemove)
-        {
-            RemoveChunk(Position);
-        }
-        
-        if (ChunksToRemove.Num() > 0)
-        {
-            LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Limpeza concluída: %d chunks removidos"), ChunksToRemove.Num()));
-        }
-    }
-    catch (const std::exception& e)
+    // Idade conta a partir do último acesso
+    const int32 Removed = Cache.RemoveExpired(MaxAge);
+    if (Removed > 0)
     {
-        const FString ErrorMsg = FString::Printf(TEXT("Erro na limpeza de chunks: %s"), UTF8_TO_TCHAR(e.what()));
-        LogCacheEvent(EPlanetEventType::Error, ErrorMsg);
+        FPlatformAtomics::InterlockedAdd(&ChunksRemoved, Removed);
+        LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Limpeza concluída: %d chunks removidos"), Removed));
     }
 }
 
 void UPlanetChunkNetworkCache::SetMaxCacheSize(int32 MaxSize)
 {
     MaxCacheSize = FMath::Max(1, MaxSize);
+    Cache.SetMaxEntries(MaxCacheSize);
     LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Tamanho máximo do cache definido: %d"), MaxSize));
 }
 
 int32 UPlanetChunkNetworkCache::GetCacheSize() const
 {
-    return NetworkedChunks.Num();
+    return Cache.Num();
+}
+
+int64 UPlanetChunkNetworkCache::GetCacheBytes() const
+{
+    return Cache.GetBytes();
+}
+
+void UPlanetChunkNetworkCache::SetMaxCacheBytes(int64 MaxBytes)
+{
+    MaxCacheBytes = FMath::Max<int64>(0, MaxBytes);
+    Cache.SetMaxBytes(MaxCacheBytes);
+    LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Limite de memória do cache definido: %.2f MB"), MaxCacheBytes / (1024.0f * 1024.0f)));
 }
 
 bool UPlanetChunkNetworkCache::IsCacheFull() const
 {
-    return NetworkedChunks.Num() >= MaxCacheSize;
+    return Cache.Num() >= MaxCacheSize;
 }
 
 void UPlanetChunkNetworkCache::ClearCache()
 {
-    try
-    {
-        const int32 PreviousSize = NetworkedChunks.Num();
-        
-        NetworkedChunks.Empty();
-        ChunkTimestamps.Empty();
-        ChunkAccessCounts.Empty();
-        AccessOrder.Empty();
-        
-        LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Cache limpo: %d chunks removidos"), PreviousSize));
-    }
-    catch (const std::exception& e)
-    {
-        const FString ErrorMsg = FString::Printf(TEXT("Erro na limpeza do cache: %s"), UTF8_TO_TCHAR(e.what()));
-        LogCacheEvent(EPlanetEventType::Error, ErrorMsg);
-    }
+    const int32 PreviousSize = Cache.Num();
+    Cache.Clear();
+    
+    LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Cache limpo: %d chunks removidos"), PreviousSize));
 }
 
 void UPlanetChunkNetworkCache::GetNetworkStats(FString& OutStats) const
@@ -244,37 +198,43 @@ void UPlanetChunkNetworkCache::GetNetworkStats(FString& OutStats) const
         TEXT("Tamanho Atual: %d/%d\n")
         TEXT("Taxa de Hit: %.2f%%\n")
         TEXT("Tempo Total: %.3fms\n")
-        TEXT("Política: %s\n"),
+        TEXT("Política: %s\n")
+        TEXT("Operações:\n%s"),
         ChunksSynchronized,
         ChunksRemoved,
-        NetworkedChunks.Num(),
+        Cache.Num(),
         MaxCacheSize,
         CalculateHitRate() * 100.0f,
-        TotalOperationTime * 1000.0f,
-        *GetCachePolicyString(ReplacementPolicy)
+        FPlatformTime::ToMilliseconds64(FPlatformAtomics::AtomicRead(&TotalOperationCycles)),
+        *GetCachePolicyString(ReplacementPolicy),
+        *Instrumentation.GetReport()
     );
 }
 
 void UPlanetChunkNetworkCache::GetCacheStats(FString& OutStats) const
 {
-    const float HitRate = CalculateHitRate();
-    const float Efficiency = CalculateCacheEfficiency();
+    const auto Stats = Cache.GetStats();
     
     OutStats = FString::Printf(
         TEXT("=== Estatísticas de Cache ===\n")
-        TEXT("Hits: %d\n")
-        TEXT("Misses: %d\n")
+        TEXT("Hits: %lld\n")
+        TEXT("Misses: %lld\n")
+        TEXT("Evictions: %lld\n")
         TEXT("Taxa de Hit: %.2f%%\n")
         TEXT("Eficiência: %.2f%%\n")
         TEXT("Tamanho: %d/%d\n")
+        TEXT("Memória: %.2f/%.2f MB\n")
         TEXT("Política: %s\n")
         TEXT("Idade Máxima: %.1fs\n"),
-        CacheHits,
-        CacheMisses,
-        HitRate * 100.0f,
-        Efficiency * 100.0f,
-        NetworkedChunks.Num(),
+        Stats.Hits,
+        Stats.Misses,
+        Stats.Evictions,
+        CalculateHitRate() * 100.0f,
+        CalculateCacheEfficiency() * 100.0f,
+        Stats.Entries,
         MaxCacheSize,
+        Stats.Bytes / (1024.0f * 1024.0f),
+        MaxCacheBytes / (1024.0f * 1024.0f),
         *GetCachePolicyString(ReplacementPolicy),
         MaxChunkAge
     );
@@ -282,60 +242,35 @@ void UPlanetChunkNetworkCache::GetCacheStats(FString& OutStats) const
 
 void UPlanetChunkNetworkCache::ResetStats()
 {
-    CacheHits = 0;
-    CacheMisses = 0;
-    ChunksSynchronized = 0;
-    ChunksRemoved = 0;
-    TotalOperationTime = 0.0f;
+    Cache.ResetStats();
+    FPlatformAtomics::InterlockedExchange(&ChunksSynchronized, 0);
+    FPlatformAtomics::InterlockedExchange(&ChunksRemoved, 0);
+    FPlatformAtomics::InterlockedExchange(&TotalOperationCycles, 0);
+    Instrumentation.ResetStats();
     
     LogCacheEvent(EPlanetEventType::Info, TEXT("Estatísticas de cache resetadas"));
 }
 
 void UPlanetChunkNetworkCache::OptimizeCache()
 {
-    try
-    {
-        const int32 InitialSize = NetworkedChunks.Num();
-        
-        // Limpar chunks antigos
-        CleanupOldChunks(MaxChunkAge);
-        
-        // Otimizar baseado na política
-        switch (ReplacementPolicy)
-        {
-            case EPlanetCachePolicy::LRU:
-                // Manter apenas os chunks mais recentemente usados
-                while (NetworkedChunks.Num() > MaxCacheSize * 0.8f)
-                {
-                    RemoveLeastRecentlyUsed();
-                }
-                break;
-                
-            case EPlanetCachePolicy::LFU:
-                // Manter apenas os chunks mais frequentemente usados
-                while (NetworkedChunks.Num() > MaxCacheSize * 0.8f)
-                {
-                    RemoveLeastFrequentlyUsed();
-                }
-                break;
-                
-            default:
-                break;
-        }
-        
-        const int32 FinalSize = NetworkedChunks.Num();
-        LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Cache otimizado: %d -> %d chunks"), InitialSize, FinalSize));
-    }
-    catch (const std::exception& e)
+    const int32 InitialSize = Cache.Num();
+    
+    // Limpar chunks antigos
+    CleanupOldChunks(MaxChunkAge);
+    
+    // Manter 80% da capacidade, removendo pela política atual
+    if (ReplacementPolicy != EPlanetCachePolicy::Random)
     {
-        const FString ErrorMsg = FString::Printf(TEXT("Erro na otimização do cache: %s"), UTF8_TO_TCHAR(e.what()));
-        LogCacheEvent(EPlanetEventType::Error, ErrorMsg);
+        FPlatformAtomics::InterlockedAdd(&ChunksRemoved, Cache.TrimToFraction(0.8f));
     }
+    
+    LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Cache otimizado: %d -> %d chunks"), InitialSize, Cache.Num()));
 }
 
 void UPlanetChunkNetworkCache::SetReplacementPolicy(EPlanetCachePolicy Policy)
 {
     ReplacementPolicy = Policy;
+    Cache.SetPolicy(Policy);
     LogCacheEvent(EPlanetEventType::Info, FString::Printf(TEXT("Política de cache alterada: %s"), *GetCachePolicyString(Policy)));
 }
 
@@ -344,73 +279,16 @@ EPlanetCachePolicy UPlanetChunkNetworkCache::GetReplacementPolicy() const
     return ReplacementPolicy;
 }
 
-void UPlanetChunkNetworkCache::UpdateAccessStats(const FVector& Position)
+void UPlanetChunkNetworkCache::HandleMemoryTrim(float KeepFraction)
 {
-    // Atualizar contador de acesso
-    int32* AccessCount = ChunkAccessCounts.Find(Position);
-    if (AccessCount)
-    {
-        (*AccessCount)++;
-    }
-    
-    // Atualizar ordem de acesso (LRU)
-    AccessOrder.Remove(Position);
-    AccessOrder.Add(Position);
-}
-
-void UPlanetChunkNetworkCache::RemoveLeastRecentlyUsed()
-{
-    if (AccessOrder.Num() > 0)
-    {
-        const FVector PositionToRemove = AccessOrder[0];
-        RemoveChunk(PositionToRemove);
-    }
-}
-
-void UPlanetChunkNetworkCache::RemoveLeastFrequentlyUsed()
-{
-    if (ChunkAccessCounts.Num() == 0)
-    {
-        return;
-    }
-    
-    // Encontrar chunk com menor contador de acesso
-    FVector PositionToRemove = FVector::ZeroVector;
-    int32 MinAccessCount = MAX_int32;
-    
-    for (const auto& Pair : ChunkAccessCounts)
-    {
-        if (Pair.Value < MinAccessCount)
-        {
-            MinAccessCount = Pair.Value;
-            PositionToRemove = Pair.Key;
-        }
-    }
-    
-    if (MinAccessCount != MAX_int32)
-    {
-        RemoveChunk(PositionToRemove);
-    }
+    // só contadores: sob pressão de memória nada de formatar strings
+    const int32 Removed = Cache.TrimUsage(KeepFraction);
+    FPlatformAtomics::InterlockedAdd(&ChunksRemoved, Removed);
 }
 
-void UPlanetChunkNetworkCache::RemoveRandomChunk()
+void UPlanetChunkNetworkCache::AddOperationTime(uint64 StartCycles)
 {
-    if (NetworkedChunks.Num() > 0)
-    {
-        // Escolher posição aleatória
-        const int32 RandomIndex = FMath::RandRange(0, NetworkedChunks.Num() - 1);
-        int32 CurrentIndex = 0;
-        
-        for (const auto& Pair : NetworkedChunks)
-        {
-            if (CurrentIndex == RandomIndex)
-            {
-                RemoveChunk(Pair.Key);
-                break;
-            }
-            CurrentIndex++;
-        }
-    }
+    FPlatformAtomics::InterlockedAdd(&TotalOperationCycles, int64(FPlatformTime::Cycles64() - StartCycles));
 }
 
 FString UPlanetChunkNetworkCache::CalculatePositionHash(const FVector& Position) const
@@ -435,7 +313,8 @@ void UPlanetChunkNetworkCache::LogCacheEvent(EPlanetEventType EventType, const F
         Logger->LogInfo(TEXT("PlanetChunkNetworkCache"), Details);
     }
     
-    if (EventBus)
+    // O event bus não é thread-safe; eventos de threads de rede ficam só no log
+    if (EventBus && IsInGameThread())
     {
         FPlanetSystemEvent Event;
         Event.EventType = EventType;
@@ -449,13 +328,14 @@ void UPlanetChunkNetworkCache::LogCacheEvent(EPlanetEventType EventType, const F
 
 float UPlanetChunkNetworkCache::CalculateHitRate() const
 {
-    const int32 TotalRequests = CacheHits + CacheMisses;
+    const auto Stats = Cache.GetStats();
+    const int64 TotalRequests = Stats.Hits + Stats.Misses;
     if (TotalRequests == 0)
     {
         return 0.0f;
     }
     
-    return static_cast<float>(CacheHits) / static_cast<float>(TotalRequests);
+    return static_cast<float>(double(Stats.Hits) / double(TotalRequests));
 }
 
 float UPlanetChunkNetworkCache::CalculateCacheEfficiency() const
@@ -466,7 +346,7 @@ float UPlanetChunkNetworkCache::CalculateCacheEfficiency() const
     }
     
     const float HitRate = CalculateHitRate();
-    const float Utilization = static_cast<float>(NetworkedChunks.Num()) / static_cast<float>(MaxCacheSize);
+    const float Utilization = static_cast<float>(Cache.Num()) / static_cast<float>(MaxCacheSize);
     
     // Eficiência = Taxa de Hit * Utilização
     return HitRate * Utilization;
@@ -482,6 +362,10 @@ FString UPlanetChunkNetworkCache::GetCachePolicyString(EPlanetCachePolicy Policy
             return TEXT("LFU (Least Frequently Used)");
         case EPlanetCachePolicy::Random:
             return TEXT("Random");
+        case EPlanetCachePolicy::Priority:
+            return TEXT("Priority");
+        case EPlanetCachePolicy::GDSF:
+            return TEXT("GDSF (GreedyDual-Size-Frequency)");
         default:
             return TEXT("Unknown");
     }
@@ -1,25 +1,117 @@
 #include "Rendering/Chunks/ChunkCache.h"
+#include "Rendering/Chunks/ChunkDiskCache.h"
+#include "Core/Cache/PlanetCacheMemory.h"
+#include "Core/Cache/PlanetCacheTrace.h"
 #include "HAL/PlatformTime.h"
 #include "Engine/Engine.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+
+TSet<int32> UChunkCache::ActiveDiskCacheSlots;
+
+namespace
+{
+    /** Disk cache directory of one cache in one process; its lock file sits next to it as <name>.lock */
+    FString GetDiskCacheName(uint32 ProcessId, int32 Slot)
+    {
+        return FString::Printf(TEXT("P%u_Cache%d"), ProcessId, Slot);
+    }
+    
+    /**
+     * Deletes disk cache directories whose owner process is gone. Other live processes sharing Saved
+     * (dedicated server plus client, multi-process PIE) keep theirs: a running owner is skipped, and on
+     * platforms where open files cannot be deleted the held lock file also protects against a reused pid.
+     */
+    void DeleteStaleDiskCaches(const FString& Root)
+    {
+        TArray<FString> Names;
+        IFileManager::Get().FindFiles(Names, *FPaths::Combine(Root, TEXT("*")), false, true);
+        
+        const uint32 CurrentProcessId = FPlatformProcess::GetCurrentProcessId();
+        for (const FString& Name : Names)
+        {
+            FString ProcessPart;
+            if (!Name.StartsWith(TEXT("P")) || !Name.Split(TEXT("_"), &ProcessPart, nullptr))
+            {
+                continue;
+            }
+            
+            const uint32 ProcessId = uint32(FCString::Strtoui64(*ProcessPart + 1, nullptr, 10));
+            if (ProcessId == CurrentProcessId || FPlatformProcess::IsApplicationRunning(ProcessId))
+            {
+                continue;
+            }
+            
+            const FString LockPath = FPaths::Combine(Root, Name + TEXT(".lock"));
+            if (IFileManager::Get().FileExists(*LockPath) && !IFileManager::Get().Delete(*LockPath, false, false, true))
+            {
+                continue;
+            }
+            IFileManager::Get().DeleteDirectory(*FPaths::Combine(Root, Name), false, true);
+        }
+    }
+}
 
 UChunkCache::UChunkCache()
 {
     MaxCacheSize = 1000;
     CacheTimeoutSeconds = 300.0;
     bEnableCache = true;
-    CacheHits = 0;
-    CacheMisses = 0;
+    Cache.SetMaxEntries(MaxCacheSize);
+    Cache.SetMaxBytes(MaxCacheBytes);
+    Cache.SetPolicy(ReplacementPolicy);
+    
+    ColdCache.SetMaxEntries(MAX_int32);
+    ColdCache.SetMaxBytes(MaxColdCacheBytes);
+    ColdCache.SetPolicy(EPlanetCachePolicy::LRU);
 }
 
-void UChunkCache::SetMaxCacheSize(int32 NewMaxSize)
+UChunkCache::~UChunkCache()
 {
-    MaxCacheSize = FMath::Max(1, NewMaxSize);
+}
+
+void UChunkCache::PostInitProperties()
+{
+    Super::PostInitProperties();
     
-    // If we're over the new limit, evict oldest chunks
-    if (CachedChunks.Num() > MaxCacheSize)
+    if (HasAnyFlags(RF_ClassDefaultObject))
     {
-        EvictOldestChunks(CachedChunks.Num() - MaxCacheSize);
+        return;
     }
+    
+    MemoryTrimHandle = FPlanetCacheMemory::OnTrim().AddUObject(this, &UChunkCache::HandleMemoryTrim);
+    
+    Cache.SetEvictionHandler([this](const FChunkKey& Key, const FChunkDataRef& Data) { HandleHotEviction(Key, Data); });
+    ColdCache.SetEvictionHandler([this](const FChunkKey& Key, const FCompressedChunkRef& Compressed) { HandleColdEviction(Key, Compressed); });
+    
+    if (bEnableCache && bEnableDiskCache)
+    {
+        CreateDiskCache();
+    }
+}
+
+void UChunkCache::BeginDestroy()
+{
+    FPlanetCacheMemory::OnTrim().Remove(MemoryTrimHandle);
+    Cache.SetEvictionHandler(nullptr);
+    ColdCache.SetEvictionHandler(nullptr);
+    DestroyDiskCache();
+    Super::BeginDestroy();
+}
+
+void UChunkCache::SetMaxCacheSize(int32 NewMaxSize)
+{
+    MaxCacheSize = FMath::Max(1, NewMaxSize);
+    
+    // Evicts down to the new limit
+    Cache.SetMaxEntries(MaxCacheSize);
+}
+
+void UChunkCache::SetMaxCacheBytes(int64 NewMaxBytes)
+{
+    MaxCacheBytes = FMath::Max<int64>(0, NewMaxBytes);
+    Cache.SetMaxBytes(MaxCacheBytes);
 }
 
 void UChunkCache::SetCacheTimeout(double TimeoutSeconds)
@@ -37,80 +129,198 @@ void UChunkCache::EnableCache(bool bEnable)
     }
 }
 
+void UChunkCache::SetReplacementPolicy(EPlanetCachePolicy Policy)
+{
+    ReplacementPolicy = Policy;
+    Cache.SetPolicy(Policy);
+}
+
+void UChunkCache::SetMaxColdCacheBytes(int64 NewMaxBytes)
+{
+    MaxColdCacheBytes = FMath::Max<int64>(0, NewMaxBytes);
+    ColdCache.SetMaxBytes(MaxColdCacheBytes);
+}
+
+void UChunkCache::EnableColdCache(bool bEnable)
+{
+    bEnableColdCache = bEnable;
+    
+    if (!bEnableColdCache)
+    {
+        ColdCache.Clear();
+    }
+}
+
+void UChunkCache::SetMaxDiskCacheBytes(int64 NewMaxBytes)
+{
+    MaxDiskCacheBytes = FMath::Max<int64>(0, NewMaxBytes);
+    if (DiskCache)
+    {
+        DiskCache->SetMaxBytes(MaxDiskCacheBytes);
+    }
+}
+
+void UChunkCache::EnableDiskCache(bool bEnable)
+{
+    bEnableDiskCache = bEnable;
+    
+    if (bEnableDiskCache && !DiskCache)
+    {
+        CreateDiskCache();
+    }
+    else if (!bEnableDiskCache)
+    {
+        DestroyDiskCache();
+    }
+}
+
 bool UChunkCache::GetChunk(const FChunkKey& Key, FChunkData& OutChunkData)
+{
+    if (FChunkDataPtr Found = FindChunkData(Key))
+    {
+        OutChunkData = *Found;
+        return true;
+    }
+    return false;
+}
+
+void UChunkCache::StoreChunk(const FChunkKey& Key, const FChunkData& ChunkData)
+{
+    if (!bEnableCache || !ChunkData.IsValid())
+    {
+        return;
+    }
+    
+    LLM_SCOPE_BYTAG(PlanetRenderChunkCache);
+    StoreChunkData(Key, MakeShared<const FChunkData, ESPMode::ThreadSafe>(ChunkData));
+}
+
+FChunkDataPtr UChunkCache::FindChunkData(const FChunkKey& Key)
 {
     if (!bEnableCache)
     {
-        CacheMisses++;
-        return false;
+        return nullptr;
     }
     
-    if (FChunkData* FoundChunk = CachedChunks.Find(Key))
+    if (const TSharedPtr<FPlanetCacheTrace, ESPMode::ThreadSafe> ActiveTrace = GetActiveTrace())
     {
-        // Check if chunk has expired
-        double CurrentTime = GetCurrentTime();
-        if (CurrentTime - FoundChunk->LastAccessTime > CacheTimeoutSeconds)
+        ActiveTrace->RecordLookup(Key.GetHash64());
+    }
+    
+    // No age check here: a chunk being asked for is not idle, and expiring it would only compress it into the
+    // cold tier and promote it straight back. Idle chunks leave through CleanupExpiredChunks and the eviction handler.
+    if (FChunkDataPtr Found = Cache.Find(Key))
+    {
+        return Found;
+    }
+    
+    // Cold tier: rebuild the grid from the compressed heights and move the chunk back to the hot tier
+    if (FCompressedChunkPtr Compressed = ColdCache.Find(Key))
+    {
+        ColdCache.Remove(Key);
+        if (FChunkDataPtr Promoted = Compressed->Decompress())
         {
-            CachedChunks.Remove(Key);
-            CacheMisses++;
-            return false;
+            Cache.Store(Key, Promoted.ToSharedRef(), Promoted->GetAllocatedSize(), 1.0f, Promoted->GenerationSeconds);
+            return Promoted;
         }
-        
-        OutChunkData = *FoundChunk;
-        OutChunkData.UpdateAccessTime();
-        CachedChunks[Key] = OutChunkData; // Update access time in cache
-        CacheHits++;
+    }
+    
+    // Promote from disk before the caller regenerates
+    FChunkDataPtr Spilled = DiskCache ? DiskCache->Load(Key) : nullptr;
+    if (Spilled.IsValid())
+    {
+        Cache.Store(Key, Spilled.ToSharedRef(), Spilled->GetAllocatedSize(), 1.0f, Spilled->GenerationSeconds);
+    }
+    return Spilled;
+}
+
+bool UChunkCache::PromoteChunk(const FChunkKey& Key, float Priority)
+{
+    if (!bEnableCache)
+    {
+        return false;
+    }
+    
+    if (Cache.Contains(Key))
+    {
         return true;
     }
     
-    CacheMisses++;
-    return false;
+    FChunkDataPtr Promoted;
+    if (FCompressedChunkPtr Compressed = ColdCache.Peek(Key))
+    {
+        ColdCache.Remove(Key);
+        Promoted = Compressed->Decompress();
+    }
+    if (!Promoted.IsValid() && DiskCache)
+    {
+        Promoted = DiskCache->Load(Key, false);
+    }
+    if (!Promoted.IsValid())
+    {
+        return false;
+    }
+    
+    LLM_SCOPE_BYTAG(PlanetRenderChunkCache);
+    Cache.Store(Key, Promoted.ToSharedRef(), Promoted->GetAllocatedSize(), Priority, Promoted->GenerationSeconds);
+    return true;
 }
 
-void UChunkCache::StoreChunk(const FChunkKey& Key, const FChunkData& ChunkData)
+void UChunkCache::StoreChunkData(const FChunkKey& Key, const FChunkDataRef& ChunkData, float Priority)
 {
-    if (!bEnableCache || !ChunkData.IsValid())
+    if (!bEnableCache || !ChunkData->IsValid())
     {
         return;
     }
     
-    // Check if we need to evict chunks before storing
-    if (CachedChunks.Num() >= MaxCacheSize)
+    const int64 Bytes = ChunkData->GetAllocatedSize();
+    if (const TSharedPtr<FPlanetCacheTrace, ESPMode::ThreadSafe> ActiveTrace = GetActiveTrace())
     {
-        EvictOldestChunks(1);
+        ActiveTrace->RecordStore(Key.GetHash64(), Bytes, ChunkData->GenerationSeconds);
     }
     
-    FChunkData NewChunkData = ChunkData;
-    NewChunkData.UpdateAccessTime();
-    CachedChunks.Add(Key, NewChunkData);
+    // Generation time is the cost of losing the entry (GDSF)
+    LLM_SCOPE_BYTAG(PlanetRenderChunkCache);
+    Cache.Store(Key, ChunkData, Bytes, Priority, ChunkData->GenerationSeconds);
 }
 
 void UChunkCache::RemoveChunk(const FChunkKey& Key)
 {
-    CachedChunks.Remove(Key);
+    Cache.Remove(Key);
+    ColdCache.Remove(Key);
+    if (DiskCache)
+    {
+        DiskCache->Remove(Key);
+    }
 }
 
 void UChunkCache::ClearCache()
 {
-    CachedChunks.Empty();
-    CacheHits = 0;
-    CacheMisses = 0;
+    Cache.Clear();
+    Cache.ResetStats();
+    ColdCache.Clear();
+    ColdCache.ResetStats();
+    if (DiskCache)
+    {
+        DiskCache->Clear();
+    }
 }
 
 int32 UChunkCache::GetCacheSize() const
 {
-    return CachedChunks.Num();
+    return Cache.Num();
 }
 
 float UChunkCache::GetCacheHitRate() const
 {
-    int32 TotalRequests = CacheHits + CacheMisses;
+    const auto Stats = Cache.GetStats();
+    const int64 TotalRequests = Stats.Hits + Stats.Misses;
     if (TotalRequests == 0)
     {
         return 0.0f;
     }
     
-    return static_cast<float>(CacheHits) / static_cast<float>(TotalRequests);
+    return static_cast<float>(double(Stats.Hits) / double(TotalRequests));
 }
 
 void UChunkCache::GetCacheStats(int32& OutSize, int32& OutMaxSize, float& OutHitRate)
@@ -120,32 +330,43 @@ void UChunkCache::GetCacheStats(int32& OutSize, int32& OutMaxSize, float& OutHit
     OutHitRate = GetCacheHitRate();
 }
 
-void UChunkCache::CleanupExpiredChunks()
+void UChunkCache::GetColdCacheStats(int32& OutEntries, int64& OutBytes, float& OutHitRate) const
 {
-    if (!bEnableCache)
-    {
-        return;
-    }
-    
-    double CurrentTime = GetCurrentTime();
-    TArray<FChunkKey> KeysToRemove;
+    const auto Stats = ColdCache.GetStats();
+    const int64 TotalRequests = Stats.Hits + Stats.Misses;
+    OutEntries = Stats.Entries;
+    OutBytes = Stats.Bytes;
+    OutHitRate = TotalRequests > 0 ? static_cast<float>(double(Stats.Hits) / double(TotalRequests)) : 0.0f;
+}
+
+void UChunkCache::GetDiskCacheStats(int32& OutEntries, int64& OutBytes, float& OutHitRate) const
+{
+    OutEntries = 0;
+    OutBytes = 0;
+    OutHitRate = 0.0f;
     
-    for (const auto& Pair : CachedChunks)
+    if (DiskCache)
     {
-        if (CurrentTime - Pair.Value.LastAccessTime > CacheTimeoutSeconds)
-        {
-            KeysToRemove.Add(Pair.Key);
-        }
+        const FChunkDiskCache::FStats Stats = DiskCache->GetStats();
+        const int64 TotalRequests = Stats.Hits + Stats.Misses;
+        OutEntries = Stats.Entries;
+        OutBytes = Stats.Bytes;
+        OutHitRate = TotalRequests > 0 ? static_cast<float>(double(Stats.Hits) / double(TotalRequests)) : 0.0f;
     }
-    
-    for (const FChunkKey& Key : KeysToRemove)
+}
+
+void UChunkCache::CleanupExpiredChunks()
+{
+    if (!bEnableCache)
     {
-        CachedChunks.Remove(Key);
+        return;
     }
     
-    if (KeysToRemove.Num() > 0)
+    // Expired chunks go to the colder tiers through the eviction handler
+    const int32 RemovedCount = Cache.RemoveExpired(CacheTimeoutSeconds);
+    if (RemovedCount > 0)
     {
-        UE_LOG(LogTemp, Log, TEXT("ChunkCache: Cleaned up %d expired chunks"), KeysToRemove.Num());
+        UE_LOG(LogTemp, Log, TEXT("ChunkCache: Cleaned up %d expired chunks"), RemovedCount);
     }
 }
 
@@ -156,68 +377,143 @@ void UChunkCache::OptimizeCache()
         return;
     }
     
-    // Sort chunks by access time (oldest first)
-    TArray<TPair<FChunkKey, double>> ChunksWithTime;
-    
-    for (const auto& Pair : CachedChunks)
+    // Trim to 80% of capacity (entries and bytes), oldest first
+    const int32 RemoveCount = Cache.TrimToFraction(0.8f);
+    if (RemoveCount > 0)
     {
-        ChunksWithTime.Add(TPair<FChunkKey, double>(Pair.Key, Pair.Value.LastAccessTime));
+        UE_LOG(LogTemp, Log, TEXT("ChunkCache: Optimized cache, removed %d old chunks"), RemoveCount);
     }
-    
-    ChunksWithTime.Sort([](const TPair<FChunkKey, double>& A, const TPair<FChunkKey, double>& B)
+}
+
+void UChunkCache::StartTraceRecording()
+{
+    check(IsInGameThread());
+    FScopeLock Lock(&TraceLock);
+    Trace = MakeShared<FPlanetCacheTrace, ESPMode::ThreadSafe>();
+    bTraceActive = true;
+}
+
+bool UChunkCache::StopTraceRecording(const FString& FilePath)
+{
+    check(IsInGameThread());
+    TSharedPtr<FPlanetCacheTrace, ESPMode::ThreadSafe> Recorded;
     {
-        return A.Value < B.Value;
-    });
+        FScopeLock Lock(&TraceLock);
+        bTraceActive = false;
+        Recorded = MoveTemp(Trace);
+    }
     
-    // Remove oldest 10% of chunks if we're over 80% capacity
-    int32 CurrentSize = CachedChunks.Num();
-    int32 TargetSize = static_cast<int32>(MaxCacheSize * 0.8f);
+    // Workers still holding a reference may add a few events while this saves; the trace locks itself
+    if (!Recorded || Recorded->Num() == 0)
+    {
+        return false;
+    }
     
-    if (CurrentSize > TargetSize)
+    const bool bSaved = Recorded->Save(FilePath);
+    UE_LOG(LogTemp, Log, TEXT("ChunkCache: Trace with %d events %s %s"), Recorded->Num(), bSaved ? TEXT("saved to") : TEXT("could not be saved to"), *FilePath);
+    return bSaved;
+}
+
+TSharedPtr<FPlanetCacheTrace, ESPMode::ThreadSafe> UChunkCache::GetActiveTrace() const
+{
+    // Not recording (the common case): one relaxed load, no lock
+    if (!bTraceActive.load(std::memory_order_relaxed))
     {
-        int32 ChunksToRemove = CurrentSize - TargetSize;
-        int32 RemoveCount = FMath::Min(ChunksToRemove, ChunksWithTime.Num());
-        
-        for (int32 i = 0; i < RemoveCount; ++i)
-        {
-            CachedChunks.Remove(ChunksWithTime[i].Key);
-        }
-        
-        UE_LOG(LogTemp, Log, TEXT("ChunkCache: Optimized cache, removed %d old chunks"), RemoveCount);
+        return nullptr;
     }
+    
+    FScopeLock Lock(&TraceLock);
+    return Trace;
 }
 
-void UChunkCache::EvictOldestChunks(int32 Count)
+FString UChunkCache::BenchmarkTrace(const FString& FilePath, int64 MaxBytes)
 {
-    if (Count <= 0 || CachedChunks.Num() == 0)
+    FPlanetCacheTrace Recorded;
+    if (!Recorded.Load(FilePath))
     {
-        return;
+        return FString::Printf(TEXT("Could not load cache trace %s"), *FilePath);
     }
     
-    // Find oldest chunks
-    TArray<TPair<FChunkKey, double>> ChunksWithTime;
+    const FString Report = Recorded.Compare(MaxBytes);
+    UE_LOG(LogTemp, Log, TEXT("ChunkCache: %s"), *Report);
+    return Report;
+}
+
+void UChunkCache::HandleMemoryTrim(float KeepFraction)
+{
+    // Trimming must not allocate or keep anything alive: trimmed chunks are dropped instead of being compressed
+    // into the cold tier or queued for disk, and are regenerated if needed again. Evictions show up in the tier stats.
+    Cache.TrimUsage(KeepFraction);
+    ColdCache.TrimUsage(KeepFraction);
+}
+
+void UChunkCache::CreateDiskCache()
+{
+    const FString Root = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("PlanetChunkCache"));
     
-    for (const auto& Pair : CachedChunks)
+    // The disk index only lives in memory, so directories of processes that exited (or crashed) are
+    // unreachable and sit outside every disk budget: clear them once per process
+    static bool bStaleCachesCleared = false;
+    if (!bStaleCachesCleared)
     {
-        ChunksWithTime.Add(TPair<FChunkKey, double>(Pair.Key, Pair.Value.LastAccessTime));
+        DeleteStaleDiskCaches(Root);
+        bStaleCachesCleared = true;
     }
     
-    ChunksWithTime.Sort([](const TPair<FChunkKey, double>& A, const TPair<FChunkKey, double>& B)
+    // Lowest free slot in this process: live caches never share files, and the set of directories stays
+    // bounded by the number of caches alive at once instead of growing every session
+    DiskCacheSlot = 0;
+    while (ActiveDiskCacheSlots.Contains(DiskCacheSlot))
     {
-        return A.Value < B.Value;
-    });
+        DiskCacheSlot++;
+    }
+    ActiveDiskCacheSlots.Add(DiskCacheSlot);
     
-    int32 RemoveCount = FMath::Min(Count, ChunksWithTime.Num());
+    const FString Name = GetDiskCacheName(FPlatformProcess::GetCurrentProcessId(), DiskCacheSlot);
+    DiskCacheLockPath = FPaths::Combine(Root, Name + TEXT(".lock"));
+    DiskCacheLock.Reset(IFileManager::Get().CreateFileWriter(*DiskCacheLockPath));
     
-    for (int32 i = 0; i < RemoveCount; ++i)
+    DiskCache = MakeUnique<FChunkDiskCache>(FPaths::Combine(Root, Name), MaxDiskCacheBytes);
+}
+
+void UChunkCache::DestroyDiskCache()
+{
+    // The disk cache deletes its directory before the slot can be reused
+    DiskCache.Reset();
+    if (DiskCacheLock)
+    {
+        DiskCacheLock.Reset();
+        IFileManager::Get().Delete(*DiskCacheLockPath, false, false, true);
+    }
+    if (DiskCacheSlot != INDEX_NONE)
+    {
+        ActiveDiskCacheSlots.Remove(DiskCacheSlot);
+        DiskCacheSlot = INDEX_NONE;
+    }
+}
+
+void UChunkCache::HandleHotEviction(const FChunkKey& Key, const FChunkDataRef& Data)
+{
+    if (bEnableColdCache)
     {
-        CachedChunks.Remove(ChunksWithTime[i].Key);
+        if (FCompressedChunkPtr Compressed = FCompressedChunk::Compress(*Data))
+        {
+            ColdCache.Store(Key, Compressed.ToSharedRef(), Compressed->GetAllocatedSize(), 1.0f, Data->GenerationSeconds);
+            return;
+        }
     }
     
-    UE_LOG(LogTemp, Log, TEXT("ChunkCache: Evicted %d oldest chunks"), RemoveCount);
+    if (DiskCache)
+    {
+        DiskCache->Spill(Key, Data);
+    }
 }
 
-double UChunkCache::GetCurrentTime() const
+void UChunkCache::HandleColdEviction(const FChunkKey& Key, const FCompressedChunkRef& Compressed)
 {
-    return FPlatformTime::Seconds();
-} 
\ No newline at end of file
+    // Written as is; a chunk already spilled earlier is skipped by the disk tier
+    if (DiskCache)
+    {
+        DiskCache->Spill(Key, Compressed);
+    }
+}
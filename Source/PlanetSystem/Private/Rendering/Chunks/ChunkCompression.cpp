@@ -0,0 +1,264 @@
+#include "Rendering/Chunks/ChunkCompression.h"
+#include "Rendering/Chunks/ChunkCache.h"
+#include "Core/Cache/PlanetCacheMemory.h"
+#include "Misc/Compression.h"
+
+namespace
+{
+    constexpr float MaxQuantized = 65535.0f;
+
+    /** Cube-sphere direction of grid vertex (X, Y), with the same arithmetic as patch generation */
+    FVector GridDirection(const FVector2D& UVMin, const FVector2D& UVMax, int32 Res, int32 X, int32 Y)
+    {
+        const float u = FMath::Lerp(UVMin.X, UVMax.X, float(X) / Res);
+        const float v = FMath::Lerp(UVMin.Y, UVMax.Y, float(Y) / Res);
+        FVector Dir((u - 0.5f) * 2.f, (v - 0.5f) * 2.f, 1.f);
+        Dir.Normalize();
+        return Dir;
+    }
+
+    void BuildGridIndices(int32 Res, TArray<int32>& OutIndices)
+    {
+        OutIndices.Reset(Res * Res * 6);
+        for (int32 y = 0; y < Res; ++y)
+        {
+            for (int32 x = 0; x < Res; ++x)
+            {
+                const int32 i0 = y * (Res + 1) + x, i1 = i0 + 1, i2 = i0 + Res + 1, i3 = i2 + 1;
+                OutIndices.Append({ i0, i2, i1, i1, i2, i3 });
+            }
+        }
+    }
+
+    bool IsByte(double Value)
+    {
+        return Value >= 0.0 && Value <= 255.0 && Value == FMath::RoundToDouble(Value);
+    }
+}
+
+FCompressedChunkPtr FCompressedChunk::Compress(const FChunkData& Data)
+{
+    const int32 NumVertices = Data.Vertices.Num();
+    const int32 Res = FMath::RoundToInt(FMath::Sqrt(float(NumVertices))) - 1;
+    if (!Data.IsValid() || Res < 1 || FMath::Square(Res + 1) != NumVertices || Data.Normals.Num() > 0 || Data.UVs.Num() > 0)
+    {
+        return nullptr;
+    }
+
+    const auto IsOptionalStream = [NumVertices](int32 Num) { return Num == 0 || Num == NumVertices; };
+    if (!IsOptionalStream(Data.BiomeMap.Num()) || !IsOptionalStream(Data.BiomeWeights.Num()) || !IsOptionalStream(Data.BiomeIndices.Num()))
+    {
+        return nullptr;
+    }
+
+    // Triangles must be the generated grid, since they are rebuilt rather than stored
+    TArray<int32> GridIndices;
+    BuildGridIndices(Res, GridIndices);
+    if (GridIndices != Data.Indices)
+    {
+        return nullptr;
+    }
+
+    for (const FVector2D& Index : Data.BiomeIndices)
+    {
+        if (!IsByte(Index.X) || !IsByte(Index.Y))
+        {
+            return nullptr;
+        }
+    }
+
+    // Radii, and a check that every vertex lies on its grid direction (erosion only moves vertices radially)
+    TArray<float> Radii;
+    Radii.SetNumUninitialized(NumVertices);
+    float MinRadius = MAX_flt;
+    float MaxRadius = -MAX_flt;
+    for (int32 y = 0; y <= Res; ++y)
+    {
+        for (int32 x = 0; x <= Res; ++x)
+        {
+            const int32 i = y * (Res + 1) + x;
+            const FVector& Vertex = Data.Vertices[i];
+            const float Radius = Vertex.Size();
+            const FVector Dir = GridDirection(Data.UVMin, Data.UVMax, Res, x, y);
+            if (FVector::DistSquared(Vertex, Dir * Radius) > FMath::Square(Radius * 1e-4f))
+            {
+                return nullptr;
+            }
+            Radii[i] = Radius;
+            MinRadius = FMath::Min(MinRadius, Radius);
+            MaxRadius = FMath::Max(MaxRadius, Radius);
+        }
+    }
+
+    // Raw stream: row-delta coded 16-bit radii, then the biome streams present
+    const int32 NumBiomeBytes = (Data.BiomeMap.Num() > 0 ? NumVertices : 0)
+        + (Data.BiomeWeights.Num() > 0 ? NumVertices * 4 : 0)
+        + (Data.BiomeIndices.Num() > 0 ? NumVertices * 2 : 0);
+    TArray<uint8> Raw;
+    Raw.SetNumUninitialized(NumVertices * sizeof(uint16) + NumBiomeBytes);
+
+    uint16* Heights = reinterpret_cast<uint16*>(Raw.GetData());
+    const float Scale = MaxRadius > MinRadius ? MaxQuantized / (MaxRadius - MinRadius) : 0.0f;
+    for (int32 y = 0; y <= Res; ++y)
+    {
+        uint16 Previous = 0;
+        for (int32 x = 0; x <= Res; ++x)
+        {
+            const int32 i = y * (Res + 1) + x;
+            const uint16 Quantized = uint16(FMath::Clamp(FMath::RoundToInt((Radii[i] - MinRadius) * Scale), 0, 65535));
+            Heights[i] = uint16(Quantized - Previous);
+            Previous = Quantized;
+        }
+    }
+
+    uint8* Cursor = Raw.GetData() + NumVertices * sizeof(uint16);
+    uint8 Streams = 0;
+    if (Data.BiomeMap.Num() > 0)
+    {
+        Streams |= HasBiomeMap;
+        FMemory::Memcpy(Cursor, Data.BiomeMap.GetData(), NumVertices);
+        Cursor += NumVertices;
+    }
+    if (Data.BiomeWeights.Num() > 0)
+    {
+        Streams |= HasBiomeWeights;
+        for (const FColor& Weight : Data.BiomeWeights)
+        {
+            *Cursor++ = Weight.R;
+            *Cursor++ = Weight.G;
+            *Cursor++ = Weight.B;
+            *Cursor++ = Weight.A;
+        }
+    }
+    if (Data.BiomeIndices.Num() > 0)
+    {
+        Streams |= HasBiomeIndices;
+        for (const FVector2D& Index : Data.BiomeIndices)
+        {
+            *Cursor++ = uint8(Index.X);
+            *Cursor++ = uint8(Index.Y);
+        }
+    }
+
+    int32 CompressedSize = FCompression::CompressMemoryBound(NAME_LZ4, Raw.Num());
+    TArray<uint8> Payload;
+    Payload.SetNumUninitialized(CompressedSize);
+    if (!FCompression::CompressMemory(NAME_LZ4, Payload.GetData(), CompressedSize, Raw.GetData(), Raw.Num()))
+    {
+        return nullptr;
+    }
+    Payload.SetNum(CompressedSize, false);
+    Payload.Shrink();
+
+    LLM_SCOPE_BYTAG(PlanetRenderChunkCache);
+    TSharedRef<FCompressedChunk, ESPMode::ThreadSafe> Compressed = MakeShared<FCompressedChunk, ESPMode::ThreadSafe>();
+    Compressed->Payload = MoveTemp(Payload);
+    Compressed->RawSize = Raw.Num();
+    Compressed->Resolution = Res;
+    Compressed->Streams = Streams;
+    Compressed->MinRadius = MinRadius;
+    Compressed->MaxRadius = MaxRadius;
+    Compressed->MinAltitude = Data.MinAltitude;
+    Compressed->MaxAltitude = Data.MaxAltitude;
+    Compressed->Bounds = Data.Bounds;
+    Compressed->BoundingSphere = Data.BoundingSphere;
+    Compressed->Seed = Data.Seed;
+    Compressed->LODLevel = Data.LODLevel;
+    Compressed->UVMin = Data.UVMin;
+    Compressed->UVMax = Data.UVMax;
+    Compressed->GenerationSeconds = Data.GenerationSeconds;
+    return Compressed;
+}
+
+FChunkDataPtr FCompressedChunk::Decompress() const
+{
+    TArray<uint8> Raw;
+    Raw.SetNumUninitialized(RawSize);
+    if (!FCompression::UncompressMemory(NAME_LZ4, Raw.GetData(), RawSize, Payload.GetData(), Payload.Num()))
+    {
+        return nullptr;
+    }
+
+    const int32 Res = Resolution;
+    const int32 NumVertices = FMath::Square(Res + 1);
+
+    // Promoted payloads live in the hot tier
+    LLM_SCOPE_BYTAG(PlanetRenderChunkCache);
+    TSharedRef<FChunkData, ESPMode::ThreadSafe> Data = MakeShared<FChunkData, ESPMode::ThreadSafe>();
+
+    const uint16* Heights = reinterpret_cast<const uint16*>(Raw.GetData());
+    const float Step = (MaxRadius - MinRadius) / MaxQuantized;
+    Data->Vertices.SetNumUninitialized(NumVertices);
+    for (int32 y = 0; y <= Res; ++y)
+    {
+        uint16 Quantized = 0;
+        for (int32 x = 0; x <= Res; ++x)
+        {
+            const int32 i = y * (Res + 1) + x;
+            Quantized = uint16(Quantized + Heights[i]);
+            Data->Vertices[i] = GridDirection(UVMin, UVMax, Res, x, y) * (MinRadius + Quantized * Step);
+        }
+    }
+    BuildGridIndices(Res, Data->Indices);
+
+    const uint8* Cursor = Raw.GetData() + NumVertices * sizeof(uint16);
+    if (Streams & HasBiomeMap)
+    {
+        Data->BiomeMap.SetNumUninitialized(NumVertices);
+        FMemory::Memcpy(Data->BiomeMap.GetData(), Cursor, NumVertices);
+        Cursor += NumVertices;
+    }
+    if (Streams & HasBiomeWeights)
+    {
+        Data->BiomeWeights.SetNumUninitialized(NumVertices);
+        for (FColor& Weight : Data->BiomeWeights)
+        {
+            Weight.R = *Cursor++;
+            Weight.G = *Cursor++;
+            Weight.B = *Cursor++;
+            Weight.A = *Cursor++;
+        }
+    }
+    if (Streams & HasBiomeIndices)
+    {
+        Data->BiomeIndices.SetNumUninitialized(NumVertices);
+        for (FVector2D& Index : Data->BiomeIndices)
+        {
+            Index.X = Cursor[0];
+            Index.Y = Cursor[1];
+            Cursor += 2;
+        }
+    }
+    check(Cursor == Raw.GetData() + RawSize);
+
+    Data->MinAltitude = MinAltitude;
+    Data->MaxAltitude = MaxAltitude;
+    Data->Bounds = Bounds;
+    Data->BoundingSphere = BoundingSphere;
+    Data->Seed = Seed;
+    Data->LODLevel = LODLevel;
+    Data->UVMin = UVMin;
+    Data->UVMax = UVMax;
+    Data->GenerationSeconds = GenerationSeconds;
+    Data->UpdateAccessTime();
+    return Data;
+}
+
+void FCompressedChunk::Serialize(FArchive& Ar)
+{
+    Ar << Payload;
+    Ar << RawSize;
+    Ar << Resolution;
+    Ar << Streams;
+    Ar << MinRadius;
+    Ar << MaxRadius;
+    Ar << MinAltitude;
+    Ar << MaxAltitude;
+    Ar << Bounds;
+    Ar << BoundingSphere;
+    Ar << Seed;
+    Ar << LODLevel;
+    Ar << UVMin;
+    Ar << UVMax;
+    Ar << GenerationSeconds;
+}
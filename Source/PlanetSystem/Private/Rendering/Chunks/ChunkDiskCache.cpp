@@ -0,0 +1,426 @@
+#include "Rendering/Chunks/ChunkDiskCache.h"
+#include "Core/Cache/PlanetCacheMemory.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+    constexpr uint32 ChunkFileMagic = 0x43444350; // "PCDC"
+    constexpr uint32 ChunkFileVersion = 3;
+    constexpr int32 ChunkFileHeaderSize = 4 * sizeof(uint32);
+
+    /** Body of a chunk file: LZ4 of the serialized payload, or a serialized FCompressedChunk */
+    enum class EChunkFileKind : uint32
+    {
+        Payload = 0,
+        Compressed = 1,
+    };
+
+    /** Render payload fields in file order; metadata is enough to rebuild the patch state */
+    void SerializeChunk(FArchive& Ar, FChunkData& Data)
+    {
+        Ar << Data.Vertices;
+        Ar << Data.Indices;
+        Ar << Data.Normals;
+        Ar << Data.UVs;
+        Ar << Data.BiomeMap;
+        Ar << Data.BiomeWeights;
+        Ar << Data.BiomeIndices;
+        Ar << Data.MinAltitude;
+        Ar << Data.MaxAltitude;
+        Ar << Data.Bounds;
+        Ar << Data.BoundingSphere;
+        Ar << Data.Seed;
+        Ar << Data.LODLevel;
+        Ar << Data.UVMin;
+        Ar << Data.UVMax;
+        Ar << Data.GenerationSeconds;
+    }
+}
+
+FChunkDiskCache::FChunkDiskCache(const FString& InDirectory, int64 InMaxBytes)
+    : Directory(InDirectory)
+    , Index(4)
+{
+    Index.SetMaxEntries(MAX_int32);
+    Index.SetMaxBytes(InMaxBytes);
+    Index.SetPolicy(EPlanetCachePolicy::LRU);
+    Index.SetEvictionHandler([](const FChunkKey&, const TSharedRef<const FDiskRecord, ESPMode::ThreadSafe>& Record)
+    {
+        IFileManager::Get().Delete(*Record->Path, false, false, true);
+    });
+
+    // The index is not persisted, so files left by an earlier session are unreachable
+    IFileManager::Get().DeleteDirectory(*Directory, false, true);
+}
+
+FChunkDiskCache::~FChunkDiskCache()
+{
+    {
+        FScopeLock Lock(&PendingMutex);
+        Pending.Empty();
+        PendingOrder.Empty();
+        PendingBytes = 0;
+    }
+    Flush();
+
+    Index.SetEvictionHandler(nullptr);
+    Index.Clear();
+    IFileManager::Get().DeleteDirectory(*Directory, false, true);
+}
+
+void FChunkDiskCache::SetMaxBytes(int64 InMaxBytes)
+{
+    Index.SetMaxBytes(InMaxBytes);
+}
+
+void FChunkDiskCache::Spill(const FChunkKey& Key, const FChunkDataRef& Data)
+{
+    if (Data->IsValid())
+    {
+        Enqueue(Key, FPendingChunk{ Data, nullptr });
+    }
+}
+
+void FChunkDiskCache::Spill(const FChunkKey& Key, const FCompressedChunkRef& Compressed)
+{
+    Enqueue(Key, FPendingChunk{ nullptr, Compressed });
+}
+
+void FChunkDiskCache::Enqueue(const FChunkKey& Key, FPendingChunk&& Chunk)
+{
+    // A key fully determines its payload, so a chunk promoted earlier is still current on disk
+    if (Index.Contains(Key))
+    {
+        return;
+    }
+
+    const int64 Bytes = Chunk.GetAllocatedSize();
+
+    FScopeLock Lock(&PendingMutex);
+    if (FPendingChunk* Existing = Pending.Find(Key))
+    {
+        // Still queued: the writer picks up the newest payload
+        PendingBytes += Bytes - Existing->GetAllocatedSize();
+        *Existing = MoveTemp(Chunk);
+        return;
+    }
+
+    if (PendingBytes + Bytes > MaxPendingBytes)
+    {
+        // The writer is behind; dropping only costs a regeneration later
+        Dropped++;
+        return;
+    }
+
+    Pending.Add(Key, MoveTemp(Chunk));
+    PendingOrder.Add(Key);
+    PendingBytes += Bytes;
+    StartWriter();
+}
+
+FChunkDataPtr FChunkDiskCache::Load(const FChunkKey& Key, bool bCountAccess)
+{
+    FCompressedChunkPtr QueuedCompressed;
+    {
+        FScopeLock Lock(&PendingMutex);
+        if (const FPendingChunk* Queued = Pending.Find(Key))
+        {
+            if (Queued->Data.IsValid())
+            {
+                Hits += bCountAccess ? 1 : 0;
+                return Queued->Data;
+            }
+            QueuedCompressed = Queued->Compressed;
+        }
+    }
+    
+    // Decompressed outside the lock so the writer is not held up
+    if (QueuedCompressed.IsValid())
+    {
+        if (FChunkDataPtr Data = QueuedCompressed->Decompress())
+        {
+            Hits += bCountAccess ? 1 : 0;
+            return Data;
+        }
+    }
+
+    const TSharedPtr<const FDiskRecord, ESPMode::ThreadSafe> Record = Index.Find(Key);
+    FChunkDataPtr Data = Record.IsValid() ? ReadChunk(Record->Path) : nullptr;
+    if (!Data.IsValid())
+    {
+        if (Record.IsValid())
+        {
+            // Unreadable file: forget it so the chunk is regenerated and spilled again
+            Index.Remove(Key);
+            IFileManager::Get().Delete(*Record->Path, false, false, true);
+        }
+        Misses += bCountAccess ? 1 : 0;
+        return nullptr;
+    }
+
+    Hits += bCountAccess ? 1 : 0;
+    return Data;
+}
+
+void FChunkDiskCache::Remove(const FChunkKey& Key)
+{
+    {
+        FScopeLock Lock(&PendingMutex);
+        if (const FPendingChunk* Queued = Pending.Find(Key))
+        {
+            PendingBytes -= Queued->GetAllocatedSize();
+            Pending.Remove(Key);
+        }
+
+        // Being written right now: the writer drops the file once it is done
+        if (WritingKey.IsSet() && WritingKey.GetValue() == Key)
+        {
+            bWritingKeyRemoved = true;
+        }
+    }
+
+    if (const TSharedPtr<const FDiskRecord, ESPMode::ThreadSafe> Record = Index.Peek(Key))
+    {
+        Index.Remove(Key);
+        IFileManager::Get().Delete(*Record->Path, false, false, true);
+    }
+}
+
+void FChunkDiskCache::Clear()
+{
+    {
+        FScopeLock Lock(&PendingMutex);
+        Pending.Empty();
+        PendingOrder.Empty();
+        PendingBytes = 0;
+    }
+    Flush();
+
+    Index.Clear();
+    IFileManager::Get().DeleteDirectory(*Directory, false, true);
+}
+
+void FChunkDiskCache::Flush()
+{
+    for (;;)
+    {
+        TFuture<void> Task;
+        {
+            FScopeLock Lock(&PendingMutex);
+            if (!bWriterActive)
+            {
+                return;
+            }
+            Task = MoveTemp(Writer);
+        }
+
+        if (Task.IsValid())
+        {
+            Task.Wait();
+        }
+        else
+        {
+            // Another caller is already waiting on the writer
+            FPlatformProcess::Sleep(0.0f);
+        }
+    }
+}
+
+FChunkDiskCache::FStats FChunkDiskCache::GetStats() const
+{
+    const auto IndexStats = Index.GetStats();
+
+    FStats Stats;
+    Stats.Entries = IndexStats.Entries;
+    Stats.Bytes = IndexStats.Bytes;
+    Stats.Hits = Hits;
+    Stats.Misses = Misses;
+    Stats.Writes = Writes;
+    Stats.Dropped = Dropped;
+    return Stats;
+}
+
+void FChunkDiskCache::StartWriter()
+{
+    // Called with PendingMutex held
+    if (!bWriterActive)
+    {
+        bWriterActive = true;
+        Writer = Async(EAsyncExecution::ThreadPool, [this]() { WritePending(); });
+    }
+}
+
+void FChunkDiskCache::WritePending()
+{
+    for (;;)
+    {
+        FChunkKey Key;
+        TOptional<FPendingChunk> Chunk;
+        {
+            FScopeLock Lock(&PendingMutex);
+            while (!Chunk.IsSet() && PendingOrder.Num() > 0)
+            {
+                Key = PendingOrder.Pop(false);
+                if (const FPendingChunk* Queued = Pending.Find(Key))
+                {
+                    Chunk = *Queued;
+                }
+            }
+
+            if (!Chunk.IsSet())
+            {
+                bWriterActive = false;
+                return;
+            }
+            WritingKey = Key;
+            bWritingKeyRemoved = false;
+        }
+
+        int64 FileBytes = 0;
+        const bool bWritten = WriteChunk(Key, *Chunk, FileBytes);
+
+        // Indexed under the lock, so a Remove either sees the record or marks the key before this check
+        FScopeLock Lock(&PendingMutex);
+        if (bWritten && bWritingKeyRemoved)
+        {
+            IFileManager::Get().Delete(*GetChunkPath(Key), false, false, true);
+        }
+        else if (bWritten)
+        {
+            Index.Store(Key, MakeShared<const FDiskRecord, ESPMode::ThreadSafe>(FDiskRecord{ GetChunkPath(Key) }), FileBytes);
+            Writes++;
+        }
+        WritingKey.Reset();
+
+        const FPendingChunk* Queued = Pending.Find(Key);
+        if (Queued && *Queued == *Chunk)
+        {
+            PendingBytes -= Chunk->GetAllocatedSize();
+            Pending.Remove(Key);
+            if (!bWritten)
+            {
+                Dropped++;
+            }
+        }
+        else if (Queued)
+        {
+            // Replaced while writing: write the newer payload too
+            PendingOrder.Add(Key);
+        }
+    }
+}
+
+bool FChunkDiskCache::WriteChunk(const FChunkKey& Key, const FPendingChunk& Chunk, int64& OutFileBytes) const
+{
+    TArray<uint8> File;
+    File.SetNumUninitialized(ChunkFileHeaderSize);
+    EChunkFileKind Kind = EChunkFileKind::Payload;
+    int32 RawSize = 0;
+
+    if (Chunk.Compressed.IsValid())
+    {
+        // Already LZ4-compressed by the cold tier: stored as is
+        Kind = EChunkFileKind::Compressed;
+        FMemoryWriter BodyAr(File);
+        BodyAr.Seek(ChunkFileHeaderSize);
+        const_cast<FCompressedChunk&>(*Chunk.Compressed).Serialize(BodyAr);
+        RawSize = File.Num() - ChunkFileHeaderSize;
+    }
+    else
+    {
+        TArray<uint8> Raw;
+        FMemoryWriter RawAr(Raw);
+        SerializeChunk(RawAr, const_cast<FChunkData&>(*Chunk.Data));
+
+        int32 CompressedSize = FCompression::CompressMemoryBound(NAME_LZ4, Raw.Num());
+        File.SetNumUninitialized(ChunkFileHeaderSize + CompressedSize);
+        if (!FCompression::CompressMemory(NAME_LZ4, File.GetData() + ChunkFileHeaderSize, CompressedSize, Raw.GetData(), Raw.Num()))
+        {
+            return false;
+        }
+        File.SetNum(ChunkFileHeaderSize + CompressedSize, false);
+        RawSize = Raw.Num();
+    }
+
+    uint32 Magic = ChunkFileMagic;
+    uint32 Version = ChunkFileVersion;
+    uint32 KindValue = uint32(Kind);
+    TArray<uint8> Header;
+    FMemoryWriter HeaderAr(Header);
+    HeaderAr << Magic << Version << KindValue << RawSize;
+    FMemory::Memcpy(File.GetData(), Header.GetData(), ChunkFileHeaderSize);
+
+    // Write then rename, so readers never see a partial file
+    const FString Path = GetChunkPath(Key);
+    const FString TempPath = Path + TEXT(".tmp");
+    if (!FFileHelper::SaveArrayToFile(File, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+    {
+        IFileManager::Get().Delete(*TempPath, false, false, true);
+        return false;
+    }
+
+    OutFileBytes = File.Num();
+    return true;
+}
+
+FChunkDataPtr FChunkDiskCache::ReadChunk(const FString& Path) const
+{
+    TArray<uint8> File;
+    if (!FFileHelper::LoadFileToArray(File, *Path, FILEREAD_Silent) || File.Num() < ChunkFileHeaderSize)
+    {
+        return nullptr;
+    }
+
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    uint32 KindValue = 0;
+    int32 RawSize = 0;
+    FMemoryReader HeaderAr(File);
+    HeaderAr << Magic << Version << KindValue << RawSize;
+    if (Magic != ChunkFileMagic || Version != ChunkFileVersion || RawSize <= 0)
+    {
+        return nullptr;
+    }
+
+    if (EChunkFileKind(KindValue) == EChunkFileKind::Compressed)
+    {
+        FCompressedChunk Compressed;
+        FMemoryReader BodyAr(File);
+        BodyAr.Seek(ChunkFileHeaderSize);
+        Compressed.Serialize(BodyAr);
+        return BodyAr.IsError() ? nullptr : Compressed.Decompress();
+    }
+    if (EChunkFileKind(KindValue) != EChunkFileKind::Payload)
+    {
+        return nullptr;
+    }
+
+    TArray<uint8> Raw;
+    Raw.SetNumUninitialized(RawSize);
+    if (!FCompression::UncompressMemory(NAME_LZ4, Raw.GetData(), RawSize, File.GetData() + ChunkFileHeaderSize, File.Num() - ChunkFileHeaderSize))
+    {
+        return nullptr;
+    }
+
+    // Promoted payloads live in the memory tier
+    LLM_SCOPE_BYTAG(PlanetRenderChunkCache);
+    TSharedRef<FChunkData, ESPMode::ThreadSafe> Data = MakeShared<FChunkData, ESPMode::ThreadSafe>();
+    FMemoryReader RawAr(Raw);
+    SerializeChunk(RawAr, *Data);
+    if (RawAr.IsError() || !Data->IsValid())
+    {
+        return nullptr;
+    }
+    return Data;
+}
+
+FString FChunkDiskCache::GetChunkPath(const FChunkKey& Key) const
+{
+    return FPaths::Combine(Directory, FString::Printf(TEXT("%016llx_%08x.chunk"), Key.Pack(), Key.Seed));
+}
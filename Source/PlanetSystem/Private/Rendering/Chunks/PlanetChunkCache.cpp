@@ -2,6 +2,7 @@
 #include "Debug/Logging/PlanetSystemLogger.h"
 #include "Core/Events/PlanetEventBus.h"
 #include "Debug/Profiling/PlanetPerformanceProfiler.h"
+#include "Core/Cache/PlanetCacheMemory.h"
 #include "HAL/PlatformTime.h"
 #include "Misc/DateTime.h"
 
@@ -10,9 +11,30 @@ UPlanetChunkCache* UPlanetChunkCache::Instance = nullptr;
 
 UPlanetChunkCache::UPlanetChunkCache()
 {
+    // Limite apenas por bytes; política por prioridade (GreedyDual: prioridade + inflação, as de menor prioridade saem antes)
+    Cache.SetMaxEntries(MAX_int32);
+    Cache.SetMaxBytes(GetMaxCacheBytes());
+    Cache.SetPolicy(EPlanetCachePolicy::Priority);
+    
     UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), TEXT("Advanced chunk cache created"));
 }
 
+void UPlanetChunkCache::PostInitProperties()
+{
+    Super::PostInitProperties();
+    
+    if (!HasAnyFlags(RF_ClassDefaultObject))
+    {
+        MemoryTrimHandle = FPlanetCacheMemory::OnTrim().AddUObject(this, &UPlanetChunkCache::HandleMemoryTrim);
+    }
+}
+
+void UPlanetChunkCache::BeginDestroy()
+{
+    FPlanetCacheMemory::OnTrim().Remove(MemoryTrimHandle);
+    Super::BeginDestroy();
+}
+
 UPlanetChunkCache* UPlanetChunkCache::GetInstance()
 {
     if (!Instance)
@@ -24,13 +46,16 @@ UPlanetChunkCache* UPlanetChunkCache::GetInstance()
     return Instance;
 }
 
-bool UPlanetChunkCache::AddChunk(const FString& ChunkKey, const FPlanetChunk& Chunk, float Priority)
+bool UPlanetChunkCache::AddChunk(const FString& ChunkKey, const FPlanetChunk& Chunk, float Priority, float GenerationCost)
 {
     try
     {
         if (!bCacheEnabled)
         {
-            UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), TEXT("Cache is disabled, chunk not added"));
+            if (FPlanetCacheInstrumentation::IsVerbose())
+            {
+                UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), TEXT("Cache is disabled, chunk not added"));
+            }
             return false;
         }
         
@@ -40,57 +65,50 @@ bool UPlanetChunkCache::AddChunk(const FString& ChunkKey, const FPlanetChunk& Ch
             return false;
         }
         
-        UPlanetPerformanceProfiler::GetInstance()->BeginCacheOperation(TEXT("AddChunk"));
-        
-        // Verifica se o chunk já existe
-        if (CacheEntries.Contains(ChunkKey))
+        // Caminho quente: só contadores; log, eventos e profiler apenas nas operações rastreadas
+        const bool bTrace = FPlanetCacheInstrumentation::ShouldTrace() && IsInGameThread();
+        const uint64 StartCycles = bTrace ? FPlatformTime::Cycles64() : 0;
+        if (bTrace)
         {
-            UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), 
-                FString::Printf(TEXT("Chunk already exists in cache: %s"), *ChunkKey));
-            
-            // Atualiza o chunk existente
-            FCacheEntry& ExistingEntry = CacheEntries[ChunkKey];
-            ExistingEntry.Chunk = Chunk;
-            ExistingEntry.Priority = Priority;
-            ExistingEntry.LastAccessTime = FPlatformTime::Seconds();
-            ExistingEntry.AccessCount++;
-            
-            UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("AddChunk"));
-            return true;
+            UPlanetPerformanceProfiler::GetInstance()->BeginCacheOperation(TEXT("AddChunk"));
         }
         
-        // Calcula o tamanho estimado do chunk
-        int32 EstimatedSize = EstimateChunkSize(Chunk);
+        // Tamanho exato: estrutura + arrays alocados
+        const int64 ChunkSize = Chunk.GetAllocatedSize();
         
-        // Verifica se há espaço suficiente
-        if (CurrentCacheSizeBytes + EstimatedSize > MaxCacheSizeMB * 1024 * 1024)
+        // Um chunk maior que o cache inteiro não pode ser adicionado
+        if (ChunkSize > GetMaxCacheBytes())
         {
-            // Otimiza o cache para liberar espaço
-            if (!OptimizeCacheForNewChunk(EstimatedSize))
+            UPlanetSystemLogger::LogWarning(TEXT("PlanetChunkCache"), 
+                FString::Printf(TEXT("Cannot add chunk %s - insufficient cache space"), *ChunkKey));
+            
+            if (bTrace)
             {
-                UPlanetSystemLogger::LogWarning(TEXT("PlanetChunkCache"), 
-                    FString::Printf(TEXT("Cannot add chunk %s - insufficient cache space"), *ChunkKey));
-                
                 UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("AddChunk"));
-                return false;
             }
+            return false;
         }
         
-        // Adiciona o novo chunk
-        FCacheEntry NewEntry(Chunk, Priority);
-        NewEntry.SizeInBytes = EstimatedSize;
-        CacheEntries.Add(ChunkKey, NewEntry);
-        
-        CurrentCacheSizeBytes += EstimatedSize;
-        
-        UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Chunk added to cache: %s (Priority: %.2f, Size: %d bytes)"), 
-                *ChunkKey, Priority, EstimatedSize));
-        
-        UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
-            EPlanetEventType::ChunkCached, TEXT("ChunkCache"), ChunkKey, Priority, EstimatedSize);
+        // Substitui entradas existentes; o núcleo remove chunks de menor prioridade até caber
+        {
+            LLM_SCOPE_BYTAG(PlanetChunkCache);
+            Cache.Store(ChunkKey, MakeShared<const FPlanetChunk, ESPMode::ThreadSafe>(Chunk), ChunkSize, Priority, GenerationCost);
+        }
+        Instrumentation.Count(EPlanetCacheOp::Add, true);
         
-        UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("AddChunk"));
+        if (bTrace)
+        {
+            Instrumentation.AddSample(EPlanetCacheOp::Add, FPlatformTime::Cycles64() - StartCycles);
+            
+            UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), 
+                FString::Printf(TEXT("Chunk added to cache: %s (Priority: %.2f, Size: %lld bytes)"), 
+                    *ChunkKey, Priority, ChunkSize));
+            
+            UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
+                EPlanetEventType::ChunkCached, TEXT("ChunkCache"), ChunkKey, Priority, int32(FMath::Min<int64>(ChunkSize, MAX_int32)));
+            
+            UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("AddChunk"));
+        }
         return true;
     }
     catch (const std::exception& e)
@@ -101,13 +119,26 @@ bool UPlanetChunkCache::AddChunk(const FString& ChunkKey, const FPlanetChunk& Ch
     }
 }
 
-FPlanetChunk* UPlanetChunkCache::GetChunk(const FString& ChunkKey)
+bool UPlanetChunkCache::GetChunk(const FString& ChunkKey, FPlanetChunk& OutChunk)
+{
+    if (TSharedPtr<const FPlanetChunk, ESPMode::ThreadSafe> Found = FindChunk(ChunkKey))
+    {
+        OutChunk = *Found;
+        return true;
+    }
+    return false;
+}
+
+TSharedPtr<const FPlanetChunk, ESPMode::ThreadSafe> UPlanetChunkCache::FindChunk(const FString& ChunkKey)
 {
     try
     {
         if (!bCacheEnabled)
         {
-            UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), TEXT("Cache is disabled, chunk not found"));
+            if (FPlanetCacheInstrumentation::IsVerbose())
+            {
+                UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), TEXT("Cache is disabled, chunk not found"));
+            }
             return nullptr;
         }
         
@@ -117,38 +148,37 @@ FPlanetChunk* UPlanetChunkCache::GetChunk(const FString& ChunkKey)
             return nullptr;
         }
         
+        const bool bTrace = FPlanetCacheInstrumentation::ShouldTrace() && IsInGameThread();
+        if (!bTrace)
+        {
+            // Caminho quente: lookup no shard + dois incrementos atômicos
+            TSharedPtr<const FPlanetChunk, ESPMode::ThreadSafe> Found = Cache.Find(ChunkKey);
+            Instrumentation.Count(EPlanetCacheOp::Find, Found.IsValid());
+            return Found;
+        }
+        
         UPlanetPerformanceProfiler::GetInstance()->BeginCacheOperation(TEXT("GetChunk"));
+        const uint64 StartCycles = FPlatformTime::Cycles64();
+        
+        // O núcleo atualiza acesso e estatísticas
+        TSharedPtr<const FPlanetChunk, ESPMode::ThreadSafe> Found = Cache.Find(ChunkKey);
         
-        FCacheEntry* Entry = CacheEntries.Find(ChunkKey);
-        if (Entry)
+        Instrumentation.AddSample(EPlanetCacheOp::Find, FPlatformTime::Cycles64() - StartCycles);
+        Instrumentation.Count(EPlanetCacheOp::Find, Found.IsValid());
+        
+        if (Found)
         {
-            // Atualiza estatísticas de acesso
-            Entry->LastAccessTime = FPlatformTime::Seconds();
-            Entry->AccessCount++;
-            TotalHits++;
-            
-            UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), 
-                FString::Printf(TEXT("Cache hit: %s (Access count: %d)"), *ChunkKey, Entry->AccessCount));
-            
             UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
-                EPlanetEventType::ChunkCacheHit, TEXT("ChunkCache"), ChunkKey, 0.0f, Entry->AccessCount);
-            
-            UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("GetChunk"));
-            return &Entry->Chunk;
+                EPlanetEventType::ChunkCacheHit, TEXT("ChunkCache"), ChunkKey, 0.0f, GetChunkAccessCount(ChunkKey));
         }
         else
         {
-            TotalMisses++;
-            
-            UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), 
-                FString::Printf(TEXT("Cache miss: %s"), *ChunkKey));
-            
             UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
                 EPlanetEventType::ChunkCacheMiss, TEXT("ChunkCache"), ChunkKey);
-            
-            UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("GetChunk"));
-            return nullptr;
         }
+        
+        UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("GetChunk"));
+        return Found;
     }
     catch (const std::exception& e)
     {
@@ -168,32 +198,23 @@ bool UPlanetChunkCache::RemoveChunk(const FString& ChunkKey)
             return false;
         }
         
-        UPlanetPerformanceProfiler::GetInstance()->BeginCacheOperation(TEXT("RemoveChunk"));
-        
-        FCacheEntry* Entry = CacheEntries.Find(ChunkKey);
-        if (Entry)
-        {
-            int32 RemovedSize = Entry->SizeInBytes;
-            CacheEntries.Remove(ChunkKey);
-            CurrentCacheSizeBytes -= RemovedSize;
-            
-            UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
-                FString::Printf(TEXT("Chunk removed from cache: %s (Freed: %d bytes)"), *ChunkKey, RemovedSize));
-            
-            UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
-                EPlanetEventType::ChunkRemoved, TEXT("ChunkCache"), ChunkKey, 0.0f, RemovedSize);
-            
-            UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("RemoveChunk"));
-            return true;
-        }
-        else
+        const int64 RemovedSize = GetChunkSize(ChunkKey);
+        if (!Cache.Remove(ChunkKey))
         {
             UPlanetSystemLogger::LogWarning(TEXT("PlanetChunkCache"), 
                 FString::Printf(TEXT("Chunk not found in cache: %s"), *ChunkKey));
-            
-            UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("RemoveChunk"));
             return false;
         }
+        
+        UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
+            FString::Printf(TEXT("Chunk removed from cache: %s (Freed: %lld bytes)"), *ChunkKey, RemovedSize));
+        
+        if (IsInGameThread())
+        {
+            UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
+                EPlanetEventType::ChunkRemoved, TEXT("ChunkCache"), ChunkKey, 0.0f, int32(FMath::Min<int64>(RemovedSize, MAX_int32)));
+        }
+        return true;
     }
     catch (const std::exception& e)
     {
@@ -205,65 +226,70 @@ bool UPlanetChunkCache::RemoveChunk(const FString& ChunkKey)
 
 bool UPlanetChunkCache::HasChunk(const FString& ChunkKey) const
 {
-    try
+    if (!bCacheEnabled || ChunkKey.IsEmpty())
     {
-        if (!bCacheEnabled)
-        {
-            return false;
-        }
-        
-        if (ChunkKey.IsEmpty())
+        if (FPlanetCacheInstrumentation::IsVerbose())
         {
-            return false;
+            UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), 
+                bCacheEnabled ? TEXT("Cannot check chunk with empty key") : TEXT("Cache is disabled, chunk not checked"));
         }
-        
-        bool bHasChunk = CacheEntries.Contains(ChunkKey);
-        
-        UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Chunk existence check: %s -> %s"), *ChunkKey, bHasChunk ? TEXT("true") : TEXT("false")));
-        
-        return bHasChunk;
+        Instrumentation.Count(EPlanetCacheOp::Has, false);
+        return false;
     }
-    catch (const std::exception& e)
+    
+    // Caminho quente: lookup + contadores; latência e log só nas operações rastreadas
+    const bool bTrace = FPlanetCacheInstrumentation::ShouldTrace() && IsInGameThread();
+    const uint64 StartCycles = bTrace ? FPlatformTime::Cycles64() : 0;
+    
+    const bool bFound = Cache.Contains(ChunkKey);
+    Instrumentation.Count(EPlanetCacheOp::Has, bFound);
+    
+    if (bTrace)
     {
-        UPlanetSystemLogger::LogError(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Exception checking chunk existence: %s"), UTF8_TO_TCHAR(e.what())));
-        return false;
+        Instrumentation.AddSample(EPlanetCacheOp::Has, FPlatformTime::Cycles64() - StartCycles);
+        UPlanetSystemLogger::LogDebug(TEXT("PlanetChunkCache"), 
+            FString::Printf(TEXT("Chunk %s in cache: %s"), *ChunkKey, bFound ? TEXT("found") : TEXT("not found")));
     }
+    return bFound;
 }
 
 void UPlanetChunkCache::GetCacheStats(FString& OutStats)
 {
     try
     {
-        const float HitRate = (TotalHits + TotalMisses) > 0 ? (float)TotalHits / (TotalHits + TotalMisses) * 100.0f : 0.0f;
-        const float CacheUsagePercent = MaxCacheSizeMB > 0 ? (float)CurrentCacheSizeBytes / (MaxCacheSizeMB * 1024 * 1024) * 100.0f : 0.0f;
+        const auto Stats = Cache.GetStats();
+        const float CurrentMB = Stats.Bytes / (1024.0f * 1024.0f);
         
         OutStats = FString::Printf(
             TEXT("Advanced Chunk Cache Statistics:\n")
             TEXT("================================\n\n")
             TEXT("Cache Status:\n")
             TEXT("- Enabled: %s\n")
-            TEXT("- Total Entries: %d\n")
-            TEXT("- Current Size: %.2f MB / %.2f MB (%.1f%%)\n")
-            TEXT("- Hit Rate: %.1f%% (%d hits, %d misses)\n\n")
+            TEXT("- Total Entries: %d (%d shards)\n")
+            TEXT("- Current Size: %.2f MB / %d MB (%.1f%%)\n")
+            TEXT("- Hit Rate: %.1f%% (%lld hits, %lld misses)\n\n")
             TEXT("Performance:\n")
-            TEXT("- Total Hits: %d\n")
-            TEXT("- Total Misses: %d\n")
+            TEXT("- Total Hits: %lld\n")
+            TEXT("- Total Misses: %lld\n")
+            TEXT("- Evictions: %lld\n")
             TEXT("- Last Optimization: %s\n\n")
             TEXT("Memory Management:\n")
-            TEXT("- Max Cache Size: %.2f MB\n")
+            TEXT("- Max Cache Size: %d MB\n")
             TEXT("- Current Usage: %.2f MB\n")
-            TEXT("- Available Space: %.2f MB\n"),
+            TEXT("- Available Space: %.2f MB\n\n")
+            TEXT("Operations (sampled 1/%d%s):\n%s"),
             bCacheEnabled ? TEXT("Yes") : TEXT("No"),
-            CacheEntries.Num(),
-            CurrentCacheSizeBytes / (1024.0f * 1024.0f), MaxCacheSizeMB, CacheUsagePercent,
-            HitRate, TotalHits, TotalMisses,
-            LastOptimizationTime > 0 ? *FDateTime::FromUnixTimestamp(LastOptimizationTime).ToString() : TEXT("Never"),
-            TotalHits, TotalMisses,
+            Stats.Entries, Cache.GetNumShards(),
+            CurrentMB, MaxCacheSizeMB, GetCacheUsagePercent(),
+            GetHitRate(), Stats.Hits, Stats.Misses,
+            Stats.Hits, Stats.Misses, Stats.Evictions,
+            LastOptimizationTime > 0 ? *FString::Printf(TEXT("%.1fs ago"), FPlatformTime::Seconds() - LastOptimizationTime) : TEXT("Never"),
             MaxCacheSizeMB,
-            CurrentCacheSizeBytes / (1024.0f * 1024.0f),
-            (MaxCacheSizeMB * 1024 * 1024 - CurrentCacheSizeBytes) / (1024.0f * 1024.0f)
+            CurrentMB,
+            (GetMaxCacheBytes() - Stats.Bytes) / (1024.0f * 1024.0f),
+            FPlanetCacheInstrumentation::GetSampleRate(),
+            FPlanetCacheInstrumentation::IsVerbose() ? TEXT(", verbose") : TEXT(""),
+            *Instrumentation.GetReport()
         );
         
         UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), TEXT("Cache statistics retrieved"));
@@ -276,26 +302,28 @@ void UPlanetChunkCache::GetCacheStats(FString& OutStats)
     }
 }
 
-void UPlanetChunkCache::ClearCache()
+void UPlanetChunkCache::ClearCache(bool bForce)
 {
     try
     {
-        UPlanetPerformanceProfiler::GetInstance()->BeginCacheOperation(TEXT("ClearCache"));
-        
-        int32 RemovedEntries = CacheEntries.Num();
-        int64 FreedBytes = CurrentCacheSizeBytes;
+        const auto Stats = Cache.GetStats();
         
-        CacheEntries.Empty();
-        CurrentCacheSizeBytes = 0;
+        Cache.Clear();
+        if (bForce)
+        {
+            Cache.ResetStats();
+            Instrumentation.ResetStats();
+        }
         
         UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
             FString::Printf(TEXT("Cache cleared: %d entries removed, %.2f MB freed"), 
-                RemovedEntries, FreedBytes / (1024.0f * 1024.0f)));
-        
-        UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
-            EPlanetEventType::ChunkCacheCleared, TEXT("ChunkCache"), TEXT(""), 0.0f, RemovedEntries);
+                Stats.Entries, Stats.Bytes / (1024.0f * 1024.0f)));
         
-        UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("ClearCache"));
+        if (IsInGameThread())
+        {
+            UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
+                EPlanetEventType::ChunkCacheCleared, TEXT("ChunkCache"), TEXT(""), 0.0f, Stats.Entries);
+        }
     }
     catch (const std::exception& e)
     {
@@ -308,70 +336,25 @@ void UPlanetChunkCache::OptimizeCache()
 {
     try
     {
-        UPlanetPerformanceProfiler::GetInstance()->BeginCacheOperation(TEXT("OptimizeCache"));
+        const double StartTime = FPlatformTime::Seconds();
+        const int64 BytesBefore = Cache.GetBytes();
         
-        const float StartTime = FPlatformTime::Seconds();
-        int32 RemovedEntries = 0;
-        int64 FreedBytes = 0;
-        
-        // Lista de chunks candidatos para remoção
-        TArray<TPair<FString, float>> RemovalCandidates;
-        
-        for (const auto& Pair : CacheEntries)
-        {
-            const FString& ChunkKey = Pair.Key;
-            const FCacheEntry& Entry = Pair.Value;
-            
-            // Calcula score de remoção baseado em:
-            // - Tempo desde último acesso (mais antigo = maior score)
-            // - Número de acessos (menos acessos = maior score)
-            // - Prioridade (menor prioridade = maior score)
-            // - Tamanho (maior tamanho = maior score)
-            
-            const float TimeSinceAccess = FPlatformTime::Seconds() - Entry.LastAccessTime;
-            const float AccessScore = Entry.AccessCount > 0 ? 1.0f / Entry.AccessCount : 1.0f;
-            const float PriorityScore = 1.0f - Entry.Priority; // Inverte prioridade
-            const float SizeScore = Entry.SizeInBytes / (1024.0f * 1024.0f); // Normaliza por MB
-            
-            const float RemovalScore = TimeSinceAccess * AccessScore * PriorityScore * SizeScore;
-            RemovalCandidates.Add(TPair<FString, float>(ChunkKey, RemovalScore));
-        }
-        
-        // Ordena por score de remoção (maior score primeiro)
-        RemovalCandidates.Sort([](const TPair<FString, float>& A, const TPair<FString, float>& B) {
-            return A.Value > B.Value;
-        });
-        
-        // Remove chunks até liberar pelo menos 20% do cache ou remover no máximo 30% dos chunks
-        const int32 MaxRemovals = FMath::Min(CacheEntries.Num() / 3, CacheEntries.Num());
-        const int64 TargetFreedBytes = CurrentCacheSizeBytes / 5; // 20% do cache
-        
-        for (int32 i = 0; i < MaxRemovals && FreedBytes < TargetFreedBytes; ++i)
-        {
-            const FString& ChunkKey = RemovalCandidates[i].Key;
-            FCacheEntry* Entry = CacheEntries.Find(ChunkKey);
-            
-            if (Entry)
-            {
-                FreedBytes += Entry->SizeInBytes;
-                CacheEntries.Remove(ChunkKey);
-                RemovedEntries++;
-            }
-        }
+        // Mantém 80% do orçamento, removendo pela política do núcleo (vítima do heap, sem varrer o cache)
+        const int32 RemovedEntries = Cache.TrimToFraction(0.8f);
+        const int64 FreedBytes = BytesBefore - Cache.GetBytes();
         
-        CurrentCacheSizeBytes -= FreedBytes;
         LastOptimizationTime = FPlatformTime::Seconds();
-        
-        const float OptimizationTime = FPlatformTime::Seconds() - StartTime;
+        const float OptimizationTime = LastOptimizationTime - StartTime;
         
         UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
             FString::Printf(TEXT("Cache optimization completed: %d entries removed, %.2f MB freed in %.3f seconds"), 
                 RemovedEntries, FreedBytes / (1024.0f * 1024.0f), OptimizationTime));
         
-        UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
-            EPlanetEventType::ChunkCacheOptimized, TEXT("ChunkCache"), TEXT(""), OptimizationTime, RemovedEntries);
-        
-        UPlanetPerformanceProfiler::GetInstance()->EndCacheOperation(TEXT("OptimizeCache"));
+        if (IsInGameThread())
+        {
+            UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
+                EPlanetEventType::ChunkCacheOptimized, TEXT("ChunkCache"), TEXT(""), OptimizationTime, RemovedEntries);
+        }
     }
     catch (const std::exception& e)
     {
@@ -382,175 +365,75 @@ void UPlanetChunkCache::OptimizeCache()
 
 void UPlanetChunkCache::SetMaxCacheSize(int32 MaxSizeMB)
 {
-    try
+    if (MaxSizeMB <= 0)
     {
-        if (MaxSizeMB <= 0)
-        {
-            UPlanetSystemLogger::LogWarning(TEXT("PlanetChunkCache"), 
-                FString::Printf(TEXT("Invalid max cache size: %d MB"), MaxSizeMB));
-            return;
-        }
-        
-        const int32 OldMaxSize = MaxCacheSizeMB;
-        MaxCacheSizeMB = MaxSizeMB;
-        
-        UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Max cache size changed: %d MB -> %d MB"), OldMaxSize, MaxSizeMB));
-        
-        // Se o novo tamanho é menor que o uso atual, otimiza o cache
-        if (CurrentCacheSizeBytes > MaxCacheSizeMB * 1024 * 1024)
-        {
-            UPlanetSystemLogger::LogWarning(TEXT("PlanetChunkCache"), 
-                TEXT("Current cache usage exceeds new max size, optimizing..."));
-            OptimizeCache();
-        }
-        
-        UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
-            EPlanetEventType::ChunkCacheResized, TEXT("ChunkCache"), TEXT(""), 0.0f, MaxSizeMB);
+        UPlanetSystemLogger::LogWarning(TEXT("PlanetChunkCache"), 
+            FString::Printf(TEXT("Invalid max cache size: %d MB"), MaxSizeMB));
+        return;
     }
-    catch (const std::exception& e)
+    
+    const int32 OldMaxSize = MaxCacheSizeMB;
+    MaxCacheSizeMB = MaxSizeMB;
+    
+    // O núcleo remove chunks de menor prioridade se o novo limite for menor que o uso atual
+    Cache.SetMaxBytes(GetMaxCacheBytes());
+    
+    UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
+        FString::Printf(TEXT("Max cache size changed: %d MB -> %d MB"), OldMaxSize, MaxSizeMB));
+    
+    if (IsInGameThread())
     {
-        UPlanetSystemLogger::LogError(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Exception setting max cache size: %s"), UTF8_TO_TCHAR(e.what())));
+        UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
+            EPlanetEventType::ChunkCacheResized, TEXT("ChunkCache"), TEXT(""), 0.0f, MaxSizeMB);
     }
 }
 
-int32 UPlanetChunkCache::GetCurrentCacheSize() const
+void UPlanetChunkCache::SetReplacementPolicy(EPlanetCachePolicy Policy)
 {
-    return CurrentCacheSizeBytes;
+    Cache.SetPolicy(Policy);
+    UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
+        FString::Printf(TEXT("Replacement policy changed: %s"), *UEnum::GetValueAsString(Policy)));
 }
 
-void UPlanetChunkCache::SetCacheEnabled(bool bEnable)
+EPlanetCachePolicy UPlanetChunkCache::GetReplacementPolicy() const
 {
-    try
-    {
-        bCacheEnabled = bEnable;
-        
-        if (bEnable)
-        {
-            UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), TEXT("Chunk cache enabled"));
-            
-            UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
-                EPlanetEventType::ChunkCacheEnabled, TEXT("ChunkCache"));
-        }
-        else
-        {
-            UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), TEXT("Chunk cache disabled"));
-            
-            UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
-                EPlanetEventType::ChunkCacheDisabled, TEXT("ChunkCache"));
-        }
-    }
-    catch (const std::exception& e)
-    {
-        UPlanetSystemLogger::LogError(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Exception setting cache enabled: %s"), UTF8_TO_TCHAR(e.what())));
-    }
+    return Cache.GetPolicy();
 }
 
-bool UPlanetChunkCache::IsCacheEnabled() const
+int64 UPlanetChunkCache::GetCurrentCacheSize() const
 {
-    return bCacheEnabled;
+    return Cache.GetBytes();
 }
 
-// Funções auxiliares
-
-int32 UPlanetChunkCache::EstimateChunkSize(const FPlanetChunk& Chunk) const
+void UPlanetChunkCache::SetCacheEnabled(bool bEnable)
 {
-    try
-    {
-        // Estimativa básica do tamanho do chunk
-        // Em uma implementação real, você calcularia o tamanho real baseado nos dados do chunk
-        
-        int32 EstimatedSize = 0;
-        
-        // Tamanho base para estrutura do chunk
-        EstimatedSize += sizeof(FPlanetChunk);
-        
-        // Adiciona tamanho estimado para vértices, índices, etc.
-        // Esta é uma estimativa simplificada
-        EstimatedSize += 1024; // 1KB base
-        
-        return EstimatedSize;
-    }
-    catch (const std::exception& e)
+    bCacheEnabled = bEnable;
+    
+    UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), bEnable ? TEXT("Chunk cache enabled") : TEXT("Chunk cache disabled"));
+    
+    if (IsInGameThread())
     {
-        UPlanetSystemLogger::LogError(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Exception estimating chunk size: %s"), UTF8_TO_TCHAR(e.what())));
-        return 1024; // Tamanho padrão em caso de erro
+        UPlanetEventBus::GetInstance()->BroadcastEventWithParams(
+            bEnable ? EPlanetEventType::ChunkCacheEnabled : EPlanetEventType::ChunkCacheDisabled, TEXT("ChunkCache"));
     }
 }
 
-bool UPlanetChunkCache::OptimizeCacheForNewChunk(int32 RequiredSize)
+bool UPlanetChunkCache::IsCacheEnabled() const
 {
-    try
+    return bCacheEnabled;
+}
+
+void UPlanetChunkCache::HandleMemoryTrim(float KeepFraction)
+{
+    // as remoções entram nas estatísticas do cache; a mensagem formatada só no modo verbose
+    const int64 BytesBefore = Cache.GetBytes();
+    const int32 Removed = Cache.TrimUsage(KeepFraction);
+    
+    if (FPlanetCacheInstrumentation::IsVerbose())
     {
-        // Se o chunk requerido é maior que o cache inteiro, não pode ser adicionado
-        if (RequiredSize > MaxCacheSizeMB * 1024 * 1024)
-        {
-            UPlanetSystemLogger::LogWarning(TEXT("PlanetChunkCache"), 
-                FString::Printf(TEXT("Required chunk size (%d bytes) exceeds max cache size"), RequiredSize));
-            return false;
-        }
-        
-        // Calcula quanto espaço precisa ser liberado
-        const int64 RequiredFreedSpace = RequiredSize - (MaxCacheSizeMB * 1024 * 1024 - CurrentCacheSizeBytes);
-        
-        if (RequiredFreedSpace <= 0)
-        {
-            return true; // Há espaço suficiente
-        }
-        
-        // Lista chunks candidatos para remoção
-        TArray<TPair<FString, float>> RemovalCandidates;
-        
-        for (const auto& Pair : CacheEntries)
-        {
-            const FString& ChunkKey = Pair.Key;
-            const FCacheEntry& Entry = Pair.Value;
-            
-            // Score baseado em prioridade e tempo de acesso
-            const float TimeSinceAccess = FPlatformTime::Seconds() - Entry.LastAccessTime;
-            const float PriorityScore = 1.0f - Entry.Priority;
-            const float RemovalScore = TimeSinceAccess * PriorityScore;
-            
-            RemovalCandidates.Add(TPair<FString, float>(ChunkKey, RemovalScore));
-        }
-        
-        // Ordena por score de remoção
-        RemovalCandidates.Sort([](const TPair<FString, float>& A, const TPair<FString, float>& B) {
-            return A.Value > B.Value;
-        });
-        
-        // Remove chunks até liberar espaço suficiente
-        int64 FreedSpace = 0;
-        for (const auto& Candidate : RemovalCandidates)
-        {
-            FCacheEntry* Entry = CacheEntries.Find(Candidate.Key);
-            if (Entry)
-            {
-                FreedSpace += Entry->SizeInBytes;
-                CacheEntries.Remove(Candidate.Key);
-                
-                if (FreedSpace >= RequiredFreedSpace)
-                {
-                    break;
-                }
-            }
-        }
-        
-        CurrentCacheSizeBytes -= FreedSpace;
-        
         UPlanetSystemLogger::LogInfo(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Cache optimized for new chunk: %.2f MB freed"), FreedSpace / (1024.0f * 1024.0f)));
-        
-        return FreedSpace >= RequiredFreedSpace;
-    }
-    catch (const std::exception& e)
-    {
-        UPlanetSystemLogger::LogError(TEXT("PlanetChunkCache"), 
-            FString::Printf(TEXT("Exception optimizing cache for new chunk: %s"), UTF8_TO_TCHAR(e.what())));
-        return false;
+            FString::Printf(TEXT("Memory pressure trim: %d entries removed, %.2f MB freed"), 
+                Removed, (BytesBefore - Cache.GetBytes()) / (1024.0f * 1024.0f)));
     }
 }
 
@@ -559,119 +442,90 @@ bool UPlanetChunkCache::OptimizeCacheForNewChunk(int32 RequiredSize)
 TArray<FString> UPlanetChunkCache::GetAllChunkKeys() const
 {
     TArray<FString> Keys;
-    CacheEntries.GetKeys(Keys);
+    Cache.ForEach([&Keys](const FString& Key, const auto&) { Keys.Add(Key); });
     return Keys;
 }
 
 int32 UPlanetChunkCache::GetChunkAccessCount(const FString& ChunkKey) const
 {
-    const FCacheEntry* Entry = CacheEntries.Find(ChunkKey);
-    return Entry ? Entry->AccessCount : 0;
+    TPlanetShardedCache<FString, FPlanetChunk>::FEntryInfo Info;
+    return Cache.GetInfo(ChunkKey, Info) ? Info.AccessCount : 0;
 }
 
 float UPlanetChunkCache::GetChunkPriority(const FString& ChunkKey) const
 {
-    const FCacheEntry* Entry = CacheEntries.Find(ChunkKey);
-    return Entry ? Entry->Priority : 0.0f;
+    TPlanetShardedCache<FString, FPlanetChunk>::FEntryInfo Info;
+    return Cache.GetInfo(ChunkKey, Info) ? Info.Priority : 0.0f;
 }
 
 float UPlanetChunkCache::GetChunkLastAccessTime(const FString& ChunkKey) const
 {
-    const FCacheEntry* Entry = CacheEntries.Find(ChunkKey);
-    return Entry ? Entry->LastAccessTime : 0.0f;
+    TPlanetShardedCache<FString, FPlanetChunk>::FEntryInfo Info;
+    return Cache.GetInfo(ChunkKey, Info) ? float(Info.LastAccessTime) : 0.0f;
 }
 
-int32 UPlanetChunkCache::GetChunkSize(const FString& ChunkKey) const
+int64 UPlanetChunkCache::GetChunkSize(const FString& ChunkKey) const
 {
-    const FCacheEntry* Entry = CacheEntries.Find(ChunkKey);
-    return Entry ? Entry->SizeInBytes : 0;
+    TPlanetShardedCache<FString, FPlanetChunk>::FEntryInfo Info;
+    return Cache.GetInfo(ChunkKey, Info) ? Info.Bytes : 0;
 }
 
 void UPlanetChunkCache::GetMostAccessedChunks(int32 Count, TArray<TPair<FString, int32>>& OutMostAccessed) const
 {
     OutMostAccessed.Empty();
+    Cache.ForEach([&](const FString& Key, const auto& Info) { OutMostAccessed.Add(TPair<FString, int32>(Key, Info.AccessCount)); });
     
-    TArray<TPair<FString, int32>> SortedChunks;
-    for (const auto& Pair : CacheEntries)
-    {
-        SortedChunks.Add(TPair<FString, int32>(Pair.Key, Pair.Value.AccessCount));
-    }
-    
-    SortedChunks.Sort([](const TPair<FString, int32>& A, const TPair<FString, int32>& B) {
+    OutMostAccessed.Sort([](const TPair<FString, int32>& A, const TPair<FString, int32>& B) {
         return A.Value > B.Value;
     });
-    
-    Count = FMath::Min(Count, SortedChunks.Num());
-    for (int32 i = 0; i < Count; ++i)
-    {
-        OutMostAccessed.Add(SortedChunks[i]);
-    }
+    OutMostAccessed.SetNum(FMath::Min(FMath::Max(Count, 0), OutMostAccessed.Num()));
 }
 
-void UPlanetChunkCache::GetLargestChunks(int32 Count, TArray<TPair<FString, int32>>& OutLargestChunks) const
+void UPlanetChunkCache::GetLargestChunks(int32 Count, TArray<TPair<FString, int64>>& OutLargestChunks) const
 {
     OutLargestChunks.Empty();
+    Cache.ForEach([&](const FString& Key, const auto& Info) { OutLargestChunks.Add(TPair<FString, int64>(Key, Info.Bytes)); });
     
-    TArray<TPair<FString, int32>> SortedChunks;
-    for (const auto& Pair : CacheEntries)
-    {
-        SortedChunks.Add(TPair<FString, int32>(Pair.Key, Pair.Value.SizeInBytes));
-    }
-    
-    SortedChunks.Sort([](const TPair<FString, int32>& A, const TPair<FString, int32>& B) {
+    OutLargestChunks.Sort([](const TPair<FString, int64>& A, const TPair<FString, int64>& B) {
         return A.Value > B.Value;
     });
-    
-    Count = FMath::Min(Count, SortedChunks.Num());
-    for (int32 i = 0; i < Count; ++i)
-    {
-        OutLargestChunks.Add(SortedChunks[i]);
-    }
+    OutLargestChunks.SetNum(FMath::Min(FMath::Max(Count, 0), OutLargestChunks.Num()));
 }
 
 void UPlanetChunkCache::GetOldestChunks(int32 Count, TArray<TPair<FString, float>>& OutOldestChunks) const
 {
     OutOldestChunks.Empty();
+    Cache.ForEach([&](const FString& Key, const auto& Info) { OutOldestChunks.Add(TPair<FString, float>(Key, float(Info.LastAccessTime))); });
     
-    TArray<TPair<FString, float>> SortedChunks;
-    for (const auto& Pair : CacheEntries)
-    {
-        SortedChunks.Add(TPair<FString, float>(Pair.Key, Pair.Value.LastAccessTime));
-    }
-    
-    SortedChunks.Sort([](const TPair<FString, float>& A, const TPair<FString, float>& B) {
+    OutOldestChunks.Sort([](const TPair<FString, float>& A, const TPair<FString, float>& B) {
         return A.Value < B.Value; // Ordena por tempo mais antigo primeiro
     });
-    
-    Count = FMath::Min(Count, SortedChunks.Num());
-    for (int32 i = 0; i < Count; ++i)
-    {
-        OutOldestChunks.Add(SortedChunks[i]);
-    }
+    OutOldestChunks.SetNum(FMath::Min(FMath::Max(Count, 0), OutOldestChunks.Num()));
 }
 
 float UPlanetChunkCache::GetHitRate() const
 {
-    const int32 TotalRequests = TotalHits + TotalMisses;
-    return TotalRequests > 0 ? (float)TotalHits / TotalRequests * 100.0f : 0.0f;
+    const auto Stats = Cache.GetStats();
+    const int64 TotalRequests = Stats.Hits + Stats.Misses;
+    return TotalRequests > 0 ? float(double(Stats.Hits) / TotalRequests * 100.0) : 0.0f;
 }
 
-int32 UPlanetChunkCache::GetTotalHits() const
+int64 UPlanetChunkCache::GetTotalHits() const
 {
-    return TotalHits;
+    return Cache.GetStats().Hits;
 }
 
-int32 UPlanetChunkCache::GetTotalMisses() const
+int64 UPlanetChunkCache::GetTotalMisses() const
 {
-    return TotalMisses;
+    return Cache.GetStats().Misses;
 }
 
 int32 UPlanetChunkCache::GetEntryCount() const
 {
-    return CacheEntries.Num();
+    return Cache.Num();
 }
 
 float UPlanetChunkCache::GetCacheUsagePercent() const
 {
-    return MaxCacheSizeMB > 0 ? (float)CurrentCacheSizeBytes / (MaxCacheSizeMB * 1024 * 1024) * 100.0f : 0.0f;
-} 
\ No newline at end of file
+    return MaxCacheSizeMB > 0 ? float(double(Cache.GetBytes()) / GetMaxCacheBytes() * 100.0) : 0.0f;
+}
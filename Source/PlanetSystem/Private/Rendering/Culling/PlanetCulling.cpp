@@ -0,0 +1,45 @@
+#include "Rendering/Culling/PlanetCulling.h"
+#include "SceneManagement.h"
+
+void FPlanetCullingView::SetFrustum(const FVector& Location, const FRotator& Rotation, float FOVDegrees, float AspectRatio)
+{
+    ViewOrigin = Location;
+
+    // mesma convenção de eixos da câmera do engine (X para frente -> Z da view)
+    const FMatrix ViewMatrix = FTranslationMatrix(-Location)
+        * FInverseRotationMatrix(Rotation)
+        * FMatrix(FPlane(0, 0, 1, 0), FPlane(1, 0, 0, 0), FPlane(0, 1, 0, 0), FPlane(0, 0, 0, 1));
+
+    const float HalfFOV = FMath::DegreesToRadians(FMath::Clamp(FOVDegrees, 1.f, 170.f)) * 0.5f;
+    const FMatrix ProjectionMatrix = FReversedZPerspectiveMatrix(HalfFOV, AspectRatio, 1.f, GNearClippingPlane);
+
+    GetViewFrustumBounds(Frustum, ViewMatrix * ProjectionMatrix, false);
+    bHasFrustum = true;
+}
+
+void FPlanetCullingView::SetPlanet(const FVector& Center, float Radius)
+{
+    PlanetCenter = Center;
+    OccluderRadius = FMath::Max(Radius, 0.f);
+}
+
+bool FPlanetCullingView::IsInFrustum(const FSphere& Bounds) const
+{
+    return !bHasFrustum || Frustum.IntersectSphere(Bounds.Center, Bounds.W);
+}
+
+bool FPlanetCullingView::IsBeyondHorizon(const FSphere& Bounds) const
+{
+    const float ViewerHeight = FVector::Dist(ViewOrigin, PlanetCenter);
+    if (OccluderRadius <= 0.f || ViewerHeight <= OccluderRadius)
+    {
+        return false;
+    }
+
+    // distância até o horizonte do observador + horizonte do ponto mais alto da esfera
+    const float ViewerHorizon = FMath::Sqrt(FMath::Square(ViewerHeight) - FMath::Square(OccluderRadius));
+    const float TopHeight = FVector::Dist(Bounds.Center, PlanetCenter) + Bounds.W;
+    const float BoundsHorizon = FMath::Sqrt(FMath::Max(FMath::Square(TopHeight) - FMath::Square(OccluderRadius), 0.f));
+
+    return FVector::Dist(ViewOrigin, Bounds.Center) - Bounds.W > ViewerHorizon + BoundsHorizon;
+}
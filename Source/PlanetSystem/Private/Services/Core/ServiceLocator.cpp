@@ -9,6 +9,7 @@
 #include "Configuration/Validators/PlanetConfigValidator.h"
 #include "Debug/Logging/PlanetSystemLogger.h"
 #include "Engine/Engine.h"
+#include "Misc/Paths.h"
 
 UPlanetSystemServiceLocator* UPlanetSystemServiceLocator::Instance = nullptr;
 
@@ -75,6 +76,7 @@ void UPlanetSystemServiceLocator::InitializeServices(UPlanetCoreConfig* Config)
     if (!ErosionService)
     {
         ErosionService = NewObject<UErosionModule>();
+        ErosionService->InitializeDeltaCache(FPaths::ProjectSavedDir() / TEXT("PlanetSystem/Cache/ErosionDeltas.bin"));
     }
     
     if (!VegetationService)
@@ -250,6 +252,11 @@ void UPlanetSystemServiceLocator::ShutdownServices()
 {
     RegisteredPlugins.Empty();
     
+    if (ErosionService)
+    {
+        ErosionService->FlushDeltaCache();
+    }
+    
     if (Instance)
     {
         Instance->RemoveFromRoot();
@@ -1,12 +1,508 @@
 #include "Services/Environment/BiomeSystem.h"
+#include "Engine/Texture2D.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace
+{
+    // Mapeamento de cor da textura para bioma
+    FORCEINLINE uint8 DecodeBiomeColor(const FColor& C)
+    {
+        return uint8(C.R % (int)EBiomeType::Snow + 1);
+    }
+
+    // Amostragem nearest, sem desvios: altitude em X, inclinação em Y
+    FORCEINLINE uint8 SampleLookup(const FBiomeLookupTable& Table, float ScaleX, float ScaleY, float Altitude, float Slope)
+    {
+        const int32 X = FMath::Clamp(int32(Altitude * ScaleX), 0, Table.SizeX - 1);
+        const int32 Y = FMath::Clamp(int32(Slope * ScaleY), 0, Table.SizeY - 1);
+        return Table.Cells[Y * Table.SizeX + X];
+    }
+}
 
 EBiomeType UBiomeSystem::GetBiome(float Altitude, float Slope, float Humidity) const
 {
-    if (!BiomeLookup) return EBiomeType::Plains;
-    int32 X = FMath::Clamp(int32((Altitude/2000.f)*BiomeLookup->GetSizeX()), 0, BiomeLookup->GetSizeX()-1);
-    int32 Y = FMath::Clamp(int32(Slope*BiomeLookup->GetSizeY()), 0, BiomeLookup->GetSizeY()-1);
-    FColor* Colors = static_cast<FColor*>(BiomeLookup->PlatformData->Mips[0].BulkData.LockReadOnly());
-    FColor C = Colors[Y*BiomeLookup->GetSizeX() + X];
-    BiomeLookup->PlatformData->Mips[0].BulkData.Unlock();
-    return EBiomeType(C.R % (int)EBiomeType::Snow + 1);
+    const FLookupTableRef Table = GetLookupTable();
+    if (!Table) return EBiomeType::Plains;
+    return EBiomeType(SampleLookup(*Table, Table->SizeX / 2000.f, float(Table->SizeY), Altitude, Slope));
+}
+
+void UBiomeSystem::GetBiomes(TArrayView<const float> Altitudes, TArrayView<const float> Slopes,
+                             TArrayView<const float> Humidities, TArrayView<uint8> OutBiomes) const
+{
+    const int32 Num = OutBiomes.Num();
+    check(Altitudes.Num() >= Num && Slopes.Num() >= Num && Humidities.Num() >= Num);
+
+    const FLookupTableRef Table = GetLookupTable();
+    if (!Table)
+    {
+        FMemory::Memset(OutBiomes.GetData(), uint8(EBiomeType::Plains), Num);
+        return;
+    }
+
+    const float ScaleX = Table->SizeX / 2000.f;
+    const float ScaleY = float(Table->SizeY);
+    const float* RESTRICT A = Altitudes.GetData();
+    const float* RESTRICT S = Slopes.GetData();
+    uint8* RESTRICT Out = OutBiomes.GetData();
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        Out[i] = SampleLookup(*Table, ScaleX, ScaleY, A[i], S[i]);
+    }
+}
+
+void UBiomeSystem::ClassifyBiomes(TArrayView<const float> Altitudes, TArrayView<const float> Slopes,
+                                  TArrayView<const float> Temperatures, TArrayView<const float> Humidities,
+                                  TArrayView<uint8> OutBiomes, TArrayView<float> OutWeights) const
+{
+    const int32 Num = OutBiomes.Num();
+    check(Altitudes.Num() >= Num && Slopes.Num() >= Num && Temperatures.Num() >= Num && Humidities.Num() >= Num);
+
+    const bool bWantWeights = OutWeights.Num() > 0;
+    check(!bWantWeights || OutWeights.Num() >= Num * BiomeTypeCount);
+
+    // textura de lookup definida pelo artista tem precedência sobre as regras
+    if (GetLookupTable().IsValid())
+    {
+        GetBiomes(Altitudes, Slopes, Humidities, OutBiomes);
+        if (bWantWeights)
+        {
+            FMemory::Memzero(OutWeights.GetData(), Num * BiomeTypeCount * sizeof(float));
+            for (int32 i = 0; i < Num; ++i)
+            {
+                OutWeights[OutBiomes[i] * Num + i] = 1.f;
+            }
+        }
+        return;
+    }
+
+    const VectorRegister Zero = VectorZero();
+    const VectorRegister One = VectorOne();
+    const VectorRegister Half = VectorSetFloat1(0.5f);
+    const VectorRegister InvWidth = VectorSetFloat1(1.f / FMath::Max(BiomeConfig.TransitionWidth, 0.001f));
+
+    const VectorRegister InvMaxAltitude = VectorSetFloat1(1.f / FMath::Max(BiomeConfig.MaxAltitude, 1.f));
+    const VectorRegister ForestHumidity = VectorSetFloat1(BiomeConfig.ForestHumidityThreshold);
+    const VectorRegister DryHumidity = VectorSetFloat1(1.f - BiomeConfig.ForestHumidityThreshold);
+    const VectorRegister WarmTemperature = VectorSetFloat1(0.5f);
+    const VectorRegister DesertAltitude = VectorSetFloat1(BiomeConfig.DesertAltitudeThreshold);
+    const VectorRegister MountainAltitude = VectorSetFloat1(BiomeConfig.MountainAltitudeThreshold);
+    const VectorRegister SnowAltitude = VectorSetFloat1(BiomeConfig.SnowAltitudeThreshold);
+    const VectorRegister SnowTemperature = VectorSetFloat1(BiomeConfig.SnowTemperatureThreshold);
+    const VectorRegister PlainsSlope = VectorSetFloat1(BiomeConfig.PlainsSlopeThreshold);
+
+    const VectorRegister DesertId = VectorSetFloat1(float(EBiomeType::Desert));
+    const VectorRegister PlainsId = VectorSetFloat1(float(EBiomeType::Plains));
+    const VectorRegister MountainsId = VectorSetFloat1(float(EBiomeType::Mountains));
+    const VectorRegister ForestId = VectorSetFloat1(float(EBiomeType::Forest));
+    const VectorRegister SnowId = VectorSetFloat1(float(EBiomeType::Snow));
+
+    // versão suave de (Value >= Threshold): rampa linear de largura TransitionWidth
+    auto SoftGE = [&](const VectorRegister& Value, const VectorRegister& Threshold)
+    {
+        return VectorMin(VectorMax(VectorMultiplyAdd(VectorSubtract(Value, Threshold), InvWidth, Half), Zero), One);
+    };
+
+    const float* A = Altitudes.GetData();
+    const float* S = Slopes.GetData();
+    const float* T = Temperatures.GetData();
+    const float* H = Humidities.GetData();
+    uint8* Out = OutBiomes.GetData();
+    float* W = bWantWeights ? OutWeights.GetData() : nullptr;
+
+    // regras aplicadas em ordem crescente de precedência via máscaras, 4 pontos por vez
+    auto Classify4 = [&](int32 Base, const float* A4, const float* S4, const float* T4, const float* H4, int32 Count)
+    {
+        const VectorRegister Altitude = VectorMultiply(VectorLoad(A4), InvMaxAltitude);
+        const VectorRegister Slope = VectorLoad(S4);
+        const VectorRegister Temperature = VectorLoad(T4);
+        const VectorRegister Humidity = VectorLoad(H4);
+
+        VectorRegister Biome = PlainsId;
+        Biome = VectorSelect(VectorCompareGE(Humidity, ForestHumidity), ForestId, Biome);
+
+        const VectorRegister DesertMask = VectorBitwiseAnd(
+            VectorBitwiseAnd(VectorCompareLT(Humidity, DryHumidity), VectorCompareGT(Temperature, WarmTemperature)),
+            VectorCompareLT(Altitude, DesertAltitude));
+        Biome = VectorSelect(DesertMask, DesertId, Biome);
+
+        const VectorRegister MountainMask = VectorBitwiseOr(VectorCompareGE(Altitude, MountainAltitude), VectorCompareGE(Slope, PlainsSlope));
+        Biome = VectorSelect(MountainMask, MountainsId, Biome);
+
+        const VectorRegister SnowMask = VectorBitwiseOr(VectorCompareGE(Altitude, SnowAltitude), VectorCompareLT(Temperature, SnowTemperature));
+        Biome = VectorSelect(SnowMask, SnowId, Biome);
+
+        alignas(16) float Result[4];
+        VectorStoreAligned(Biome, Result);
+        for (int32 k = 0; k < Count; ++k)
+        {
+            Out[Base + k] = uint8(Result[k]);
+        }
+
+        if (!W)
+        {
+            return;
+        }
+
+        // mesmas regras com máscaras suaves, compostas na mesma ordem de precedência (somam 1)
+        const VectorRegister Forest = SoftGE(Humidity, ForestHumidity);
+        const VectorRegister Desert = VectorMultiply(
+            VectorMultiply(VectorSubtract(One, SoftGE(Humidity, DryHumidity)), SoftGE(Temperature, WarmTemperature)),
+            VectorSubtract(One, SoftGE(Altitude, DesertAltitude)));
+        const VectorRegister Mountains = VectorMax(SoftGE(Altitude, MountainAltitude), SoftGE(Slope, PlainsSlope));
+        const VectorRegister Snow = VectorMax(SoftGE(Altitude, SnowAltitude), VectorSubtract(One, SoftGE(Temperature, SnowTemperature)));
+
+        VectorRegister Weights[BiomeTypeCount];
+        Weights[int32(EBiomeType::Plains)] = VectorSubtract(One, Forest);
+        Weights[int32(EBiomeType::Forest)] = Forest;
+        Weights[int32(EBiomeType::Desert)] = Desert;
+        Weights[int32(EBiomeType::Mountains)] = Mountains;
+        Weights[int32(EBiomeType::Snow)] = Snow;
+
+        const VectorRegister KeepDesert = VectorSubtract(One, Desert);
+        Weights[int32(EBiomeType::Plains)] = VectorMultiply(Weights[int32(EBiomeType::Plains)], KeepDesert);
+        Weights[int32(EBiomeType::Forest)] = VectorMultiply(Weights[int32(EBiomeType::Forest)], KeepDesert);
+
+        const VectorRegister KeepMountains = VectorSubtract(One, Mountains);
+        Weights[int32(EBiomeType::Plains)] = VectorMultiply(Weights[int32(EBiomeType::Plains)], KeepMountains);
+        Weights[int32(EBiomeType::Forest)] = VectorMultiply(Weights[int32(EBiomeType::Forest)], KeepMountains);
+        Weights[int32(EBiomeType::Desert)] = VectorMultiply(Weights[int32(EBiomeType::Desert)], KeepMountains);
+
+        const VectorRegister KeepSnow = VectorSubtract(One, Snow);
+        Weights[int32(EBiomeType::Plains)] = VectorMultiply(Weights[int32(EBiomeType::Plains)], KeepSnow);
+        Weights[int32(EBiomeType::Forest)] = VectorMultiply(Weights[int32(EBiomeType::Forest)], KeepSnow);
+        Weights[int32(EBiomeType::Desert)] = VectorMultiply(Weights[int32(EBiomeType::Desert)], KeepSnow);
+        Weights[int32(EBiomeType::Mountains)] = VectorMultiply(Weights[int32(EBiomeType::Mountains)], KeepSnow);
+
+        for (int32 b = 0; b < BiomeTypeCount; ++b)
+        {
+            VectorStoreAligned(Weights[b], Result);
+            FMemory::Memcpy(W + b * Num + Base, Result, Count * sizeof(float));
+        }
+    };
+
+    int32 i = 0;
+    for (; i + 4 <= Num; i += 4)
+    {
+        Classify4(i, A + i, S + i, T + i, H + i, 4);
+    }
+
+    if (i < Num)
+    {
+        float TailA[4] = {}, TailS[4] = {}, TailT[4] = {}, TailH[4] = {};
+        const int32 Count = Num - i;
+        FMemory::Memcpy(TailA, A + i, Count * sizeof(float));
+        FMemory::Memcpy(TailS, S + i, Count * sizeof(float));
+        FMemory::Memcpy(TailT, T + i, Count * sizeof(float));
+        FMemory::Memcpy(TailH, H + i, Count * sizeof(float));
+        Classify4(i, TailA, TailS, TailT, TailH, Count);
+    }
+}
+
+void UBiomeSystem::ClassifyPatch(const TArray<FVector>& Vertices, int32 Res, float PlanetRadius, TArray<uint8>& OutBiomeMap,
+                                 FBiomeBlendStream* OutBlend) const
+{
+    const int32 Size = Res + 1;
+    const int32 Num = Vertices.Num();
+    OutBiomeMap.SetNumUninitialized(Num);
+
+    if (Num == 0 || Num != Size * Size)
+    {
+        FMemory::Memset(OutBiomeMap.GetData(), uint8(EBiomeType::Plains), Num);
+        if (OutBlend)
+        {
+            OutBlend->Weights.Init(FColor(255, 0, 0, 0), Num);
+            OutBlend->Indices.Init(FVector2D(float(EBiomeType::Plains), 0.f), Num);
+        }
+        return;
+    }
+
+    TArray<float> Altitudes, Slopes, Temperatures, Humidities;
+    Altitudes.SetNumUninitialized(Num);
+    Slopes.SetNumUninitialized(Num);
+    Temperatures.SetNumUninitialized(Num);
+    Humidities.SetNumUninitialized(Num);
+
+    const float InvMaxAltitude = 1.f / FMath::Max(BiomeConfig.MaxAltitude, 1.f);
+
+    for (int32 y = 0; y < Size; ++y)
+    {
+        for (int32 x = 0; x < Size; ++x)
+        {
+            const int32 i = y * Size + x;
+            const FVector& V = Vertices[i];
+            const float Length = V.Size();
+            const FVector Up = Length > KINDA_SMALL_NUMBER ? V / Length : FVector::UpVector;
+
+            // normal por diferença central na grade (unilateral nas bordas)
+            const FVector DX = Vertices[y * Size + FMath::Min(x + 1, Res)] - Vertices[y * Size + FMath::Max(x - 1, 0)];
+            const FVector DY = Vertices[FMath::Min(y + 1, Res) * Size + x] - Vertices[FMath::Max(y - 1, 0) * Size + x];
+            const FVector Normal = FVector::CrossProduct(DX, DY).GetSafeNormal();
+
+            const float Altitude = Length - PlanetRadius;
+            const float Height01 = FMath::Clamp(Altitude * InvMaxAltitude, 0.f, 1.f);
+            const float Temperature = FMath::Clamp(CalculateTemperature(FMath::Asin(Up.Z)) - Height01 * BiomeConfig.AltitudeTemperatureLapse, 0.f, 1.f);
+
+            Altitudes[i] = Altitude;
+            Slopes[i] = Normal.IsZero() ? 0.f : 1.f - FMath::Abs(FVector::DotProduct(Normal, Up));
+            Temperatures[i] = Temperature;
+            Humidities[i] = CalculateHumidity(Height01, Temperature);
+        }
+    }
+
+    if (!OutBlend && !BiomeConfig.bSmoothTransitions)
+    {
+        ClassifyBiomes(Altitudes, Slopes, Temperatures, Humidities, OutBiomeMap);
+        return;
+    }
+
+    // pesos suaves saem da mesma passada; o blur fica restrito ao tile
+    TArray<float> Weights;
+    Weights.SetNumUninitialized(Num * BiomeTypeCount);
+    ClassifyBiomes(Altitudes, Slopes, Temperatures, Humidities, OutBiomeMap, Weights);
+
+    if (BiomeConfig.bSmoothTransitions)
+    {
+        BlurBiomeWeights(Weights, Size, BiomeConfig.TransitionBlurRadius);
+    }
+
+    FBiomeBlendStream LocalBlend;
+    PackBiomeBlend(Weights, Num, OutBlend ? *OutBlend : LocalBlend, BiomeConfig.bSmoothTransitions ? &OutBiomeMap : nullptr);
+}
+
+void UBiomeSystem::SmoothBiomeTransitions(TArray<EBiomeType>& BiomeMap) const
+{
+    const int32 Num = BiomeMap.Num();
+    const int32 Size = FMath::RoundToInt(FMath::Sqrt(float(Num)));
+    if (Num == 0 || Size * Size != Num)
+    {
+        return;
+    }
+
+    TArray<float> Weights;
+    Weights.SetNumZeroed(Num * BiomeTypeCount);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        Weights[int32(BiomeMap[i]) * Num + i] = 1.f;
+    }
+
+    BlurBiomeWeights(Weights, Size, FMath::Max(BiomeConfig.TransitionBlurRadius, 1));
+
+    TArray<uint8> Dominant;
+    FBiomeBlendStream Unused;
+    PackBiomeBlend(Weights, Num, Unused, &Dominant);
+    FMemory::Memcpy(BiomeMap.GetData(), Dominant.GetData(), Num);
+}
+
+void UBiomeSystem::BlurBiomeWeights(TArray<float>& Weights, int32 Size, int32 Radius)
+{
+    if (Radius <= 0 || Size <= 1)
+    {
+        return;
+    }
+
+    const int32 Num = Size * Size;
+    check(Weights.Num() >= Num * BiomeTypeCount);
+
+    TArray<float> Temp;
+    Temp.SetNumUninitialized(Num);
+    const float InvTaps = 1.f / float(2 * Radius + 1);
+
+    for (int32 b = 0; b < BiomeTypeCount; ++b)
+    {
+        float* Channel = Weights.GetData() + b * Num;
+
+        // passada horizontal (borda repetida)
+        for (int32 y = 0; y < Size; ++y)
+        {
+            const float* Row = Channel + y * Size;
+            for (int32 x = 0; x < Size; ++x)
+            {
+                float Sum = 0.f;
+                for (int32 k = -Radius; k <= Radius; ++k)
+                {
+                    Sum += Row[FMath::Clamp(x + k, 0, Size - 1)];
+                }
+                Temp[y * Size + x] = Sum * InvTaps;
+            }
+        }
+
+        // passada vertical
+        for (int32 y = 0; y < Size; ++y)
+        {
+            for (int32 x = 0; x < Size; ++x)
+            {
+                float Sum = 0.f;
+                for (int32 k = -Radius; k <= Radius; ++k)
+                {
+                    Sum += Temp[FMath::Clamp(y + k, 0, Size - 1) * Size + x];
+                }
+                Channel[y * Size + x] = Sum * InvTaps;
+            }
+        }
+    }
+}
+
+void UBiomeSystem::PackBiomeBlend(const TArray<float>& Weights, int32 Num, FBiomeBlendStream& OutBlend, TArray<uint8>* OutBiomeMap)
+{
+    static_assert(BiomeTypeCount <= 8, "Biome indices are packed in 3 bits");
+
+    OutBlend.Weights.SetNumUninitialized(Num);
+    OutBlend.Indices.SetNumUninitialized(Num);
+    if (OutBiomeMap)
+    {
+        OutBiomeMap->SetNumUninitialized(Num);
+    }
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        int32 Order[BiomeTypeCount];
+        float Value[BiomeTypeCount];
+        for (int32 b = 0; b < BiomeTypeCount; ++b)
+        {
+            Order[b] = b;
+            Value[b] = Weights[b * Num + i];
+        }
+
+        // ordenação por inserção: só 5 biomas
+        for (int32 a = 1; a < BiomeTypeCount; ++a)
+        {
+            for (int32 c = a; c > 0 && Value[Order[c]] > Value[Order[c - 1]]; --c)
+            {
+                Swap(Order[c], Order[c - 1]);
+            }
+        }
+
+        const float Sum = Value[Order[0]] + Value[Order[1]] + Value[Order[2]] + Value[Order[3]];
+        const float Scale = Sum > KINDA_SMALL_NUMBER ? 255.f / Sum : 0.f;
+
+        const uint8 G = uint8(FMath::RoundToInt(Value[Order[1]] * Scale));
+        const uint8 B = uint8(FMath::RoundToInt(Value[Order[2]] * Scale));
+        const uint8 A = uint8(FMath::RoundToInt(Value[Order[3]] * Scale));
+        const uint8 R = uint8(FMath::Max(255 - G - B - A, 0));
+
+        OutBlend.Weights[i] = FColor(R, G, B, A);
+        OutBlend.Indices[i] = FVector2D(float(Order[0] + Order[1] * 8), float(Order[2] + Order[3] * 8));
+
+        if (OutBiomeMap)
+        {
+            (*OutBiomeMap)[i] = uint8(Order[0]);
+        }
+    }
+}
+
+float UBiomeSystem::CalculateTemperature(float Latitude)
+{
+    // Equador = quente, polos = frio
+    const float NormalizedLatitude = FMath::Abs(FMath::Sin(Latitude));
+    return 1.0f - NormalizedLatitude;
+}
+
+float UBiomeSystem::CalculateHumidity(float Height, float Temperature)
+{
+    // Altura baixa + temperatura alta = alta umidade
+    const float HeightFactor = 1.0f - FMath::Clamp(Height, 0.0f, 1.0f);
+    return (HeightFactor + Temperature) * 0.5f;
+}
+
+void UBiomeSystem::SetBiomeLookup(UTexture2D* NewLookup)
+{
+    BiomeLookup = NewLookup;
+    RebuildLookupTable();
+}
+
+void UBiomeSystem::RebuildLookupTable()
+{
+    check(IsInGameThread());
+
+    if (!BiomeLookup || !BiomeLookup->PlatformData || BiomeLookup->PlatformData->Mips.Num() == 0)
+    {
+        SetLookupTable(nullptr);
+        return;
+    }
+
+    FTexture2DMipMap& Mip = BiomeLookup->PlatformData->Mips[0];
+    TSharedRef<FBiomeLookupTable, ESPMode::ThreadSafe> Table = MakeShared<FBiomeLookupTable, ESPMode::ThreadSafe>();
+    Table->SizeX = Mip.SizeX;
+    Table->SizeY = Mip.SizeY;
+    Table->Cells.SetNumUninitialized(Table->SizeX * Table->SizeY);
+
+    // único lock do bulk data: a partir daqui as consultas leem só a tabela
+    const FColor* Colors = static_cast<const FColor*>(Mip.BulkData.LockReadOnly());
+    if (Colors)
+    {
+        for (int32 i = 0; i < Table->Cells.Num(); ++i)
+        {
+            Table->Cells[i] = DecodeBiomeColor(Colors[i]);
+        }
+    }
+    Mip.BulkData.Unlock();
+
+    if (!Colors || Table->Cells.Num() == 0)
+    {
+        SetLookupTable(nullptr);
+        return;
+    }
+
+    Table->Hash = HashCombine(FCrc::MemCrc32(Table->Cells.GetData(), Table->Cells.Num()), GetTypeHash(Table->SizeX));
+    SetLookupTable(Table);
+}
+
+UBiomeSystem::FLookupTableRef UBiomeSystem::GetLookupTable() const
+{
+    FReadScopeLock Lock(LookupTableLock);
+    return ActiveLookupTable;
+}
+
+void UBiomeSystem::SetLookupTable(FLookupTableRef NewTable)
+{
+    FLookupTableRef Retired;
+    {
+        FWriteScopeLock Lock(LookupTableLock);
+        Retired = MoveTemp(ActiveLookupTable);
+        ActiveLookupTable = MoveTemp(NewTable);
+    }
+    // Retired sai de escopo fora do lock: se ninguém mais a lê, a tabela antiga é liberada aqui
+}
+
+void UBiomeSystem::SetBiomeConfig(const FBiomeConfig& NewConfig)
+{
+    BiomeConfig = NewConfig;
+}
+
+uint32 UBiomeSystem::GetConfigHash() const
+{
+    uint32 Hash = GetTypeHash(BiomeConfig.DesertAltitudeThreshold);
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.MountainAltitudeThreshold));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.SnowAltitudeThreshold));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.ForestHumidityThreshold));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.PlainsSlopeThreshold));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.SnowTemperatureThreshold));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.MaxAltitude));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.AltitudeTemperatureLapse));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.bSmoothTransitions));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.TransitionWidth));
+    Hash = HashCombine(Hash, GetTypeHash(BiomeConfig.TransitionBlurRadius));
+
+    // sem tabela a classificação usa as regras acima
+    const FLookupTableRef Table = GetLookupTable();
+    return HashCombine(Hash, Table.IsValid() ? Table->Hash : 0);
+}
+
+void UBiomeSystem::PostLoad()
+{
+    Super::PostLoad();
+    RebuildLookupTable();
+}
+
+#if WITH_EDITOR
+void UBiomeSystem::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UBiomeSystem, BiomeLookup))
+    {
+        RebuildLookupTable();
+    }
 }
+#endif
@@ -0,0 +1,152 @@
+#include "Services/Environment/PoissonDiskSampler.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+    /** Distância ao quadrado no toro unitário */
+    float ToroidalDistSquared(const FVector2D& A, const FVector2D& B)
+    {
+        float DX = FMath::Abs(A.X - B.X);
+        float DY = FMath::Abs(A.Y - B.Y);
+        DX = FMath::Min(DX, 1.0f - DX);
+        DY = FMath::Min(DY, 1.0f - DY);
+        return DX * DX + DY * DY;
+    }
+}
+
+const FPoissonDiskTile& FPoissonDiskSampler::GetTile()
+{
+    // inicialização de static local é thread-safe
+    static const FPoissonDiskTile Tile = []()
+    {
+        FPoissonDiskTile Result;
+        BuildTile(0x5EED0000u, Result);
+        return Result;
+    }();
+    return Tile;
+}
+
+uint32 FPoissonDiskSampler::HashCell(int32 X, int32 Y, uint32 Seed)
+{
+    uint32 H = Seed ^ (uint32(X) * 0x8DA6B343u) ^ (uint32(Y) * 0xD8163841u);
+    H ^= H >> 16;
+    H *= 0x7FEB352Du;
+    H ^= H >> 15;
+    H *= 0x846CA68Bu;
+    H ^= H >> 16;
+    return H;
+}
+
+void FPoissonDiskSampler::BuildTile(uint32 Seed, FPoissonDiskTile& OutTile)
+{
+    FRandomStream Stream(Seed);
+    const float Radius = TileRadius;
+    const float RadiusSq = Radius * Radius;
+    // célula com diagonal <= raio: no máximo uma amostra por célula
+    const int32 GridSize = FMath::CeilToInt(UE_SQRT_2 / Radius);
+    const float CellSize = 1.0f / GridSize;
+
+    // Bridson no toro: grade de aceleração com uma amostra por célula
+    TArray<int32> Grid;
+    Grid.Init(INDEX_NONE, GridSize * GridSize);
+    TArray<FVector2D> Points;
+    TArray<int32> Active;
+
+    auto CellOf = [&](const FVector2D& P)
+    {
+        return FIntPoint(FMath::Min(int32(P.X * GridSize), GridSize - 1), FMath::Min(int32(P.Y * GridSize), GridSize - 1));
+    };
+
+    auto IsFarEnough = [&](const FVector2D& P)
+    {
+        const FIntPoint Cell = CellOf(P);
+        for (int32 DY = -2; DY <= 2; ++DY)
+        {
+            for (int32 DX = -2; DX <= 2; ++DX)
+            {
+                const int32 CX = (Cell.X + DX + GridSize) % GridSize;
+                const int32 CY = (Cell.Y + DY + GridSize) % GridSize;
+                const int32 Other = Grid[CY * GridSize + CX];
+                if (Other != INDEX_NONE && ToroidalDistSquared(P, Points[Other]) < RadiusSq)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    auto AddPoint = [&](const FVector2D& P)
+    {
+        const FIntPoint Cell = CellOf(P);
+        Grid[Cell.Y * GridSize + Cell.X] = Points.Num();
+        Active.Add(Points.Num());
+        Points.Add(P);
+    };
+
+    AddPoint(FVector2D(Stream.FRand(), Stream.FRand()));
+
+    constexpr int32 MaxAttempts = 30;
+    while (Active.Num() > 0)
+    {
+        const int32 ActiveIndex = Stream.RandHelper(Active.Num());
+        const FVector2D Origin = Points[Active[ActiveIndex]];
+
+        bool bFound = false;
+        for (int32 Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+        {
+            const float Angle = Stream.FRand() * UE_TWO_PI;
+            const float Dist = Radius * (1.0f + Stream.FRand());
+            FVector2D Candidate = Origin + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Dist;
+            Candidate.X -= FMath::FloorToFloat(Candidate.X);
+            Candidate.Y -= FMath::FloorToFloat(Candidate.Y);
+
+            if (IsFarEnough(Candidate))
+            {
+                AddPoint(Candidate);
+                bFound = true;
+                break;
+            }
+        }
+
+        if (!bFound)
+        {
+            Active.RemoveAtSwap(ActiveIndex);
+        }
+    }
+
+    // ordem progressiva: a cada passo escolhe a amostra mais distante das já escolhidas
+    const int32 Num = Points.Num();
+    TArray<float> MinDistSq;
+    MinDistSq.Init(MAX_flt, Num);
+    TArray<bool> Taken;
+    Taken.Init(false, Num);
+
+    OutTile.Points.Reset(Num);
+    OutTile.Ranks.Reset(Num);
+
+    int32 Next = 0;
+    for (int32 Order = 0; Order < Num; ++Order)
+    {
+        Taken[Next] = true;
+        OutTile.Points.Add(Points[Next]);
+        OutTile.Ranks.Add(float(Order) / float(Num));
+
+        int32 Farthest = INDEX_NONE;
+        float FarthestDistSq = -1.0f;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            if (Taken[i])
+            {
+                continue;
+            }
+            MinDistSq[i] = FMath::Min(MinDistSq[i], ToroidalDistSquared(Points[i], Points[Next]));
+            if (MinDistSq[i] > FarthestDistSq)
+            {
+                FarthestDistSq = MinDistSq[i];
+                Farthest = i;
+            }
+        }
+        Next = Farthest;
+    }
+}
@@ -1,15 +1,382 @@
 #include "Services/Environment/VegetationSystem.h"
 #include "Services/Environment/BiomeSystem.h"
+#include "Services/Environment/PoissonDiskSampler.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Async/Async.h"
 #include "Math/UnrealMathUtility.h"
 
-void UVegetationSystem::Populate(const TArray<FVector>& Vertices, const TArray<int32>& Indices, EBiomeType Biome, uint32 Seed)
+UVegetationSystem::UVegetationSystem()
 {
-    if (!HISM) return;
-    FRandomStream Stream(Seed ^ 0xA5A5A5A5);
-    HISM->ClearInstances();
-    float Density = (Biome==EBiomeType::Forest ? 0.02f : 0.005f);
+    BiomeDensity.Add(EBiomeType::Desert, 0.05f);
+    BiomeDensity.Add(EBiomeType::Plains, 0.3f);
+    BiomeDensity.Add(EBiomeType::Mountains, 0.1f);
+    BiomeDensity.Add(EBiomeType::Forest, 1.0f);
+    BiomeDensity.Add(EBiomeType::Snow, 0.02f);
+}
+
+FVegetationPlacementSettings UVegetationSystem::GetPlacementSettings(EVegetationTier Tier) const
+{
+    FVegetationPlacementSettings Settings;
+    Settings.SampleSpacing = FMath::Max(SampleSpacing, 1.0f);
+    Settings.DensityScale = Tier == EVegetationTier::Dense ? 1.0f
+                          : Tier == EVegetationTier::Sparse ? FMath::Clamp(SparseDensityScale, 0.0f, 1.0f) : 0.0f;
+    for (const TPair<EBiomeType, float>& Pair : BiomeDensity)
+    {
+        Settings.BiomeDensity[int32(Pair.Key)] = FMath::Clamp(Pair.Value, 0.0f, 1.0f);
+    }
+    return Settings;
+}
+
+void UVegetationSystem::BuildInstances(const FVegetationPlacementSettings& Settings, const TArray<FVector>& Vertices,
+                                       const TArray<uint8>& BiomeMap, const FVegetationPatchRegion& Region,
+                                       TArray<FPackedVegetationInstance>& OutInstances, FBox& OutBounds)
+{
+    OutInstances.Reset();
+    OutBounds = FBox(Vertices);
+
+    const int32 Size = FMath::RoundToInt(FMath::Sqrt(float(Vertices.Num())));
+    if (Size < 2 || Size * Size != Vertices.Num())
+    {
+        return;
+    }
+    const int32 Res = Size - 1;
+    const bool bHasBiomes = BiomeMap.Num() == Vertices.Num();
+
+    // janela do patch no ladrilho da face, em unidades de tile: a escala é a mesma para todos os patches
+    const float TilesPerUV = Region.FaceWorldSize * FPoissonDiskSampler::TileRadius / Settings.SampleSpacing;
+    const FVector2D Origin = Region.UVMin * TilesPerUV;
+    const float ExtentX = (Region.UVMax.X - Region.UVMin.X) * TilesPerUV;
+    const float ExtentY = (Region.UVMax.Y - Region.UVMin.Y) * TilesPerUV;
+    if (ExtentX <= 0.0f || ExtentY <= 0.0f)
+    {
+        return;
+    }
+
+    const FVector BoundsSize = OutBounds.GetSize().ComponentMax(FVector(KINDA_SMALL_NUMBER));
+
+    FPoissonDiskSampler::ForEachSample(Origin, ExtentX, ExtentY, Region.Seed ^ 0xA5A5A5A5,
+        [&](const FVector2D& Sample, float Rank, uint32 SampleHash)
+        {
+            const float GX = Sample.X / ExtentX * Res;
+            const float GY = Sample.Y / ExtentY * Res;
+            const int32 X0 = FMath::Min(FMath::FloorToInt(GX), Res - 1);
+            const int32 Y0 = FMath::Min(FMath::FloorToInt(GY), Res - 1);
+            const float FX = GX - X0;
+            const float FY = GY - Y0;
+
+            const int32 Nearest = FMath::RoundToInt(GY) * Size + FMath::RoundToInt(GX);
+            const uint8 Biome = bHasBiomes ? BiomeMap[Nearest] : uint8(EBiomeType::Plains);
+            if (Rank >= Settings.BiomeDensity[Biome] * Settings.DensityScale)
+            {
+                return;
+            }
+
+            const int32 I00 = Y0 * Size + X0;
+            const FVector Position = FMath::Lerp(
+                FMath::Lerp(Vertices[I00], Vertices[I00 + 1], FX),
+                FMath::Lerp(Vertices[I00 + Size], Vertices[I00 + Size + 1], FX), FY);
+
+            // yaw e escala derivados do hash da amostra
+            const float Yaw = float(SampleHash & 0xFFFF) / 65535.0f * UE_TWO_PI;
+            const float Scale = 0.8f + 0.4f * float(SampleHash >> 16) / 65535.0f;
+            const FVector Local = (Position - OutBounds.Min) / BoundsSize;
+
+            OutInstances.Add(FPackedVegetationInstance::Pack(FPackedVegetationInstance::MakeTypeIndex(Biome, 0), Local, Yaw, Scale));
+        });
+}
+
+EVegetationTier UVegetationSystem::ComputeTier(int32 Level, float ViewerDistance) const
+{
+    if (ViewerDistance <= DenseDistance && Level >= DenseMinLevel)
+    {
+        return EVegetationTier::Dense;
+    }
+    if (ViewerDistance <= SparseDistance && Level >= SparseMinLevel)
+    {
+        return EVegetationTier::Sparse;
+    }
+    return EVegetationTier::None;
+}
+
+void UVegetationSystem::UpdatePatch(uint64 PatchId, int32 Level, float ViewerDistance,
+                                    const TArray<FVector>& Vertices, const TArray<uint8>& BiomeMap, const FVegetationPatchRegion& Region)
+{
+    const EVegetationTier Tier = ComputeTier(Level, ViewerDistance);
+    if (Tier == GetPatchTier(PatchId))
+    {
+        return;
+    }
+
+    if (Tier == EVegetationTier::None)
+    {
+        RemovePatch(PatchId);
+        return;
+    }
+
+    // troca de tier: as instâncias antigas ficam visíveis até o commit das novas (sem buraco no meio)
+    PopulateAsync(PatchId, Tier, Vertices, BiomeMap, Region);
+}
+
+void UVegetationSystem::DecodeInstances(TArrayView<const FPackedVegetationInstance> Instances, const FBox& Bounds, TArray<FTransform>& OutTransforms)
+{
+    const FVector Origin = Bounds.Min;
+    const FVector Size = Bounds.GetSize();
+
+    OutTransforms.SetNumUninitialized(Instances.Num());
+    for (int32 i = 0; i < Instances.Num(); ++i)
+    {
+        const FPackedVegetationInstance& Packed = Instances[i];
+        const FVector Position = Origin + Packed.GetLocalPosition() * Size;
+
+        // alinhado à normal da esfera, yaw em torno dela
+        const FVector Up = Position.GetSafeNormal();
+        const FQuat Rotation = FQuat(Up, Packed.GetYawRadians()) * FRotationMatrix::MakeFromZ(Up).ToQuat();
+
+        OutTransforms[i] = FTransform(Rotation, Position, FVector(Packed.GetScale()));
+    }
+}
+
+void UVegetationSystem::PopulateAsync(uint64 PatchId, EVegetationTier Tier, const TArray<FVector>& Vertices, const TArray<uint8>& BiomeMap,
+                                      const FVegetationPatchRegion& Region)
+{
+    check(IsInGameThread());
+    if (!HISM || Tier == EVegetationTier::None || GetPatchTier(PatchId) == Tier) return;
+
+    // um pedido anterior ainda em voo é substituído pelo serial novo; as instâncias aplicadas ficam
+    const uint32 Serial = NextSerial++;
+    InFlight.Add(PatchId, { Serial, Tier, Region });
+
+    Async(EAsyncExecution::ThreadPool,
+        [Queue = CompletedQueue, Settings = GetPlacementSettings(Tier), PatchId, Serial, Tier, Vertices, BiomeMap, Region]()
+        {
+            FVegetationPatchBuffer Buffer;
+            Buffer.PatchId = PatchId;
+            Buffer.Serial = Serial;
+            Buffer.Tier = Tier;
+            BuildInstances(Settings, Vertices, BiomeMap, Region, Buffer.Instances, Buffer.Bounds);
+            Queue->Enqueue(MoveTemp(Buffer));
+        });
+}
+
+int32 UVegetationSystem::CommitPendingPatches(int32 MaxPatches)
+{
+    check(IsInGameThread());
+
+    int32 Committed = 0;
+    FVegetationPatchBuffer Buffer;
+    while (Committed < MaxPatches && CompletedQueue->Dequeue(Buffer))
+    {
+        // patch removido ou re-solicitado enquanto a tarefa rodava
+        const FInFlightPatch* Request = InFlight.Find(Buffer.PatchId);
+        if (!Request || Request->Serial != Buffer.Serial)
+        {
+            continue;
+        }
+        const FVegetationPatchRegion Region = Request->Region;
+        InFlight.Remove(Buffer.PatchId);
+
+        // troca no mesmo frame: as instâncias do tier anterior saem junto com a entrada das novas
+        RemoveCommittedInstances(Buffer.PatchId);
+
+        const int32 Layer = GetLayerForTier(Buffer.Tier);
+        UHierarchicalInstancedStaticMeshComponent* Component = GetLayerComponent(Layer);
+        if (!Component)
+        {
+            continue;
+        }
+
+        FCommittedPatch& Patch = CommittedPatches.Add(Buffer.PatchId);
+        Patch.Tier = Buffer.Tier;
+        Patch.Layer = Layer;
+        Patch.Region = Region;
+
+        if (Buffer.Instances.Num() > 0)
+        {
+            TArray<FInstanceOwner>& Owners = Layers[Layer].InstanceOwners;
+            const int32 First = Owners.Num();
+            DecodeInstances(Buffer.Instances, Buffer.Bounds, DecodeScratch);
+            Component->AddInstances(DecodeScratch, false);
+
+            Patch.Slots.Reserve(Buffer.Instances.Num());
+            for (int32 i = 0; i < Buffer.Instances.Num(); ++i)
+            {
+                Patch.Slots.Add(First + i);
+                Owners.Add({ Buffer.PatchId, i });
+            }
+        }
+        ++Committed;
+    }
 
-    for(const FVector& V : Vertices)
-        if (Stream.FRand() < Density)
-            HISM->AddInstance(FTransform(V.Rotation(), V, FVector(1.f)));
+    // patches que saíram da árvore somem no mesmo frame em que quem os cobre aparece
+    if (Committed > 0 && RetainedPatches.Num() > 0)
+    {
+        ReleaseRetainedPatches();
+    }
+    return Committed;
+}
+
+void UVegetationSystem::RemovePatch(uint64 PatchId)
+{
+    check(IsInGameThread());
+    InFlight.Remove(PatchId);
+    RetainedPatches.Remove(PatchId);
+    RemoveCommittedInstances(PatchId);
+}
+
+void UVegetationSystem::RemoveCommittedInstances(uint64 PatchId)
+{
+    FCommittedPatch Patch;
+    if (!CommittedPatches.RemoveAndCopyValue(PatchId, Patch) || Patch.Slots.Num() == 0)
+    {
+        return;
+    }
+
+    UHierarchicalInstancedStaticMeshComponent* Component = GetLayerComponent(Patch.Layer);
+    if (!Component)
+    {
+        return;
+    }
+
+    // o HISM remove em ordem decrescente trocando com a última instância; replicamos para manter os índices
+    TArray<int32>& Slots = Patch.Slots;
+    TArray<FInstanceOwner>& Owners = Layers[Patch.Layer].InstanceOwners;
+    Slots.Sort(TGreater<int32>());
+    Component->RemoveInstances(Slots);
+
+    // em ordem decrescente a última instância nunca é deste patch (já saiu), então sempre tem outro dono
+    for (int32 Slot : Slots)
+    {
+        const int32 Last = Owners.Num() - 1;
+        if (Slot != Last)
+        {
+            const FInstanceOwner& MovedOwner = Owners[Last];
+            if (FCommittedPatch* Moved = CommittedPatches.Find(MovedOwner.PatchId))
+            {
+                Moved->Slots[MovedOwner.SlotIndex] = Slot;
+            }
+        }
+        Owners.RemoveAtSwap(Slot, 1, false);
+    }
+}
+
+void UVegetationSystem::PruneStalePatches(const TSet<uint64>& ActivePatches)
+{
+    // voltou para a árvore (ex.: merge logo depois do split) antes de ser substituído
+    for (auto It = RetainedPatches.CreateIterator(); It; ++It)
+    {
+        if (ActivePatches.Contains(*It))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    // pedidos de patches que saíram são cancelados; as instâncias aplicadas ficam retidas
+    for (auto It = InFlight.CreateIterator(); It; ++It)
+    {
+        if (!ActivePatches.Contains(It.Key()))
+        {
+            It.RemoveCurrent();
+        }
+    }
+    for (const TPair<uint64, FCommittedPatch>& Pair : CommittedPatches)
+    {
+        if (!ActivePatches.Contains(Pair.Key))
+        {
+            RetainedPatches.Add(Pair.Key);
+        }
+    }
+
+    ReleaseRetainedPatches();
+}
+
+void UVegetationSystem::ReleaseRetainedPatches()
+{
+    for (auto It = RetainedPatches.CreateIterator(); It; ++It)
+    {
+        const FCommittedPatch* Patch = CommittedPatches.Find(*It);
+        bool bCovered = false;
+        if (Patch)
+        {
+            for (const TPair<uint64, FInFlightPatch>& Pair : InFlight)
+            {
+                if (RegionsOverlap(Patch->Region, Pair.Value.Region))
+                {
+                    bCovered = true;
+                    break;
+                }
+            }
+        }
+
+        if (!bCovered)
+        {
+            RemoveCommittedInstances(*It);
+            It.RemoveCurrent();
+        }
+    }
+}
+
+bool UVegetationSystem::RegionsOverlap(const FVegetationPatchRegion& A, const FVegetationPatchRegion& B)
+{
+    if (A.Seed != B.Seed)
+    {
+        return false;
+    }
+
+    // regiões podem vir invertidas (UVMax < UVMin)
+    const FBox2D BoxA(FVector2D::Min(A.UVMin, A.UVMax), FVector2D::Max(A.UVMin, A.UVMax));
+    const FBox2D BoxB(FVector2D::Min(B.UVMin, B.UVMax), FVector2D::Max(B.UVMin, B.UVMax));
+    return BoxA.Min.X < BoxB.Max.X && BoxB.Min.X < BoxA.Max.X && BoxA.Min.Y < BoxB.Max.Y && BoxB.Min.Y < BoxA.Max.Y;
+}
+
+void UVegetationSystem::ClearAllPatches()
+{
+    check(IsInGameThread());
+    InFlight.Empty();
+    CommittedPatches.Empty();
+    RetainedPatches.Empty();
+    CompletedQueue->Empty();
+
+    for (int32 Layer = 0; Layer < UE_ARRAY_COUNT(Layers); ++Layer)
+    {
+        Layers[Layer].InstanceOwners.Empty();
+        if (UHierarchicalInstancedStaticMeshComponent* Component = GetLayerComponent(Layer))
+        {
+            Component->ClearInstances();
+        }
+    }
+}
+
+bool UVegetationSystem::HasPatch(uint64 PatchId) const
+{
+    return InFlight.Contains(PatchId) || CommittedPatches.Contains(PatchId);
+}
+
+EVegetationTier UVegetationSystem::GetPatchTier(uint64 PatchId) const
+{
+    if (const FInFlightPatch* Request = InFlight.Find(PatchId))
+    {
+        return Request->Tier;
+    }
+    if (const FCommittedPatch* Patch = CommittedPatches.Find(PatchId))
+    {
+        return Patch->Tier;
+    }
+    return EVegetationTier::None;
+}
+
+UHierarchicalInstancedStaticMeshComponent* UVegetationSystem::GetLayerComponent(int32 Layer) const
+{
+    return Layer == 1 ? ImpostorHISM : HISM;
+}
+
+int32 UVegetationSystem::GetLayerForTier(EVegetationTier Tier) const
+{
+    return (Tier == EVegetationTier::Sparse && ImpostorHISM) ? 1 : 0;
+}
+
+void UVegetationSystem::BeginDestroy()
+{
+    // tarefas em voo seguram a fila, não o UObject
+    InFlight.Empty();
+    Super::BeginDestroy();
 }
@@ -1,12 +1,208 @@
 #include "Services/Environment/WaterComponent.h"
+#include "Generation/Terrain/PatchNode.h"
 #include "ProceduralMeshComponent.h"
 
-void UWaterComponent::GenerateOcean(UProceduralMeshComponent* MeshComp, float PlanetRadius)
+void UWaterComponent::BuildSurfacePatch(const FVector2D& UVMin, const FVector2D& UVMax, int32 Res, float Radius,
+                                        TArray<FVector>& OutVertices, TArray<FVector>& OutNormals)
 {
-    TArray<FVector> V; TArray<int32> I;
-    float R = PlanetRadius + SeaLevel;
-    // exemplo simplificado: um triângulo por face
-    V.Add(FVector(0, R, 0)); V.Add(FVector(R, 0, 0)); V.Add(FVector(0, 0, R));
-    I = {0,1,2};
-    MeshComp->CreateMeshSection(99, V, I, {}, {}, {}, {}, false);
+    OutVertices.Reset((Res + 1) * (Res + 1));
+    OutNormals.Reset((Res + 1) * (Res + 1));
+
+    for (int32 y=0; y<=Res; ++y)
+    {
+        float v = FMath::Lerp(UVMin.Y, UVMax.Y, float(y)/Res);
+        for (int32 x=0; x<=Res; ++x)
+        {
+            float u = FMath::Lerp(UVMin.X, UVMax.X, float(x)/Res);
+            FVector Dir((u-0.5f)*2.f, (v-0.5f)*2.f, 1.f);
+            Dir.Normalize();
+            OutVertices.Add(Dir * Radius);
+            OutNormals.Add(Dir);
+        }
+    }
+}
+
+const TArray<int32>& UWaterComponent::GetGridIndices(int32 Res)
+{
+    if (const TArray<int32>* Cached = GridIndexCache.Find(Res))
+    {
+        return *Cached;
+    }
+
+    // mesma ordem de índices dos patches de terreno
+    TArray<int32>& Indices = GridIndexCache.Add(Res);
+    Indices.Reserve(Res * Res * 6);
+    for (int32 y=0; y<Res; ++y)
+        for (int32 x=0; x<Res; ++x)
+        {
+            int i0=y*(Res+1)+x, i1=i0+1, i2=i0+Res+1, i3=i2+1;
+            Indices.Append({i0,i2,i1, i1,i2,i3});
+        }
+    return Indices;
+}
+
+int32 UWaterComponent::GenerateOcean(UProceduralMeshComponent* MeshComp, float PlanetRadius,
+                                     const TArray<FPatchNode*>& Patches, int32 FirstSection)
+{
+    if (!MeshComp) return 0;
+
+    const int32 PreviousSections = FirstOceanSection == FirstSection ? NumOceanSections : 0;
+    if (FirstOceanSection != FirstSection)
+    {
+        ClearOcean(MeshComp);
+    }
+    FirstOceanSection = FirstSection;
+
+    const float R = PlanetRadius + SeaLevel;
+    TArray<FVector> Vertices, Normals;
+    int32 Section = 0;
+
+    for (const FPatchNode* Patch : Patches)
+    {
+        // patch inteiro acima do nível do mar: nenhuma água, nenhum custo
+        if (!Patch || Patch->Resolution <= 0 || !NeedsOcean(Patch->MinAltitude))
+        {
+            continue;
+        }
+
+        BuildSurfacePatch(Patch->UVMin, Patch->UVMax, Patch->Resolution, R, Vertices, Normals);
+        const int32 SectionIndex = FirstSection + Section++;
+        MeshComp->CreateMeshSection(SectionIndex, Vertices, GetGridIndices(Patch->Resolution), Normals, {}, {}, {}, false);
+        if (OceanMaterial)
+        {
+            MeshComp->SetMaterial(SectionIndex, OceanMaterial);
+        }
+    }
+
+    // seções de oceano que deixaram de existir
+    for (int32 i = Section; i < PreviousSections; ++i)
+    {
+        MeshComp->ClearMeshSection(FirstSection + i);
+    }
+
+    NumOceanSections = Section;
+    return Section;
+}
+
+void UWaterComponent::ClearOcean(UProceduralMeshComponent* MeshComp)
+{
+    if (MeshComp && FirstOceanSection != INDEX_NONE)
+    {
+        for (int32 i = 0; i < NumOceanSections; ++i)
+        {
+            MeshComp->ClearMeshSection(FirstOceanSection + i);
+        }
+    }
+    FirstOceanSection = INDEX_NONE;
+    NumOceanSections = 0;
+}
+
+void UWaterComponent::GenerateOceanSystem(const FPlanetChunk& Chunk, float ChunkSize, FOceanSystem& OutOceanSystem)
+{
+    OutOceanSystem.SurfaceVertices.Reset();
+
+    const int32 Resolution = FMath::RoundToInt(FMath::Sqrt(float(Chunk.HeightMap.Num())));
+    if (Resolution < 2 || Resolution * Resolution != Chunk.HeightMap.Num())
+    {
+        return;
+    }
+
+    float MinHeight = MAX_flt;
+    for (float Height : Chunk.HeightMap)
+    {
+        MinHeight = FMath::Min(MinHeight, Height);
+    }
+    if (!NeedsOcean(MinHeight))
+    {
+        return;
+    }
+
+    // mesma grade do mapa de altura (ver UPlanetTerrainGenerator::GenerateHeightMap), no nível do mar
+    const float StepSize = ChunkSize / (Resolution - 1);
+    OutOceanSystem.SurfaceVertices.Reserve(Resolution * Resolution);
+    for (int32 Y = 0; Y < Resolution; ++Y)
+    {
+        for (int32 X = 0; X < Resolution; ++X)
+        {
+            OutOceanSystem.SurfaceVertices.Add(Chunk.Center + FVector(
+                (X - Resolution / 2.0f) * StepSize,
+                (Y - Resolution / 2.0f) * StepSize,
+                SeaLevel));
+        }
+    }
+}
+
+void UWaterComponent::GenerateRiverSystem(const FPlanetChunk& Chunk, float ChunkSize, FRiverSystem& OutRiverSystem)
+{
+    OutRiverSystem.RiverPoints.Reset();
+
+    const int32 Resolution = FMath::RoundToInt(FMath::Sqrt(float(Chunk.HeightMap.Num())));
+    if (Resolution < 2 || Resolution * Resolution != Chunk.HeightMap.Num() || ChunkSize <= 0.f)
+    {
+        return;
+    }
+
+    // a coordenada do tile vem do centro do chunk; o nível de LOD separa as camadas (um chunk por LOD
+    // no mesmo lugar não soma vazão duas vezes) e a rede reamostra todos para o mesmo lado
+    FRiverNetworkBuilder::FTileInput Tile;
+    Tile.Coord = FIntPoint(FMath::RoundToInt(Chunk.Center.X / ChunkSize), FMath::RoundToInt(Chunk.Center.Y / ChunkSize));
+    Tile.Layer = Chunk.LODLevel;
+    Tile.Size = Resolution;
+    Tile.Heights = Chunk.HeightMap;
+
+    // mesma grade do mapa de altura (ver UPlanetTerrainGenerator::GenerateHeightMap)
+    const float StepSize = ChunkSize / (Resolution - 1);
+    Tile.Positions.Reserve(Resolution * Resolution);
+    for (int32 Y = 0; Y < Resolution; ++Y)
+    {
+        for (int32 X = 0; X < Resolution; ++X)
+        {
+            Tile.Positions.Add(Chunk.Center + FVector(
+                (X - Resolution / 2.0f) * StepSize,
+                (Y - Resolution / 2.0f) * StepSize,
+                Chunk.HeightMap[Y * Resolution + X]));
+        }
+    }
+
+    const FIntPoint Coord = Tile.Coord;
+    RiverNetwork.SetTile(MoveTemp(Tile));
+    TouchRiverTile(Coord, Chunk.LODLevel);
+    RiverNetwork.Build();
+
+    // só as polylines que começam neste chunk; a vazão dos vizinhos já está incluída
+    RiverNetwork.ExtractRivers(Coord, Chunk.LODLevel, RiverAccumulationThreshold, OutRiverSystem.RiverPoints);
+}
+
+void UWaterComponent::ReleaseRiverChunk(const FPlanetChunk& Chunk, float ChunkSize)
+{
+    if (ChunkSize <= 0.f)
+    {
+        return;
+    }
+
+    const FIntPoint Coord(FMath::RoundToInt(Chunk.Center.X / ChunkSize), FMath::RoundToInt(Chunk.Center.Y / ChunkSize));
+    RiverNetwork.RemoveTile(Coord, Chunk.LODLevel);
+    RiverTileUse.Remove(FIntVector(Coord.X, Coord.Y, Chunk.LODLevel));
+}
+
+void UWaterComponent::TouchRiverTile(const FIntPoint& Coord, int32 Layer)
+{
+    RiverTileUse.Add(FIntVector(Coord.X, Coord.Y, Layer), ++RiverTileClock);
+
+    // chunks que ninguém liberou: sai o tile tocado há mais tempo
+    while (RiverTileUse.Num() > FMath::Max(MaxRiverTiles, 1))
+    {
+        FIntVector Oldest = FIntVector::ZeroValue;
+        uint64 OldestUse = MAX_uint64;
+        for (const TPair<FIntVector, uint64>& Pair : RiverTileUse)
+        {
+            if (Pair.Value < OldestUse)
+            {
+                OldestUse = Pair.Value;
+                Oldest = Pair.Key;
+            }
+        }
+        RiverNetwork.RemoveTile(FIntPoint(Oldest.X, Oldest.Y), Oldest.Z);
+        RiverTileUse.Remove(Oldest);
+    }
 }
@@ -0,0 +1,513 @@
+#include "Services/Terrain/ErosionDeltaCache.h"
+#include "Debug/Logging/PlanetSystemLogger.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+namespace ErosionDeltaCacheFormat
+{
+    static constexpr uint32 Magic = 0x44455350; // "PSED"
+    static constexpr uint32 Version = 2;
+
+    /** Abaixo disso o espaço morto nunca força reescrita */
+    static constexpr int64 MinRewriteBytes = 4 * 1024 * 1024;
+
+    // Layout: cabeçalho, blocos de payloads, índice, rodapé. Cada Flush acrescenta um bloco,
+    // um índice completo e um rodapé novo; só o último rodapé vale.
+    struct FHeader
+    {
+        uint32 Magic;
+        uint32 Version;
+        uint32 ConfigHash;
+        uint32 Padding;
+    };
+
+    struct FIndexRecord
+    {
+        uint64 Key;
+        int64 Offset;
+        int32 CompressedSize;
+        int32 NumDeltas;
+        float Scale;
+        int32 Padding;
+    };
+
+    struct FFooter
+    {
+        int64 IndexOffset;
+        uint32 NumEntries;
+        uint32 Magic;
+    };
+}
+
+void FErosionDeltaCache::FQuantizedDeltas::Dequantize(TArray<float>& OutDeltas) const
+{
+    OutDeltas.SetNumUninitialized(Values.Num());
+    for (int32 i = 0; i < Values.Num(); ++i)
+    {
+        OutDeltas[i] = Values[i] * Scale;
+    }
+}
+
+FErosionDeltaCache::FErosionDeltaCache(const FString& InFilePath, uint32 InConfigHash, int64 InMaxBytes)
+    : FilePath(InFilePath), ConfigHash(InConfigHash), MaxBytes(InMaxBytes)
+{
+}
+
+FErosionDeltaCache::~FErosionDeltaCache()
+{
+    Flush();
+    CloseMapping();
+}
+
+bool FErosionDeltaCache::Open()
+{
+    using namespace ErosionDeltaCacheFormat;
+
+    FScopeLock Lock(&Mutex);
+    CloseMapping();
+    Entries.Empty();
+    LiveBytes = 0;
+    bDirty = false;
+    bNeedsRewrite = false;
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.FileExists(*FilePath))
+    {
+        return false;
+    }
+
+    if (!MapFile() || FileSize < int64(sizeof(FHeader) + sizeof(FFooter)))
+    {
+        CloseMapping();
+        return false;
+    }
+
+    const uint8* Data = MappedRegion->GetMappedPtr();
+
+    FHeader Header;
+    FMemory::Memcpy(&Header, Data, sizeof(Header));
+
+    FFooter Footer;
+    FMemory::Memcpy(&Footer, Data + FileSize - sizeof(FFooter), sizeof(Footer));
+
+    const int64 IndexEnd = Footer.IndexOffset + int64(Footer.NumEntries) * int64(sizeof(FIndexRecord));
+    if (Header.Magic != Magic || Header.Version != Version || Footer.Magic != Magic
+        || Footer.IndexOffset < int64(sizeof(FHeader)) || IndexEnd != FileSize - int64(sizeof(FFooter)))
+    {
+        UPlanetSystemLogger::LogWarning(TEXT("ErosionDeltaCache"), TEXT("Invalid cache file, discarding"));
+        CloseMapping();
+        PlatformFile.DeleteFile(*FilePath);
+        return false;
+    }
+
+    // Configuração de erosão mudou: os deltas gravados não valem mais
+    if (Header.ConfigHash != ConfigHash)
+    {
+        UPlanetSystemLogger::LogInfo(TEXT("ErosionDeltaCache"), TEXT("Erosion config changed, cache invalidated"));
+        CloseMapping();
+        PlatformFile.DeleteFile(*FilePath);
+        return false;
+    }
+
+    Entries.Reserve(Footer.NumEntries);
+    for (uint32 i = 0; i < Footer.NumEntries; ++i)
+    {
+        FIndexRecord Record;
+        FMemory::Memcpy(&Record, Data + Footer.IndexOffset + i * sizeof(FIndexRecord), sizeof(Record));
+
+        if (Record.Offset < int64(sizeof(FHeader)) || Record.CompressedSize <= 0 || Record.Offset + Record.CompressedSize > Footer.IndexOffset)
+        {
+            continue;
+        }
+
+        FEntry& Entry = Entries.Add(Record.Key);
+        Entry.Offset = Record.Offset;
+        Entry.CompressedSize = Record.CompressedSize;
+        Entry.NumDeltas = Record.NumDeltas;
+        Entry.Scale = Record.Scale;
+        LiveBytes += Record.CompressedSize;
+    }
+
+    // limite reduzido desde a última execução
+    PruneToBudget(MaxBytes);
+
+    UPlanetSystemLogger::LogInfo(TEXT("ErosionDeltaCache"),
+        FString::Printf(TEXT("Mapped %d erosion entries from %s"), Entries.Num(), *FilePath));
+    return true;
+}
+
+bool FErosionDeltaCache::Find(uint64 Key, int32 NumVertices, TArray<float>& OutDeltas) const
+{
+    FScopeLock Lock(&Mutex);
+
+    const FEntry* Entry = Entries.Find(Key);
+    if (!Entry || Entry->NumDeltas != NumVertices)
+    {
+        Misses++;
+        return false;
+    }
+
+    const uint8* Payload = GetPayload(*Entry);
+    FQuantizedDeltas Quantized;
+    Quantized.Values.SetNumUninitialized(Entry->NumDeltas);
+    Quantized.Scale = Entry->Scale;
+
+    if (!Payload || !FCompression::UncompressMemory(NAME_Zlib, Quantized.Values.GetData(), Quantized.Values.Num() * sizeof(int16),
+                                                    Payload, Entry->CompressedSize))
+    {
+        Misses++;
+        return false;
+    }
+
+    Quantized.Dequantize(OutDeltas);
+    Entry->LastUse = ++UseClock;
+
+    Hits++;
+    return true;
+}
+
+FErosionDeltaCache::FQuantizedDeltas FErosionDeltaCache::Quantize(const TArray<float>& Deltas)
+{
+    float MaxAbs = 0.0f;
+    for (float D : Deltas)
+    {
+        MaxAbs = FMath::Max(MaxAbs, FMath::Abs(D));
+    }
+
+    FQuantizedDeltas Quantized;
+    Quantized.Scale = MaxAbs > 0.0f ? MaxAbs / float(MAX_int16) : 0.0f;
+    const float InvScale = Quantized.Scale > 0.0f ? 1.0f / Quantized.Scale : 0.0f;
+
+    Quantized.Values.SetNumUninitialized(Deltas.Num());
+    for (int32 i = 0; i < Deltas.Num(); ++i)
+    {
+        Quantized.Values[i] = int16(FMath::Clamp(FMath::RoundToInt(Deltas[i] * InvScale), -int32(MAX_int16), int32(MAX_int16)));
+    }
+    return Quantized;
+}
+
+void FErosionDeltaCache::Store(uint64 Key, const FQuantizedDeltas& Deltas)
+{
+    if (Deltas.Values.Num() == 0)
+    {
+        return;
+    }
+
+    const int32 RawSize = Deltas.Values.Num() * sizeof(int16);
+    int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, RawSize);
+    TArray<uint8> Compressed;
+    Compressed.SetNumUninitialized(CompressedSize);
+
+    if (!FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, Deltas.Values.GetData(), RawSize))
+    {
+        return;
+    }
+    Compressed.SetNum(CompressedSize);
+
+    FScopeLock Lock(&Mutex);
+    FEntry& Entry = Entries.FindOrAdd(Key);
+    LiveBytes += CompressedSize - Entry.CompressedSize;
+    Entry.Offset = 0;
+    Entry.CompressedSize = CompressedSize;
+    Entry.NumDeltas = Deltas.Values.Num();
+    Entry.Scale = Deltas.Scale;
+    Entry.LastUse = ++UseClock;
+    Entry.PendingPayload = MoveTemp(Compressed);
+    bDirty = true;
+
+    if (LiveBytes > MaxBytes)
+    {
+        // poda com folga para não repetir a ordenação a cada Store
+        PruneToBudget(MaxBytes * 9 / 10);
+    }
+}
+
+void FErosionDeltaCache::Invalidate(uint32 NewConfigHash)
+{
+    FScopeLock Lock(&Mutex);
+    CloseMapping();
+    Entries.Empty();
+    LiveBytes = 0;
+    ConfigHash = NewConfigHash;
+    bDirty = false;
+    bNeedsRewrite = false;
+    Hits = 0;
+    Misses = 0;
+
+    FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FilePath);
+    UPlanetSystemLogger::LogInfo(TEXT("ErosionDeltaCache"), TEXT("Erosion delta cache invalidated"));
+}
+
+bool FErosionDeltaCache::Flush()
+{
+    using namespace ErosionDeltaCacheFormat;
+
+    FScopeLock Lock(&Mutex);
+    if (!bDirty)
+    {
+        return true;
+    }
+
+    IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+
+    int64 MappedLiveBytes = 0;
+    for (const TPair<uint64, FEntry>& Pair : Entries)
+    {
+        if (!Pair.Value.IsPending())
+        {
+            MappedLiveBytes += Pair.Value.CompressedSize;
+        }
+    }
+
+    // sem arquivo mapeado, as entradas antigas só sobrevivem se forem reescritas
+    const int64 DeadBytes = FileSize - int64(sizeof(FHeader)) - MappedLiveBytes;
+    const bool bAppend = MappedRegion.IsValid() && !bNeedsRewrite && DeadBytes <= FMath::Max(MappedLiveBytes, MinRewriteBytes);
+
+    if (!(bAppend ? AppendPending() : Rewrite()))
+    {
+        // o arquivo antigo continua válido para as entradas mapeadas; as pendentes esperam o próximo Flush
+        MapFile();
+        return false;
+    }
+
+    bDirty = false;
+    bNeedsRewrite = false;
+    MapFile();
+
+    UPlanetSystemLogger::LogInfo(TEXT("ErosionDeltaCache"),
+        FString::Printf(TEXT("Erosion cache flushed (%s): %d entries, %lld bytes"),
+            bAppend ? TEXT("append") : TEXT("rewrite"), Entries.Num(), FileSize));
+    return true;
+}
+
+bool FErosionDeltaCache::AppendPending()
+{
+    using namespace ErosionDeltaCacheFormat;
+
+    // o mapeamento precisa ser liberado antes de escrever no arquivo
+    CloseMapping();
+
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath, FILEWRITE_Append));
+    if (!Writer.IsValid())
+    {
+        UPlanetSystemLogger::LogError(TEXT("ErosionDeltaCache"),
+            FString::Printf(TEXT("Cannot append to erosion cache: %s"), *FilePath));
+        return false;
+    }
+
+    // o offset de uma pendente só passa a valer quando o payload sair dela (sucesso abaixo)
+    for (TPair<uint64, FEntry>& Pair : Entries)
+    {
+        if (Pair.Value.IsPending())
+        {
+            Pair.Value.Offset = Writer->Tell();
+            Writer->Serialize(Pair.Value.PendingPayload.GetData(), Pair.Value.CompressedSize);
+        }
+    }
+
+    FFooter Footer = { Writer->Tell(), uint32(Entries.Num()), Magic };
+    for (const TPair<uint64, FEntry>& Pair : Entries)
+    {
+        FIndexRecord Record = { Pair.Key, Pair.Value.Offset, Pair.Value.CompressedSize, Pair.Value.NumDeltas, Pair.Value.Scale, 0 };
+        Writer->Serialize(&Record, sizeof(Record));
+    }
+    Writer->Serialize(&Footer, sizeof(Footer));
+
+    const bool bWriteOk = Writer->Close() && !Writer->IsError();
+    Writer.Reset();
+
+    if (!bWriteOk)
+    {
+        // fim do arquivo possivelmente truncado: as entradas já mapeadas continuam válidas, mas o
+        // próximo Flush reescreve tudo
+        bNeedsRewrite = true;
+        return false;
+    }
+
+    for (TPair<uint64, FEntry>& Pair : Entries)
+    {
+        Pair.Value.PendingPayload.Empty();
+    }
+    return true;
+}
+
+bool FErosionDeltaCache::Rewrite()
+{
+    using namespace ErosionDeltaCacheFormat;
+
+    const FString TempPath = FilePath + TEXT(".tmp");
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath));
+    if (!Writer.IsValid())
+    {
+        UPlanetSystemLogger::LogError(TEXT("ErosionDeltaCache"),
+            FString::Printf(TEXT("Cannot write erosion cache: %s"), *TempPath));
+        return false;
+    }
+
+    // entradas sem payload (mapeamento perdido) não têm o que gravar
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (!GetPayload(It.Value()))
+        {
+            LiveBytes -= It.Value().CompressedSize;
+            It.RemoveCurrent();
+        }
+    }
+
+    FHeader Header = { Magic, Version, ConfigHash, 0 };
+    Writer->Serialize(&Header, sizeof(Header));
+
+    TArray<int64> Offsets;
+    Offsets.Reserve(Entries.Num());
+    for (const TPair<uint64, FEntry>& Pair : Entries)
+    {
+        Offsets.Add(Writer->Tell());
+        Writer->Serialize(const_cast<uint8*>(GetPayload(Pair.Value)), Pair.Value.CompressedSize);
+    }
+
+    FFooter Footer = { Writer->Tell(), uint32(Entries.Num()), Magic };
+    int32 Index = 0;
+    for (const TPair<uint64, FEntry>& Pair : Entries)
+    {
+        FIndexRecord Record = { Pair.Key, Offsets[Index++], Pair.Value.CompressedSize, Pair.Value.NumDeltas, Pair.Value.Scale, 0 };
+        Writer->Serialize(&Record, sizeof(Record));
+    }
+    Writer->Serialize(&Footer, sizeof(Footer));
+
+    const bool bWriteOk = Writer->Close() && !Writer->IsError();
+    Writer.Reset();
+
+    if (!bWriteOk)
+    {
+        IFileManager::Get().Delete(*TempPath);
+        return false;
+    }
+
+    // O mapeamento antigo precisa ser liberado antes de substituir o arquivo
+    CloseMapping();
+    if (!IFileManager::Get().Move(*FilePath, *TempPath, true))
+    {
+        IFileManager::Get().Delete(*TempPath);
+        return false;
+    }
+
+    Index = 0;
+    for (TPair<uint64, FEntry>& Pair : Entries)
+    {
+        Pair.Value.Offset = Offsets[Index++];
+        Pair.Value.PendingPayload.Empty();
+    }
+    return true;
+}
+
+void FErosionDeltaCache::PruneToBudget(int64 TargetBytes)
+{
+    if (LiveBytes <= TargetBytes)
+    {
+        return;
+    }
+
+    TArray<TPair<uint64, uint64>> ByUse;
+    ByUse.Reserve(Entries.Num());
+    for (const TPair<uint64, FEntry>& Pair : Entries)
+    {
+        ByUse.Emplace(Pair.Value.LastUse, Pair.Key);
+    }
+    ByUse.Sort([](const TPair<uint64, uint64>& A, const TPair<uint64, uint64>& B) { return A.Key < B.Key; });
+
+    int32 Removed = 0;
+    for (const TPair<uint64, uint64>& Item : ByUse)
+    {
+        if (LiveBytes <= TargetBytes)
+        {
+            break;
+        }
+        LiveBytes -= Entries.FindChecked(Item.Value).CompressedSize;
+        Entries.Remove(Item.Value);
+        Removed++;
+    }
+
+    // o índice em disco ainda lista as removidas
+    bDirty = true;
+
+    UPlanetSystemLogger::LogInfo(TEXT("ErosionDeltaCache"),
+        FString::Printf(TEXT("Erosion cache over budget: pruned %d entries"), Removed));
+}
+
+uint32 FErosionDeltaCache::GetConfigHash() const
+{
+    FScopeLock Lock(&Mutex);
+    return ConfigHash;
+}
+
+int32 FErosionDeltaCache::GetNumEntries() const
+{
+    FScopeLock Lock(&Mutex);
+    return Entries.Num();
+}
+
+int64 FErosionDeltaCache::GetLiveBytes() const
+{
+    FScopeLock Lock(&Mutex);
+    return LiveBytes;
+}
+
+void FErosionDeltaCache::SetMaxBytes(int64 InMaxBytes)
+{
+    FScopeLock Lock(&Mutex);
+    MaxBytes = InMaxBytes;
+    PruneToBudget(MaxBytes);
+}
+
+void FErosionDeltaCache::GetStats(int32& OutHits, int32& OutMisses) const
+{
+    FScopeLock Lock(&Mutex);
+    OutHits = Hits;
+    OutMisses = Misses;
+}
+
+uint64 FErosionDeltaCache::MakeKey(uint32 PatchSeed, int32 Resolution, uint32 InputHash)
+{
+    return (uint64(PatchSeed) << 32) | uint64(HashCombine(InputHash, GetTypeHash(Resolution)));
+}
+
+const uint8* FErosionDeltaCache::GetPayload(const FEntry& Entry) const
+{
+    if (Entry.IsPending())
+    {
+        return Entry.PendingPayload.GetData();
+    }
+    return MappedRegion.IsValid() ? MappedRegion->GetMappedPtr() + Entry.Offset : nullptr;
+}
+
+bool FErosionDeltaCache::MapFile()
+{
+    CloseMapping();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    MappedFile.Reset(PlatformFile.OpenMapped(*FilePath));
+    if (MappedFile.IsValid() && MappedFile->GetFileSize() > 0)
+    {
+        MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+    }
+
+    if (!MappedRegion.IsValid())
+    {
+        CloseMapping();
+        return false;
+    }
+
+    FileSize = MappedRegion->GetMappedSize();
+    return true;
+}
+
+void FErosionDeltaCache::CloseMapping()
+{
+    MappedRegion.Reset();
+    MappedFile.Reset();
+    FileSize = 0;
+}
@@ -1,18 +1,66 @@
 #include "Services/Terrain/ErosionModule.h"
+#include "Services/Terrain/ErosionDeltaCache.h"
 #include "Math/UnrealMathUtility.h"
 
 void UErosionModule::ApplyHydraulicErosion(TArray<FVector>& Vertices, int32 Res, uint32 Seed)
 {
     if (!bEnableHydraulic) return;
-    FRandomStream Stream(Seed);
-    int32 Size = Res+1;
-    auto GetIdx=[&](int X,int Y){ return Y*Size + X; };
 
     TArray<float> HeightMap;
     HeightMap.SetNumUninitialized(Vertices.Num());
     for(int i=0;i<Vertices.Num();++i)
         HeightMap[i] = Vertices[i].Size() - 1000.f;
 
+    // cache de deltas: erosão é determinística para a mesma entrada e configuração
+    TArray<float> Deltas;
+    uint64 CacheKey = 0;
+    if (bEnableDeltaCache && DeltaCache.IsValid())
+    {
+        const uint32 ConfigHash = GetConfigHash();
+        if (DeltaCache->GetConfigHash() != ConfigHash)
+        {
+            DeltaCache->Invalidate(ConfigHash);
+        }
+
+        CacheKey = FErosionDeltaCache::MakeKey(Seed, Res, FCrc::MemCrc32(Vertices.GetData(), Vertices.Num() * sizeof(FVector)));
+        if (!DeltaCache->Find(CacheKey, Vertices.Num(), Deltas))
+        {
+            Deltas.Reset();
+        }
+    }
+
+    if (Deltas.Num() == 0)
+    {
+        TArray<float> Eroded = HeightMap;
+        SimulateHydraulicErosion(Eroded, Res, Seed);
+
+        Deltas.SetNumUninitialized(Vertices.Num());
+        for(int i=0;i<Vertices.Num();++i)
+            Deltas[i] = FMath::Clamp(Eroded[i] - HeightMap[i], -MaxHeightChange, MaxHeightChange);
+
+        // aplica sempre a precisão do cache: o patch sai igual gerado agora ou lido do cache depois
+        const FErosionDeltaCache::FQuantizedDeltas Quantized = FErosionDeltaCache::Quantize(Deltas);
+        Quantized.Dequantize(Deltas);
+
+        if (CacheKey != 0)
+        {
+            DeltaCache->Store(CacheKey, Quantized);
+        }
+    }
+
+    for(int i=0;i<Vertices.Num();++i)
+    {
+        FVector dir = Vertices[i].GetSafeNormal();
+        Vertices[i] = dir * (1000.f + HeightMap[i] + Deltas[i]);
+    }
+}
+
+void UErosionModule::SimulateHydraulicErosion(TArray<float>& HeightMap, int32 Res, uint32 Seed) const
+{
+    FRandomStream Stream(Seed);
+    int32 Size = Res+1;
+    auto GetIdx=[&](int X,int Y){ return Y*Size + X; };
+
     for(int i=0;i<Iterations; ++i)
     {
         int x=Stream.RandRange(1,Res-1), y=Stream.RandRange(1,Res-1);
@@ -46,10 +94,42 @@ void UErosionModule::ApplyHydraulicErosion(TArray<FVector>& Vertices, int32 Res,
             if(water < 0.01f) break;
         }
     }
+}
 
-    for(int i=0;i<Vertices.Num();++i)
+void UErosionModule::InitializeDeltaCache(const FString& CacheFilePath)
+{
+    if (!bEnableDeltaCache) return;
+
+    DeltaCache = MakeShared<FErosionDeltaCache, ESPMode::ThreadSafe>(CacheFilePath, GetConfigHash(),
+                                                                      int64(DeltaCacheMaxMB) * 1024 * 1024);
+    DeltaCache->Open();
+}
+
+void UErosionModule::FlushDeltaCache()
+{
+    if (DeltaCache.IsValid())
     {
-        FVector dir = Vertices[i].GetSafeNormal();
-        Vertices[i] = dir * (1000.f + HeightMap[i]);
+        DeltaCache->Flush();
     }
 }
+
+uint32 UErosionModule::GetConfigHash() const
+{
+    // versão do algoritmo entra no hash para invalidar caches antigos quando a simulação mudar
+    uint32 Hash = GetTypeHash(2);
+    Hash = HashCombine(Hash, GetTypeHash(bEnableHydraulic));
+    Hash = HashCombine(Hash, GetTypeHash(Iterations));
+    Hash = HashCombine(Hash, GetTypeHash(SedimentCapacity));
+    Hash = HashCombine(Hash, GetTypeHash(ErodeRate));
+    Hash = HashCombine(Hash, GetTypeHash(DepositRate));
+    Hash = HashCombine(Hash, GetTypeHash(MaxSteps));
+    Hash = HashCombine(Hash, GetTypeHash(MaxHeightChange));
+    return Hash;
+}
+
+void UErosionModule::BeginDestroy()
+{
+    FlushDeltaCache();
+    DeltaCache.Reset();
+    Super::BeginDestroy();
+}
@@ -0,0 +1,628 @@
+#include "Services/Terrain/RiverNetworkBuilder.h"
+#include "Async/ParallelFor.h"
+
+namespace RiverNetwork
+{
+    static const int32 DX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+    static const int32 DY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    static const float Dist[8] = { 1.f, UE_SQRT_2, 1.f, UE_SQRT_2, 1.f, UE_SQRT_2, 1.f, UE_SQRT_2 };
+
+    /** Diferenças de vazão menores que isto não são reaplicadas */
+    static constexpr float MinDelta = 1e-3f;
+
+    /** Nó 0 do grafo de bacias: tudo que sai por uma borda sem tile vizinho */
+    static constexpr int32 SinkNode = 0;
+
+    static int32 FloorDiv(int32 A, int32 B)
+    {
+        return (A >= 0) ? A / B : -((-A + B - 1) / B);
+    }
+
+    /** Ligação entre duas bacias através de uma borda */
+    struct FSpillEdge
+    {
+        int32 To;           // bacia vizinha
+        float Height;       // elevação de transbordo
+        int32 EntryCell;    // célula do tile de origem por onde a água da vizinha entra (INDEX_NONE no sumidouro)
+    };
+
+    struct FFloodItem
+    {
+        float Level;
+        int32 Node;
+        int32 Parent;
+        int32 EntryCell;
+
+        bool operator<(const FFloodItem& Other) const { return Level < Other.Level; }
+    };
+}
+
+FRiverNetworkBuilder::FRiverNetworkBuilder(int32 InTileSize)
+    : TileSize(FMath::Max(InTileSize, 3))
+{
+}
+
+void FRiverNetworkBuilder::SetTile(FTileInput&& Input)
+{
+    check(Input.Size >= 2 && Input.Heights.Num() == Input.Size * Input.Size);
+
+    // chunks de LOD diferentes chegam com resoluções diferentes: o grafo entre tiles exige o mesmo lado
+    Resample(Input);
+
+    FTile& Tile = Tiles.FindOrAdd(MakeKey(Input.Coord, Input.Layer));
+    Tile.Input = MoveTemp(Input);
+    Tile.bDirty = true;
+}
+
+void FRiverNetworkBuilder::RemoveTile(const FIntPoint& Coord, int32 Layer)
+{
+    Tiles.Remove(MakeKey(Coord, Layer));
+}
+
+void FRiverNetworkBuilder::Reset()
+{
+    Tiles.Empty();
+}
+
+void FRiverNetworkBuilder::Resample(FTileInput& Input) const
+{
+    if (Input.Size == TileSize)
+    {
+        return;
+    }
+
+    const int32 SrcSize = Input.Size;
+    const bool bHasPositions = Input.Positions.Num() == SrcSize * SrcSize;
+    const float Scale = float(SrcSize - 1) / float(TileSize - 1);
+
+    TArray<float> Heights;
+    TArray<FVector> Positions;
+    Heights.SetNumUninitialized(TileSize * TileSize);
+    if (bHasPositions)
+    {
+        Positions.SetNumUninitialized(TileSize * TileSize);
+    }
+
+    for (int32 Y = 0; Y < TileSize; ++Y)
+    {
+        const float SY = Y * Scale;
+        const int32 Y0 = FMath::Min(FMath::FloorToInt(SY), SrcSize - 2);
+        const float FY = SY - Y0;
+        for (int32 X = 0; X < TileSize; ++X)
+        {
+            const float SX = X * Scale;
+            const int32 X0 = FMath::Min(FMath::FloorToInt(SX), SrcSize - 2);
+            const float FX = SX - X0;
+            const int32 I00 = Y0 * SrcSize + X0;
+
+            Heights[Y * TileSize + X] = FMath::BiLerp(Input.Heights[I00], Input.Heights[I00 + 1],
+                                                      Input.Heights[I00 + SrcSize], Input.Heights[I00 + SrcSize + 1], FX, FY);
+            if (bHasPositions)
+            {
+                Positions[Y * TileSize + X] = FMath::BiLerp(Input.Positions[I00], Input.Positions[I00 + 1],
+                                                            Input.Positions[I00 + SrcSize], Input.Positions[I00 + SrcSize + 1], FX, FY);
+            }
+        }
+    }
+
+    Input.Size = TileSize;
+    Input.Heights = MoveTemp(Heights);
+    Input.Positions = MoveTemp(Positions);
+}
+
+int32 FRiverNetworkBuilder::Build()
+{
+    // 1) tiles alterados: preenchimento, D8, bacias das saídas e acumulação local, em paralelo
+    TArray<FTile*> DirtyTiles;
+    for (TPair<FIntVector, FTile>& Pair : Tiles)
+    {
+        if (Pair.Value.bDirty)
+        {
+            DirtyTiles.Add(&Pair.Value);
+        }
+    }
+
+    ParallelFor(DirtyTiles.Num(), [&](int32 i)
+    {
+        FTile& Tile = *DirtyTiles[i];
+        FillDepressions(Tile.Input.Heights, Tile.Input.Size, Tile.Filled);
+        ComputeFlow(Tile);
+        Accumulate(Tile);
+    });
+
+    // 2) roteamento global sobre o grafo de bacias (pequeno: só saídas de borda)
+    TMap<FIntVector, TMap<int32, float>> NewInflow;
+    RouteBetweenTiles(NewInflow);
+
+    // 3) cada tile soma a vazão recebida ao longo do caminho até a saída; tiles intactos só aplicam a diferença
+    TArray<FTile*> AllTiles;
+    TArray<const TMap<int32, float>*> TileInflow;
+    for (TPair<FIntVector, FTile>& Pair : Tiles)
+    {
+        AllTiles.Add(&Pair.Value);
+        TileInflow.Add(NewInflow.Find(Pair.Key));
+    }
+
+    TArray<uint8> Changed;
+    Changed.SetNumZeroed(AllTiles.Num());
+
+    ParallelFor(AllTiles.Num(), [&](int32 i)
+    {
+        FTile& Tile = *AllTiles[i];
+        static const TMap<int32, float> NoInflow;
+        const TMap<int32, float>& Inflow = TileInflow[i] ? *TileInflow[i] : NoInflow;
+
+        if (Tile.bDirty)
+        {
+            Tile.Total = Tile.Local;
+            for (const TPair<int32, float>& Entry : Inflow)
+            {
+                AddAlongPath(Tile, Entry.Key, Entry.Value);
+            }
+            Tile.bDirty = false;
+            Changed[i] = 1;
+        }
+        else
+        {
+            TMap<int32, float> Deltas = Inflow;
+            for (const TPair<int32, float>& Old : Tile.Inflow)
+            {
+                Deltas.FindOrAdd(Old.Key) -= Old.Value;
+            }
+            for (const TPair<int32, float>& Delta : Deltas)
+            {
+                if (FMath::Abs(Delta.Value) >= RiverNetwork::MinDelta)
+                {
+                    AddAlongPath(Tile, Delta.Key, Delta.Value);
+                    Changed[i] = 1;
+                }
+            }
+        }
+        Tile.Inflow = Inflow;
+    });
+
+    int32 NumChanged = 0;
+    for (uint8 bChanged : Changed)
+    {
+        NumChanged += bChanged;
+    }
+    return NumChanged;
+}
+
+void FRiverNetworkBuilder::RouteBetweenTiles(TMap<FIntVector, TMap<int32, float>>& OutInflow) const
+{
+    using namespace RiverNetwork;
+
+    // nó por saída de borda; o nó 0 é o sumidouro
+    TArray<const FTile*> NodeTile;
+    TArray<FIntVector> NodeKey;
+    TArray<int32> NodeOutlet;
+    TMap<FIntVector, int32> FirstNode;
+
+    NodeTile.Add(nullptr);
+    NodeKey.Add(FIntVector::ZeroValue);
+    NodeOutlet.Add(INDEX_NONE);
+    for (const TPair<FIntVector, FTile>& Pair : Tiles)
+    {
+        FirstNode.Add(Pair.Key, NodeTile.Num());
+        for (int32 Cell : Pair.Value.Outlets)
+        {
+            NodeTile.Add(&Pair.Value);
+            NodeKey.Add(Pair.Key);
+            NodeOutlet.Add(Cell);
+        }
+    }
+
+    const int32 NumNodes = NodeTile.Num();
+    if (NumNodes <= 1)
+    {
+        return;
+    }
+
+    // arestas: cada célula de borda contra seus vizinhos do outro lado (ou o sumidouro)
+    TArray<TArray<FSpillEdge>> Edges;
+    Edges.SetNum(NumNodes);
+    const int32 Size = TileSize;
+
+    for (const TPair<FIntVector, FTile>& Pair : Tiles)
+    {
+        const FTile& Tile = Pair.Value;
+        const int32 Base = FirstNode[Pair.Key];
+
+        for (int32 i = 0; i < Size * Size; ++i)
+        {
+            const int32 X = i % Size, Y = i / Size;
+            if (X != 0 && Y != 0 && X != Size - 1 && Y != Size - 1)
+            {
+                continue;
+            }
+
+            const int32 Node = Base + Tile.Outlet[i];
+            for (int32 d = 0; d < 8; ++d)
+            {
+                const int32 NX = X + DX[d], NY = Y + DY[d];
+                if (NX >= 0 && NY >= 0 && NX < Size && NY < Size)
+                {
+                    continue;
+                }
+
+                const FIntPoint Global(Pair.Key.X * Size + NX, Pair.Key.Y * Size + NY);
+                const FIntVector OtherKey(FloorDiv(Global.X, Size), FloorDiv(Global.Y, Size), Pair.Key.Z);
+                const FTile* Other = Tiles.Find(OtherKey);
+                if (!Other)
+                {
+                    // tile ausente funciona como sumidouro
+                    Edges[SinkNode].Add({ Node, Tile.Filled[i], INDEX_NONE });
+                    continue;
+                }
+
+                const int32 OtherCell = (Global.Y - OtherKey.Y * Size) * Size + (Global.X - OtherKey.X * Size);
+                const int32 OtherNode = FirstNode[OtherKey] + Other->Outlet[OtherCell];
+
+                // a bacia vizinha, se verter para esta, entra pela célula i
+                Edges[Node].Add({ OtherNode, FMath::Max(Tile.Filled[i], Other->Filled[OtherCell]), i });
+            }
+        }
+    }
+
+    // priority-flood a partir do sumidouro: cada bacia verte para quem a alcançou pelo menor transbordo
+    TArray<int32> Parent;
+    TArray<int32> EntryCell;
+    Parent.Init(INDEX_NONE, NumNodes);
+    EntryCell.Init(INDEX_NONE, NumNodes);
+    TBitArray<> Closed(false, NumNodes);
+    TArray<int32> FloodOrder;
+    FloodOrder.Reserve(NumNodes);
+
+    TArray<FFloodItem> Heap;
+    Heap.HeapPush({ -MAX_flt, SinkNode, INDEX_NONE, INDEX_NONE });
+    while (Heap.Num() > 0)
+    {
+        FFloodItem Item;
+        Heap.HeapPop(Item, false);
+        if (Closed[Item.Node])
+        {
+            continue;
+        }
+        Closed[Item.Node] = true;
+        Parent[Item.Node] = Item.Parent;
+        EntryCell[Item.Node] = Item.EntryCell;
+        FloodOrder.Add(Item.Node);
+
+        for (const FSpillEdge& Edge : Edges[Item.Node])
+        {
+            if (!Closed[Edge.To])
+            {
+                Heap.HeapPush({ FMath::Max(Item.Level, Edge.Height), Edge.To, Item.Node, Edge.EntryCell });
+            }
+        }
+    }
+
+    // vazão em ordem inversa (folhas primeiro): cada bacia leva a própria saída mais o que recebeu
+    TArray<float> Flow;
+    Flow.SetNumZeroed(NumNodes);
+    for (int32 Node = 1; Node < NumNodes; ++Node)
+    {
+        Flow[Node] = NodeTile[Node]->Local[NodeOutlet[Node]];
+    }
+
+    for (int32 k = FloodOrder.Num() - 1; k > 0; --k)
+    {
+        const int32 Node = FloodOrder[k];
+        const int32 To = Parent[Node];
+        if (To == SinkNode || To == INDEX_NONE)
+        {
+            continue;
+        }
+        Flow[To] += Flow[Node];
+        OutInflow.FindOrAdd(NodeKey[To]).FindOrAdd(EntryCell[Node]) += Flow[Node];
+    }
+}
+
+void FRiverNetworkBuilder::FillDepressions(const TArray<float>& Heights, int32 Size, TArray<float>& OutFilled)
+{
+    const int32 Num = Size * Size;
+    OutFilled = Heights;
+
+    float MinHeight = MAX_flt, MaxHeight = -MAX_flt;
+    for (float H : Heights)
+    {
+        MinHeight = FMath::Min(MinHeight, H);
+        MaxHeight = FMath::Max(MaxHeight, H);
+    }
+    const float Range = FMath::Max(MaxHeight - MinHeight, KINDA_SMALL_NUMBER);
+    const float BucketScale = (NumHeightBuckets - 1) / Range;
+    const float Epsilon = Range * 1e-6f;
+
+    auto BucketOf = [&](float H)
+    {
+        return FMath::Clamp(int32((H - MinHeight) * BucketScale), 0, NumHeightBuckets - 1);
+    };
+
+    // priority-flood com fila de buckets: O(N + buckets) em vez de O(N log N) do heap
+    TArray<TArray<int32>> Buckets;
+    Buckets.SetNum(NumHeightBuckets);
+    TArray<int32> Pit;
+    int32 PitHead = 0;
+    TBitArray<> Closed(false, Num);
+
+    // as bordas do tile são as saídas
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const int32 X = i % Size, Y = i / Size;
+        if (X == 0 || Y == 0 || X == Size - 1 || Y == Size - 1)
+        {
+            Closed[i] = true;
+            Buckets[BucketOf(Heights[i])].Add(i);
+        }
+    }
+
+    int32 CurrentBucket = 0;
+    int32 BucketHead = 0;
+    while (true)
+    {
+        int32 Cell;
+        if (PitHead < Pit.Num())
+        {
+            Cell = Pit[PitHead++];
+        }
+        else
+        {
+            while (CurrentBucket < NumHeightBuckets && BucketHead >= Buckets[CurrentBucket].Num())
+            {
+                Buckets[CurrentBucket].Empty();
+                ++CurrentBucket;
+                BucketHead = 0;
+            }
+            if (CurrentBucket >= NumHeightBuckets)
+            {
+                break;
+            }
+            Cell = Buckets[CurrentBucket][BucketHead++];
+        }
+
+        const int32 X = Cell % Size, Y = Cell / Size;
+        for (int32 d = 0; d < 8; ++d)
+        {
+            const int32 NX = X + RiverNetwork::DX[d], NY = Y + RiverNetwork::DY[d];
+            if (NX < 0 || NY < 0 || NX >= Size || NY >= Size)
+            {
+                continue;
+            }
+            const int32 N = NY * Size + NX;
+            if (Closed[N])
+            {
+                continue;
+            }
+            Closed[N] = true;
+
+            // depressão: eleva até o ponto de transbordo + epsilon para manter a drenagem
+            const float Spill = OutFilled[Cell] + FMath::Max(Epsilon, FMath::Abs(OutFilled[Cell]) * 1e-7f);
+            if (OutFilled[N] <= Spill)
+            {
+                OutFilled[N] = Spill;
+                Pit.Add(N);
+            }
+            else
+            {
+                // buckets abaixo do atual já foram esvaziados
+                Buckets[FMath::Max(BucketOf(OutFilled[N]), CurrentBucket)].Add(N);
+            }
+        }
+    }
+}
+
+void FRiverNetworkBuilder::ComputeFlow(FTile& Tile)
+{
+    const int32 Size = Tile.Input.Size;
+    const int32 Num = Size * Size;
+    const TArray<float>& H = Tile.Filled;
+
+    Tile.Down.SetNumUninitialized(Num);
+    Tile.Outlets.Reset();
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const int32 X = i % Size, Y = i / Size;
+
+        // D8: maior declividade entre os vizinhos no tile
+        int32 Best = INDEX_NONE;
+        float BestSlope = 0.f;
+        for (int32 d = 0; d < 8; ++d)
+        {
+            const int32 NX = X + RiverNetwork::DX[d], NY = Y + RiverNetwork::DY[d];
+            if (NX < 0 || NY < 0 || NX >= Size || NY >= Size)
+            {
+                continue;
+            }
+            const int32 N = NY * Size + NX;
+            const float Slope = (H[i] - H[N]) / RiverNetwork::Dist[d];
+            if (Slope > BestSlope)
+            {
+                BestSlope = Slope;
+                Best = N;
+            }
+        }
+
+        // só células de borda ficam sem vizinho mais baixo: saídas do tile, destino decidido no grafo
+        Tile.Down[i] = Best != INDEX_NONE ? Best : ExitsTile;
+        if (Best == INDEX_NONE)
+        {
+            Tile.Outlets.Add(i);
+        }
+    }
+
+    // ordem topológica (Kahn): toda célula antes da sua célula a jusante
+    TArray<int32> InDegree;
+    InDegree.SetNumZeroed(Num);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        if (Tile.Down[i] >= 0)
+        {
+            ++InDegree[Tile.Down[i]];
+        }
+    }
+
+    Tile.Order.Reset(Num);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        if (InDegree[i] == 0)
+        {
+            Tile.Order.Add(i);
+        }
+    }
+    for (int32 Head = 0; Head < Tile.Order.Num(); ++Head)
+    {
+        const int32 Down = Tile.Down[Tile.Order[Head]];
+        if (Down >= 0 && --InDegree[Down] == 0)
+        {
+            Tile.Order.Add(Down);
+        }
+    }
+
+    // bacia de cada célula: jusante primeiro, então cada célula herda a saída da sua célula a jusante
+    Tile.Outlet.SetNumUninitialized(Num);
+    for (int32 k = 0; k < Tile.Outlets.Num(); ++k)
+    {
+        Tile.Outlet[Tile.Outlets[k]] = k;
+    }
+    for (int32 k = Tile.Order.Num() - 1; k >= 0; --k)
+    {
+        const int32 Cell = Tile.Order[k];
+        if (Tile.Down[Cell] >= 0)
+        {
+            Tile.Outlet[Cell] = Tile.Outlet[Tile.Down[Cell]];
+        }
+    }
+}
+
+void FRiverNetworkBuilder::Accumulate(FTile& Tile)
+{
+    const int32 Num = Tile.Input.Size * Tile.Input.Size;
+
+    // cada célula contribui com 1; a vazão de outros tiles entra depois, pelo grafo
+    Tile.Local.Init(1.f, Num);
+    for (int32 Cell : Tile.Order)
+    {
+        const int32 Down = Tile.Down[Cell];
+        if (Down >= 0)
+        {
+            Tile.Local[Down] += Tile.Local[Cell];
+        }
+    }
+}
+
+void FRiverNetworkBuilder::AddAlongPath(FTile& Tile, int32 Cell, float Amount)
+{
+    while (Cell >= 0)
+    {
+        Tile.Total[Cell] += Amount;
+        Cell = Tile.Down[Cell];
+    }
+}
+
+FIntPoint FRiverNetworkBuilder::GlobalCell(const FTile& Tile, int32 Index) const
+{
+    const int32 Size = Tile.Input.Size;
+    return FIntPoint(Tile.Input.Coord.X * Size + Index % Size, Tile.Input.Coord.Y * Size + Index / Size);
+}
+
+FVector FRiverNetworkBuilder::GetCellPosition(const FTile& Tile, int32 Index) const
+{
+    if (Tile.Input.Positions.IsValidIndex(Index))
+    {
+        return Tile.Input.Positions[Index];
+    }
+    const FIntPoint Cell = GlobalCell(Tile, Index);
+    return FVector(Cell.X, Cell.Y, Tile.Input.Heights[Index]);
+}
+
+void FRiverNetworkBuilder::ExtractRivers(float Threshold, TArray<TArray<FVector>>& OutRivers) const
+{
+    TArray<const FTile*> TileList;
+    for (const TPair<FIntVector, FTile>& Pair : Tiles)
+    {
+        TileList.Add(&Pair.Value);
+    }
+
+    TArray<TArray<TArray<FVector>>> PerTile;
+    PerTile.SetNum(TileList.Num());
+
+    ParallelFor(TileList.Num(), [&](int32 t)
+    {
+        ExtractTileRivers(*TileList[t], Threshold, PerTile[t]);
+    });
+
+    for (TArray<TArray<FVector>>& Rivers : PerTile)
+    {
+        OutRivers.Append(MoveTemp(Rivers));
+    }
+}
+
+void FRiverNetworkBuilder::ExtractRivers(const FIntPoint& Coord, int32 Layer, float Threshold, TArray<TArray<FVector>>& OutRivers) const
+{
+    if (const FTile* Tile = Tiles.Find(MakeKey(Coord, Layer)))
+    {
+        ExtractTileRivers(*Tile, Threshold, OutRivers);
+    }
+}
+
+void FRiverNetworkBuilder::ExtractTileRivers(const FTile& Tile, float Threshold, TArray<TArray<FVector>>& OutRivers) const
+{
+    const int32 Num = Tile.Total.Num();
+
+    // nascentes: células de rio sem afluente de rio dentro do tile
+    TArray<uint8> RiverUpstream;
+    RiverUpstream.SetNumZeroed(Num);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        if (Tile.Total[i] >= Threshold && Tile.Down[i] >= 0)
+        {
+            RiverUpstream[Tile.Down[i]] = 1;
+        }
+    }
+
+    TBitArray<> Visited(false, Num);
+    for (int32 Head = 0; Head < Num; ++Head)
+    {
+        if (Tile.Total[Head] < Threshold || RiverUpstream[Head])
+        {
+            continue;
+        }
+
+        TArray<FVector> Polyline;
+        int32 Cell = Head;
+        while (true)
+        {
+            Polyline.Add(GetCellPosition(Tile, Cell));
+            if (Visited[Cell])
+            {
+                break; // confluência com um rio já traçado
+            }
+            Visited[Cell] = true;
+
+            const int32 Down = Tile.Down[Cell];
+            if (Down < 0)
+            {
+                break; // sai do tile; o vizinho continua a partir da célula de entrada
+            }
+            Cell = Down;
+        }
+
+        if (Polyline.Num() >= 2)
+        {
+            OutRivers.Add(MoveTemp(Polyline));
+        }
+    }
+}
+
+float FRiverNetworkBuilder::GetAccumulation(const FIntPoint& Coord, int32 Layer, int32 X, int32 Y) const
+{
+    const FTile* Tile = Tiles.Find(MakeKey(Coord, Layer));
+    if (!Tile || Tile->Total.Num() == 0)
+    {
+        return 0.f;
+    }
+    const int32 Size = Tile->Input.Size;
+    return (X >= 0 && Y >= 0 && X < Size && Y < Size) ? Tile->Total[Y * Size + X] : 0.f;
+}
@@ -93,6 +93,82 @@ struct PLANETSYSTEM_API FVegetationInstance
     FVector Scale = FVector::OneVector;
 };
 
+/**
+ * Instância de vegetação empacotada (10 bytes)
+ * Posição quantizada em 16 bits por eixo dentro dos limites do patch, yaw em 8 bits e escala uniforme em 8 bits.
+ * A decodificação para FTransform é feita em lote no commit (UVegetationSystem::DecodeInstances).
+ */
+USTRUCT(BlueprintType)
+struct PLANETSYSTEM_API FPackedVegetationInstance
+{
+    GENERATED_BODY();
+
+    /** Tipo de vegetação: (bioma << 8) | variante do bioma (ver MakeTypeIndex) */
+    UPROPERTY()
+    uint16 TypeIndex = 0;
+
+    /** Posição normalizada nos limites do patch, 0-65535 por eixo */
+    UPROPERTY()
+    uint16 PosX = 0;
+
+    UPROPERTY()
+    uint16 PosY = 0;
+
+    UPROPERTY()
+    uint16 PosZ = 0;
+
+    /** Yaw em 256 passos de 360/256 graus */
+    UPROPERTY()
+    uint8 Yaw = 0;
+
+    /** Escala uniforme em passos de 1/64 (0-3.98) */
+    UPROPERTY()
+    uint8 Scale = 64;
+
+    static constexpr float ScaleStep = 1.0f / 64.0f;
+
+    /**
+     * Empacota uma instância
+     * @param InTypeIndex Índice do tipo
+     * @param LocalPosition Posição normalizada (0-1) dentro dos limites
+     * @param YawRadians Rotação em torno da normal
+     * @param UniformScale Escala uniforme
+     */
+    static FPackedVegetationInstance Pack(uint16 InTypeIndex, const FVector& LocalPosition, float YawRadians, float UniformScale)
+    {
+        auto Quantize16 = [](double Value) { return uint16(FMath::Clamp(FMath::RoundToInt(Value * 65535.0), 0, 65535)); };
+
+        FPackedVegetationInstance Packed;
+        Packed.TypeIndex = InTypeIndex;
+        Packed.PosX = Quantize16(LocalPosition.X);
+        Packed.PosY = Quantize16(LocalPosition.Y);
+        Packed.PosZ = Quantize16(LocalPosition.Z);
+        Packed.Yaw = uint8(FMath::RoundToInt(FMath::Frac(YawRadians / UE_TWO_PI) * 256.0f) & 0xFF);
+        Packed.Scale = uint8(FMath::Clamp(FMath::RoundToInt(UniformScale / ScaleStep), 1, 255));
+        return Packed;
+    }
+
+    /** Única codificação de TypeIndex usada por todos os geradores */
+    static uint16 MakeTypeIndex(uint8 Biome, uint8 Variant)
+    {
+        return uint16((uint32(Biome) << 8) | Variant);
+    }
+
+    uint8 GetBiome() const { return uint8(TypeIndex >> 8); }
+
+    /** Índice do tipo na lista de vegetação do bioma */
+    uint8 GetVariant() const { return uint8(TypeIndex & 0xFF); }
+
+    /** Posição normalizada (0-1) dentro dos limites */
+    FVector GetLocalPosition() const
+    {
+        return FVector(PosX, PosY, PosZ) / 65535.0;
+    }
+
+    float GetYawRadians() const { return float(Yaw) * (UE_TWO_PI / 256.0f); }
+    float GetScale() const { return float(Scale) * ScaleStep; }
+};
+
 USTRUCT(BlueprintType)
 struct PLANETSYSTEM_API FPlanetChunk
 {
@@ -113,8 +189,17 @@ struct PLANETSYSTEM_API FPlanetChunk
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Chunk")
     TArray<EBiomeType> BiomeMap;
 
+    /** Triângulos sobre HeightMap; preenchido apenas por chunks só de colisão */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Chunk")
-    TArray<FVegetationInstance> Vegetation;
+    TArray<int32> CollisionIndices;
+
+    /** Instâncias empacotadas; TypeIndex = MakeTypeIndex(bioma, índice em GetVegetationForBiome) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Chunk")
+    TArray<FPackedVegetationInstance> Vegetation;
+
+    /** Limites usados na quantização das posições de Vegetation */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Chunk")
+    FBox VegetationBounds = FBox(FVector::ZeroVector, FVector::OneVector);
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Chunk")
     FWaterSystem WaterSystem;
@@ -123,5 +208,19 @@ struct PLANETSYSTEM_API FPlanetChunk
     {
         GenerationTime = FDateTime::Now();
     }
+
+    /** Bytes alocados pela estrutura e por todos os arrays (contabilidade dos caches) */
+    int64 GetAllocatedSize() const
+    {
+        int64 Size = sizeof(FPlanetChunk) + HeightMap.GetAllocatedSize() + BiomeMap.GetAllocatedSize()
+            + CollisionIndices.GetAllocatedSize() + Vegetation.GetAllocatedSize()
+            + WaterSystem.OceanSystem.SurfaceVertices.GetAllocatedSize()
+            + WaterSystem.RiverSystem.RiverPoints.GetAllocatedSize();
+        for (const TArray<FVector>& River : WaterSystem.RiverSystem.RiverPoints)
+        {
+            Size += River.GetAllocatedSize();
+        }
+        return Size;
+    }
 };
 
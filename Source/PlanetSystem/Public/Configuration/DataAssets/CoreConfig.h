@@ -18,6 +18,26 @@ struct FPlanetGenerationConfig
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation", meta=(ClampMin="0.1", ClampMax="2.0"))
     float LODUpdateInterval = 0.2f;
     
+    /** O patch se subdivide enquanto o observador está mais perto que o raio de seus limites vezes este fator */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation", meta=(ClampMin="1.0", ClampMax="8.0"))
+    float LODSplitFactor = 2.5f;
+    
+    /** Patches folha extras que cada observador pode adicionar por subdivisão (patches compartilhados contam uma vez) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation", meta=(ClampMin="3"))
+    int32 MaxPatchesPerViewer = 256;
+    
+    /** Observadores em movimento têm gerados antes os patches de que vão precisar daqui a estes segundos (0 desativa) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation", meta=(ClampMin="0.0", ClampMax="10.0"))
+    float PrefetchSeconds = 2.0f;
+    
+    /** Tempo que cada atualização de LOD pode gastar gerando patches antecipados, depois dos visíveis */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation", meta=(ClampMin="0.0", ClampMax="50.0"))
+    float PrefetchBudgetMs = 4.0f;
+    
+    /** Patches só de colisão usam a resolução de render deslocada à direita por este valor (mínimo 2) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation", meta=(ClampMin="0", ClampMax="3"))
+    int32 CollisionResolutionShift = 1;
+    
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation", meta=(ClampMin="2", ClampMax="32"))
     int32 BaseMeshResolution = 8;
     
@@ -29,6 +49,13 @@ struct FPlanetGenerationConfig
     
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation")
     bool bEnableWater = true;
+    
+    /** Lado da grade no LODLevel: BaseResolution dividida por 2 a cada nível e deslocada à direita por Shift (mínimo 2).
+     *  As grades de render e de colisão de todos os caminhos de terreno passam por aqui para ficarem alinhadas. */
+    static int32 GetGridResolution(int32 BaseResolution, int32 LODLevel, int32 Shift = 0)
+    {
+        return FMath::Max((BaseResolution >> FMath::Max(LODLevel, 0)) >> FMath::Max(Shift, 0), 2);
+    }
 };
 
 USTRUCT(BlueprintType)
@@ -77,6 +104,24 @@ struct FBiomeConfig
     
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Biomes")
     float PlainsSlopeThreshold = 0.3f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Biomes")
+    float SnowTemperatureThreshold = 0.15f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Biomes", meta=(ClampMin="1"))
+    float MaxAltitude = 200.0f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Biomes", meta=(ClampMin="0", ClampMax="1"))
+    float AltitudeTemperatureLapse = 0.5f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Biomes|Blending")
+    bool bSmoothTransitions = true;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Biomes|Blending", meta=(ClampMin="0.001", ClampMax="1"))
+    float TransitionWidth = 0.05f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Biomes|Blending", meta=(ClampMin="0", ClampMax="4"))
+    int32 TransitionBlurRadius = 1;
 };
 
 UCLASS(BlueprintType)
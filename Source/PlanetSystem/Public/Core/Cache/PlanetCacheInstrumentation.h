@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/** Operações instrumentadas nos caminhos quentes dos caches de chunks */
+enum class EPlanetCacheOp : uint8
+{
+    Find,
+    Add,
+    Has,
+    Num
+};
+
+/**
+ * Instrumentação leve dos caminhos quentes dos caches de chunks
+ * Toda operação custa apenas incrementos atômicos relaxados. Eventos, profiler e log detalhado
+ * (formatação de strings) ficam para uma amostra de 1 a cada N operações por thread
+ * (planet.Cache.TraceSampleRate, 0 desliga) ou para todas no modo verbose (planet.Cache.Verbose).
+ */
+class PLANETSYSTEM_API FPlanetCacheInstrumentation
+{
+public:
+    struct FOpStats
+    {
+        int64 Calls = 0;
+        int64 Hits = 0;
+        int64 Sampled = 0;
+        double SampledSeconds = 0.0;   // tempo somado das operações amostradas
+    };
+
+    /** Conta uma operação; bHit é ignorado em Add */
+    void Count(EPlanetCacheOp Op, bool bHit)
+    {
+        FCounters& Counter = Counters[uint8(Op)];
+        Counter.Calls.fetch_add(1, std::memory_order_relaxed);
+        if (bHit)
+        {
+            Counter.Hits.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /** Duração (ciclos) de uma operação amostrada */
+    void AddSample(EPlanetCacheOp Op, uint64 Cycles)
+    {
+        FCounters& Counter = Counters[uint8(Op)];
+        Counter.Sampled.fetch_add(1, std::memory_order_relaxed);
+        Counter.SampledCycles.fetch_add(Cycles, std::memory_order_relaxed);
+    }
+
+    /** A operação atual deve ser rastreada: modo verbose ou amostra da vez nesta thread */
+    static bool ShouldTrace();
+
+    /** Log e eventos detalhados em toda operação */
+    static bool IsVerbose();
+
+    /** N da amostragem (1 a cada N operações por thread; 0 = sem amostras) */
+    static int32 GetSampleRate();
+
+    FOpStats GetStats(EPlanetCacheOp Op) const;
+    void ResetStats();
+
+    /** Resumo por operação: chamadas, acertos e latência média das amostras */
+    FString GetReport() const;
+
+    static const TCHAR* GetOpName(EPlanetCacheOp Op);
+
+private:
+    /** Uma linha de cache por operação: threads em operações diferentes não disputam a mesma linha */
+    struct alignas(PLATFORM_CACHE_LINE_SIZE) FCounters
+    {
+        std::atomic<int64> Calls { 0 };
+        std::atomic<int64> Hits { 0 };
+        std::atomic<int64> Sampled { 0 };
+        std::atomic<uint64> SampledCycles { 0 };
+    };
+
+    FCounters Counters[uint8(EPlanetCacheOp::Num)];
+};
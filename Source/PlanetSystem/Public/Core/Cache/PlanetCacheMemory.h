@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/** Tags LLM dos caches de chunks (memória rastreada no "stat LLM" / memreport) */
+LLM_DECLARE_TAG_API(PlanetRenderChunkCache, PLANETSYSTEM_API);
+LLM_DECLARE_TAG_API(PlanetChunkCache, PLANETSYSTEM_API);
+LLM_DECLARE_TAG_API(PlanetNetworkChunkCache, PLANETSYSTEM_API);
+
+/**
+ * Pressão de memória global dos caches de chunks
+ * Cada cache se registra em OnTrim e, quando chamado, mantém apenas a fração pedida
+ * dos seus bytes atuais; assim todos os caches encolhem na mesma proporção.
+ * O trim é disparado pelo delegate de memory trim da engine ou por CheckMemoryPressure, que um
+ * único ticker global chama a cada CheckIntervalSeconds (registrado junto com o primeiro cache).
+ * Com histerese: trim na entrada no estado de pouca memória, de novo só após TrimCooldownSeconds
+ * se a memória continuar baixa, e saída só quando a livre passar de RecoveryFactor x o limite.
+ */
+class PLANETSYSTEM_API FPlanetCacheMemory
+{
+public:
+    DECLARE_MULTICAST_DELEGATE_OneParam(FOnTrim, float /* KeepFraction */);
+
+    /** Delegate dos caches; registra o hook da engine no primeiro uso */
+    static FOnTrim& OnTrim();
+
+    /**
+     * Reduz todos os caches registrados
+     * @param KeepFraction Fração dos bytes atuais que cada cache mantém (0..1)
+     */
+    static void TrimAll(float KeepFraction);
+
+    /**
+     * Compara a memória física livre com o limite e reduz os caches proporcionalmente ao déficit
+     * @return Fração mantida (1 = nenhum trim nesta chamada)
+     */
+    static float CheckMemoryPressure();
+
+    /** Está no estado de pouca memória (entre a entrada e a recuperação) */
+    static bool IsLowMemory();
+
+    /** Memória física livre abaixo da qual os caches são reduzidos */
+    static void SetLowMemoryThreshold(int64 Bytes);
+    static int64 GetLowMemoryThreshold();
+
+    /** Fração mínima mantida por trim automático */
+    static constexpr float MinKeepFraction = 0.25f;
+
+    /** Intervalo do ticker global que chama CheckMemoryPressure */
+    static constexpr float CheckIntervalSeconds = 1.0f;
+
+    /** Intervalo mínimo entre trims enquanto a memória continua baixa */
+    static constexpr double TrimCooldownSeconds = 10.0;
+
+    /** A memória livre precisa passar de limite x fator para sair do estado de pouca memória */
+    static constexpr float RecoveryFactor = 1.25f;
+};
@@ -1,11 +1,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "PlanetCachePolicy.generated.h"
 
 /** Cache replacement policies */
-enum class EPlanetCachePolicy
+UENUM(BlueprintType)
+enum class EPlanetCachePolicy : uint8
 {
     LRU,
     LFU,
-    Random
+    Random,
+    Priority,   // lowest priority first, aged by the last victim (GreedyDual: L + priority)
+    GDSF        // GreedyDual-Size-Frequency: cheap, large, rarely used entries first
 };
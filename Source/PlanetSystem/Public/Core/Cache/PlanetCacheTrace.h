@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Core/Cache/PlanetCachePolicy.h"
+
+/**
+ * Trace de acessos a um cache de chunks, para comparar políticas fora do jogo
+ * Grava consultas e inserções (chave de 64 bits, bytes e custo de geração medido).
+ * O replay simula um TPlanetShardedCache com a política e o orçamento pedidos:
+ * cada consulta que falha insere a entrada com o tamanho/custo registrados.
+ */
+class PLANETSYSTEM_API FPlanetCacheTrace
+{
+public:
+    struct FResult
+    {
+        EPlanetCachePolicy Policy = EPlanetCachePolicy::LRU;
+        int64 Lookups = 0;
+        int64 Hits = 0;
+        double TotalCost = 0.0;     // custo de todas as consultas se nada estivesse em cache (s)
+        double SavedCost = 0.0;     // custo evitado pelos hits (s)
+
+        double GetHitRate() const { return Lookups > 0 ? double(Hits) / Lookups : 0.0; }
+        double GetCostHitRate() const { return TotalCost > 0.0 ? SavedCost / TotalCost : 0.0; }
+    };
+
+    /** Registra uma consulta (thread-safe) */
+    void RecordLookup(uint64 Key);
+
+    /** Registra uma inserção com tamanho e custo (thread-safe) */
+    void RecordStore(uint64 Key, int64 Bytes, double Cost);
+
+    int32 Num() const;
+
+    bool Save(const FString& FilePath) const;
+    bool Load(const FString& FilePath);
+
+    /**
+     * Reproduz as consultas com uma política
+     * @param Policy Política simulada
+     * @param MaxBytes Orçamento do cache simulado
+     */
+    FResult Replay(EPlanetCachePolicy Policy, int64 MaxBytes) const;
+
+    /** Tabela de todas as políticas comparadas ao LRU */
+    FString Compare(int64 MaxBytes) const;
+
+private:
+    /** Bytes < 0 marca uma consulta */
+    struct FEvent
+    {
+        uint64 Key = 0;
+        int64 Bytes = -1;
+        float Cost = 0.0f;
+
+        friend FArchive& operator<<(FArchive& Ar, FEvent& Event)
+        {
+            return Ar << Event.Key << Event.Bytes << Event.Cost;
+        }
+    };
+
+    mutable FCriticalSection Mutex;
+    TArray<FEvent> Events;
+};
@@ -0,0 +1,721 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Math/RandomStream.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/UniquePtr.h"
+#include "Core/Cache/PlanetCachePolicy.h"
+#include <atomic>
+
+/**
+ * Núcleo comum dos caches de chunks
+ * As entradas são distribuídas em shards pelo hash da chave; cada shard tem seu próprio lock,
+ * índice e lista de recência intrusiva, então leituras e escritas de workers diferentes
+ * só disputam quando caem no mesmo shard. Os valores são imutáveis e compartilhados
+ * (TSharedRef thread-safe): um hit devolve uma referência, nunca uma cópia.
+ * Capacidade (entradas e bytes) é dividida igualmente entre os shards.
+ * LRU e Random escolhem a vítima em O(1); LFU, Priority e GDSF mantêm por shard um heap mínimo
+ * indexado pelo score (empates: a entrada menos recente), então escolher a vítima também é O(1)
+ * e cada acesso custa O(log n) sob o lock do shard.
+ * Entradas removidas por capacidade ou expiração podem ser entregues a um handler
+ * (ex.: um tier em disco), chamado fora dos locks.
+ */
+template <typename KeyType, typename ValueType>
+class TPlanetShardedCache
+{
+public:
+    using FValueRef = TSharedRef<const ValueType, ESPMode::ThreadSafe>;
+    using FValuePtr = TSharedPtr<const ValueType, ESPMode::ThreadSafe>;
+    using FEvictionHandler = TFunction<void(const KeyType&, const FValueRef&)>;
+
+    /** Metadados de uma entrada expostos às fachadas */
+    struct FEntryInfo
+    {
+        double LastAccessTime = 0.0;
+        int64 Bytes = 0;
+        int32 AccessCount = 0;
+        float Priority = 1.0f;
+        double Cost = 0.0;          // custo de regenerar (s); <= 0 conta como custo unitário
+        double Score = 0.0;         // GDSF: inflação + acessos * custo / bytes; Priority: inflação + prioridade
+    };
+
+    struct FStats
+    {
+        int32 Entries = 0;
+        int64 Bytes = 0;
+        int64 Hits = 0;
+        int64 Misses = 0;
+        int64 Evictions = 0;
+    };
+
+    explicit TPlanetShardedCache(int32 InNumShards = 16)
+    {
+        NumShards = int32(FMath::RoundUpToPowerOfTwo(uint32(FMath::Clamp(InNumShards, 1, 256))));
+        ShardBits = FMath::FloorLog2(uint32(NumShards));
+        Shards.Reserve(NumShards);
+        for (int32 i = 0; i < NumShards; ++i)
+        {
+            Shards.Add(MakeUnique<FShard>());
+            Shards.Last()->Random.Initialize(i);
+        }
+    }
+
+    TPlanetShardedCache(const TPlanetShardedCache&) = delete;
+    TPlanetShardedCache& operator=(const TPlanetShardedCache&) = delete;
+
+    // === CONFIGURAÇÃO ===
+
+    void SetMaxEntries(int32 InMaxEntries)
+    {
+        MaxEntries = FMath::Max(1, InMaxEntries);
+        TrimToFraction(1.0f);
+    }
+
+    /** 0 desativa o limite de bytes */
+    void SetMaxBytes(int64 InMaxBytes)
+    {
+        MaxBytes = FMath::Max<int64>(0, InMaxBytes);
+        TrimToFraction(1.0f);
+    }
+
+    /** Troca a política; os scores e heaps dos shards são refeitos */
+    void SetPolicy(EPlanetCachePolicy InPolicy)
+    {
+        Policy = InPolicy;
+        for (const TUniquePtr<FShard>& Shard : Shards)
+        {
+            FScopeLock Lock(&Shard->Mutex);
+            Shard->Policy = InPolicy;
+            for (FEntry& Entry : Shard->Entries)
+            {
+                if (Entry.bUsed)
+                {
+                    Entry.Info.Score = ComputeScore(*Shard, Entry.Info);
+                }
+            }
+            RebuildHeap(*Shard);
+        }
+    }
+
+    /** Recebe entradas removidas por capacidade ou expiração; definir antes do uso concorrente */
+    void SetEvictionHandler(FEvictionHandler InHandler) { EvictionHandler = MoveTemp(InHandler); }
+
+    int32 GetMaxEntries() const { return MaxEntries; }
+    int64 GetMaxBytes() const { return MaxBytes; }
+    EPlanetCachePolicy GetPolicy() const { return Policy; }
+    int32 GetNumShards() const { return NumShards; }
+
+    // === OPERAÇÕES (thread-safe) ===
+
+    /**
+     * Procura uma entrada e a marca como usada
+     * @param Key Chave
+     * @param MaxAge Entradas sem acesso há mais que isso (s) contam como miss e saem pelo handler, como em RemoveExpired; 0 ignora
+     * @return Valor compartilhado ou nullptr
+     */
+    FValuePtr Find(const KeyType& Key, double MaxAge = 0.0)
+    {
+        TArray<FEvicted> Expired;
+        FValuePtr Result;
+        {
+            FShard& Shard = GetShard(Key);
+            FScopeLock Lock(&Shard.Mutex);
+
+            const int32* Found = Shard.Index.Find(Key);
+            if (!Found)
+            {
+                Shard.Misses++;
+                return nullptr;
+            }
+
+            const int32 Slot = *Found;
+            FEntry& Entry = Shard.Entries[Slot];
+            const double Now = FPlatformTime::Seconds();
+            if (MaxAge > 0.0 && Now - Entry.Info.LastAccessTime > MaxAge)
+            {
+                Evict(Shard, Slot, &Expired);
+                Shard.Misses++;
+            }
+            else
+            {
+                Entry.Info.LastAccessTime = Now;
+                Entry.Info.AccessCount++;
+                Entry.Info.Score = ComputeScore(Shard, Entry.Info);
+                Entry.Sequence = ++Shard.Clock;
+                Unlink(Shard, Slot);
+                LinkFront(Shard, Slot);
+                HeapUpdate(Shard, Slot);
+                Shard.Hits++;
+                Result = Entry.Value;
+            }
+        }
+        NotifyEvicted(Expired);
+        return Result;
+    }
+
+    /** Procura sem alterar recência nem estatísticas */
+    FValuePtr Peek(const KeyType& Key) const
+    {
+        const FShard& Shard = GetShard(Key);
+        FScopeLock Lock(&Shard.Mutex);
+        const int32* Found = Shard.Index.Find(Key);
+        return Found ? Shard.Entries[*Found].Value : nullptr;
+    }
+
+    bool Contains(const KeyType& Key) const
+    {
+        const FShard& Shard = GetShard(Key);
+        FScopeLock Lock(&Shard.Mutex);
+        return Shard.Index.Contains(Key);
+    }
+
+    bool GetInfo(const KeyType& Key, FEntryInfo& OutInfo) const
+    {
+        const FShard& Shard = GetShard(Key);
+        FScopeLock Lock(&Shard.Mutex);
+        const int32* Found = Shard.Index.Find(Key);
+        if (Found)
+        {
+            OutInfo = Shard.Entries[*Found].Info;
+        }
+        return Found != nullptr;
+    }
+
+    /**
+     * Insere ou substitui uma entrada, removendo vítimas do shard até caber
+     * @param Key Chave
+     * @param Value Valor compartilhado (não é copiado)
+     * @param Bytes Tamanho contabilizado
+     * @param Priority Prioridade (política Priority; no LRU, < 1 entra na ponta fria, ex.: prefetch)
+     * @param Cost Custo de regenerar o valor em segundos (usado pela política GDSF)
+     */
+    void Store(const KeyType& Key, const FValueRef& Value, int64 Bytes, float Priority = 1.0f, double Cost = 0.0)
+    {
+        TArray<FEvicted> Evicted;
+        {
+            FShard& Shard = GetShard(Key);
+            FScopeLock Lock(&Shard.Mutex);
+
+            if (const int32* Existing = Shard.Index.Find(Key))
+            {
+                RemoveSlot(Shard, *Existing);
+            }
+
+            while (Shard.Tail != INDEX_NONE && IsOver(Shard, 1, Bytes, 1.0f))
+            {
+                EvictOne(Shard, &Evicted);
+            }
+
+            Insert(Shard, Key, Value, Bytes, Priority, Cost);
+        }
+        NotifyEvicted(Evicted);
+    }
+
+    bool Remove(const KeyType& Key)
+    {
+        FShard& Shard = GetShard(Key);
+        FScopeLock Lock(&Shard.Mutex);
+        if (const int32* Found = Shard.Index.Find(Key))
+        {
+            RemoveSlot(Shard, *Found);
+            return true;
+        }
+        return false;
+    }
+
+    void Clear()
+    {
+        for (const TUniquePtr<FShard>& Shard : Shards)
+        {
+            FScopeLock Lock(&Shard->Mutex);
+            Shard->Index.Empty();
+            Shard->Entries.Empty();
+            Shard->FreeSlots.Empty();
+            Shard->Heap.Empty();
+            Shard->Head = INDEX_NONE;
+            Shard->Tail = INDEX_NONE;
+            Shard->Bytes = 0;
+            Shard->Inflation = 0.0;
+        }
+    }
+
+    /**
+     * Remove entradas sem acesso há mais de MaxAge segundos
+     * O acesso mais antigo de cada shard está sempre na cauda da lista de recência.
+     * @return Número de entradas removidas
+     */
+    int32 RemoveExpired(double MaxAge)
+    {
+        const double Now = FPlatformTime::Seconds();
+        TArray<FEvicted> Evicted;
+        int32 Removed = 0;
+        for (const TUniquePtr<FShard>& Shard : Shards)
+        {
+            FScopeLock Lock(&Shard->Mutex);
+            while (Shard->Tail != INDEX_NONE && Now - Shard->Entries[Shard->Tail].Info.LastAccessTime > MaxAge)
+            {
+                Evict(*Shard, Shard->Tail, &Evicted);
+                Removed++;
+            }
+        }
+        NotifyEvicted(Evicted);
+        return Removed;
+    }
+
+    /**
+     * Remove vítimas (pela política) até cada shard ficar abaixo de Fraction da capacidade
+     * @return Número de entradas removidas
+     */
+    int32 TrimToFraction(float Fraction)
+    {
+        TArray<FEvicted> Evicted;
+        int32 Removed = 0;
+        for (const TUniquePtr<FShard>& Shard : Shards)
+        {
+            FScopeLock Lock(&Shard->Mutex);
+            while (Shard->Tail != INDEX_NONE && IsOver(*Shard, 0, 0, Fraction))
+            {
+                EvictOne(*Shard, &Evicted);
+                Removed++;
+            }
+        }
+        NotifyEvicted(Evicted);
+        return Removed;
+    }
+
+    /**
+     * Encolhe cada shard para KeepFraction do uso atual (entradas e bytes), pela política
+     * Usado sob pressão de memória, quando o limite configurado ainda não foi atingido: não aloca e não
+     * chama o handler de remoção (nada vai para outro tier), as entradas só são soltas.
+     * @return Número de entradas removidas
+     */
+    int32 TrimUsage(float KeepFraction)
+    {
+        int32 Removed = 0;
+        for (const TUniquePtr<FShard>& Shard : Shards)
+        {
+            FScopeLock Lock(&Shard->Mutex);
+            const int32 TargetEntries = int32(Shard->Index.Num() * KeepFraction);
+            const int64 TargetBytes = int64(Shard->Bytes * double(KeepFraction));
+            while (Shard->Tail != INDEX_NONE && (Shard->Index.Num() > TargetEntries || Shard->Bytes > TargetBytes))
+            {
+                EvictOne(*Shard, nullptr);
+                Removed++;
+            }
+        }
+        return Removed;
+    }
+
+    /** Visita todas as entradas (um shard por vez, com o lock do shard); Func(Key, Info) */
+    template <typename FuncType>
+    void ForEach(FuncType&& Func) const
+    {
+        for (const TUniquePtr<FShard>& Shard : Shards)
+        {
+            FScopeLock Lock(&Shard->Mutex);
+            for (const FEntry& Entry : Shard->Entries)
+            {
+                if (Entry.bUsed)
+                {
+                    Func(Entry.Key, Entry.Info);
+                }
+            }
+        }
+    }
+
+    // === ESTATÍSTICAS ===
+
+    FStats GetStats() const
+    {
+        FStats Stats;
+        for (const TUniquePtr<FShard>& Shard : Shards)
+        {
+            FScopeLock Lock(&Shard->Mutex);
+            Stats.Entries += Shard->Index.Num();
+            Stats.Bytes += Shard->Bytes;
+            Stats.Hits += Shard->Hits;
+            Stats.Misses += Shard->Misses;
+            Stats.Evictions += Shard->Evictions;
+        }
+        return Stats;
+    }
+
+    void ResetStats()
+    {
+        for (const TUniquePtr<FShard>& Shard : Shards)
+        {
+            FScopeLock Lock(&Shard->Mutex);
+            Shard->Hits = 0;
+            Shard->Misses = 0;
+            Shard->Evictions = 0;
+        }
+    }
+
+    int32 Num() const { return GetStats().Entries; }
+    int64 GetBytes() const { return GetStats().Bytes; }
+
+private:
+    struct FEntry
+    {
+        KeyType Key;
+        FValuePtr Value;
+        FEntryInfo Info;
+        int32 Prev = INDEX_NONE;
+        int32 Next = INDEX_NONE;
+        int32 HeapIndex = INDEX_NONE;
+        uint64 Sequence = 0;        // relógio do shard no último acesso: desempate do heap
+        bool bUsed = false;
+    };
+
+    /** Shard: índice chave -> slot, lista de recência (Head = mais recente) e heap de vítimas */
+    struct FShard
+    {
+        mutable FCriticalSection Mutex;
+        TMap<KeyType, int32> Index;
+        TArray<FEntry> Entries;
+        TArray<int32> FreeSlots;
+        TArray<int32> Heap;         // slots, menor score na raiz (só LFU, Priority e GDSF)
+        uint64 Clock = 0;
+        EPlanetCachePolicy Policy = EPlanetCachePolicy::LRU;
+        int32 Head = INDEX_NONE;
+        int32 Tail = INDEX_NONE;
+        int64 Bytes = 0;
+        int64 Hits = 0;
+        int64 Misses = 0;
+        int64 Evictions = 0;
+        double Inflation = 0.0;     // GDSF e Priority: score da última vítima
+        FRandomStream Random;
+    };
+
+    /**
+     * Prioridade GreedyDual-Size-Frequency: L + frequência * custo / tamanho
+     * Entradas caras e pequenas sobrevivem mais; a inflação L envelhece as que param de ser usadas.
+     * Na política Priority o valor é a própria prioridade (GreedyDual: L + prioridade), uma chave
+     * fixa entre acessos, ao contrário de idade * (1 - prioridade), que muda com o tempo e não cabe em um heap.
+     */
+    static double ComputeScore(const FShard& Shard, const FEntryInfo& Info)
+    {
+        if (Shard.Policy == EPlanetCachePolicy::Priority)
+        {
+            return Shard.Inflation + double(Info.Priority);
+        }
+
+        const double Cost = Info.Cost > 0.0 ? Info.Cost : 1.0;
+        return Shard.Inflation + double(Info.AccessCount) * Cost / double(FMath::Max<int64>(Info.Bytes, 1));
+    }
+
+    FShard& GetShard(const KeyType& Key) const
+    {
+        // bits altos do hash espalhado: os bits baixos continuam distribuindo os buckets do TMap do shard
+        const uint32 Hash = GetTypeHash(Key) * 0x9E3779B1u;
+        return *Shards[ShardBits > 0 ? int32(Hash >> (32 - ShardBits)) : 0];
+    }
+
+    bool IsOver(const FShard& Shard, int32 ExtraEntries, int64 ExtraBytes, float Fraction) const
+    {
+        const int32 ShardMaxEntries = FMath::Max(1, FMath::DivideAndRoundUp(int32(MaxEntries), NumShards));
+        if (Shard.Index.Num() + ExtraEntries > int32(ShardMaxEntries * Fraction))
+        {
+            return true;
+        }
+
+        const int64 TotalMaxBytes = MaxBytes;
+        const int64 ShardMaxBytes = TotalMaxBytes > 0 ? FMath::Max<int64>(1, TotalMaxBytes / NumShards) : 0;
+        return ShardMaxBytes > 0 && Shard.Bytes + ExtraBytes > int64(ShardMaxBytes * double(Fraction));
+    }
+
+    void Insert(FShard& Shard, const KeyType& Key, const FValueRef& Value, int64 Bytes, float Priority, double Cost)
+    {
+        const int32 Slot = Shard.FreeSlots.Num() > 0 ? Shard.FreeSlots.Pop(false) : Shard.Entries.AddDefaulted();
+        FEntry& Entry = Shard.Entries[Slot];
+        Entry.Key = Key;
+        Entry.Value = Value;
+        Entry.Info.LastAccessTime = FPlatformTime::Seconds();
+        Entry.Info.Bytes = Bytes;
+        Entry.Info.AccessCount = 1;
+        Entry.Info.Priority = Priority;
+        Entry.Info.Cost = Cost;
+        Entry.Info.Score = ComputeScore(Shard, Entry.Info);
+        Entry.Sequence = ++Shard.Clock;
+        Entry.bUsed = true;
+
+        Shard.Bytes += Bytes;
+        Shard.Index.Add(Key, Slot);
+        if (Shard.Policy == EPlanetCachePolicy::LRU && Priority < 1.0f)
+        {
+            // especulativa: é a próxima vítima até o primeiro acesso de verdade levá-la para a frente
+            LinkBack(Shard, Slot);
+        }
+        else
+        {
+            LinkFront(Shard, Slot);
+        }
+        HeapPush(Shard, Slot);
+    }
+
+    /** Entrada removida por capacidade/expiração, entregue ao handler depois de soltar o lock */
+    struct FEvicted
+    {
+        KeyType Key;
+        FValueRef Value;
+    };
+
+    /** OutEvicted nulo: a entrada não passa pelo handler (o valor é solto aqui mesmo) */
+    void Evict(FShard& Shard, int32 Slot, TArray<FEvicted>* OutEvicted)
+    {
+        if (OutEvicted && EvictionHandler)
+        {
+            const FEntry& Entry = Shard.Entries[Slot];
+            OutEvicted->Add(FEvicted{ Entry.Key, Entry.Value.ToSharedRef() });
+        }
+        RemoveSlot(Shard, Slot);
+    }
+
+    void EvictOne(FShard& Shard, TArray<FEvicted>* OutEvicted)
+    {
+        const int32 Victim = SelectVictim(Shard);
+        if (Shard.Policy == EPlanetCachePolicy::GDSF || Shard.Policy == EPlanetCachePolicy::Priority)
+        {
+            Shard.Inflation = FMath::Max(Shard.Inflation, Shard.Entries[Victim].Info.Score);
+        }
+        Evict(Shard, Victim, OutEvicted);
+        Shard.Evictions++;
+    }
+
+    void NotifyEvicted(const TArray<FEvicted>& Evicted) const
+    {
+        for (const FEvicted& Item : Evicted)
+        {
+            EvictionHandler(Item.Key, Item.Value);
+        }
+    }
+
+    /** Vítima do shard pela política atual; empates ficam com a entrada menos recente */
+    int32 SelectVictim(FShard& Shard) const
+    {
+        if (UsesHeap(Shard.Policy))
+        {
+            return Shard.Heap[0];
+        }
+
+        if (Shard.Policy == EPlanetCachePolicy::Random)
+        {
+            for (int32 Attempt = 0; Attempt < 8; ++Attempt)
+            {
+                const int32 Slot = Shard.Random.RandRange(0, Shard.Entries.Num() - 1);
+                if (Shard.Entries[Slot].bUsed)
+                {
+                    return Slot;
+                }
+            }
+        }
+        return Shard.Tail;
+    }
+
+    // === HEAP DE VÍTIMAS (LFU, Priority, GDSF) ===
+
+    static bool UsesHeap(EPlanetCachePolicy InPolicy)
+    {
+        return InPolicy == EPlanetCachePolicy::LFU || InPolicy == EPlanetCachePolicy::GDSF || InPolicy == EPlanetCachePolicy::Priority;
+    }
+
+    /** Ordem do heap: menor score primeiro (LFU: menos acessos), depois o acesso mais antigo */
+    static bool HeapLess(const FShard& Shard, int32 SlotA, int32 SlotB)
+    {
+        const FEntry& A = Shard.Entries[SlotA];
+        const FEntry& B = Shard.Entries[SlotB];
+        const double KeyA = Shard.Policy == EPlanetCachePolicy::LFU ? double(A.Info.AccessCount) : A.Info.Score;
+        const double KeyB = Shard.Policy == EPlanetCachePolicy::LFU ? double(B.Info.AccessCount) : B.Info.Score;
+        return KeyA != KeyB ? KeyA < KeyB : A.Sequence < B.Sequence;
+    }
+
+    static void HeapSwap(FShard& Shard, int32 I, int32 J)
+    {
+        Swap(Shard.Heap[I], Shard.Heap[J]);
+        Shard.Entries[Shard.Heap[I]].HeapIndex = I;
+        Shard.Entries[Shard.Heap[J]].HeapIndex = J;
+    }
+
+    static void SiftUp(FShard& Shard, int32 I)
+    {
+        while (I > 0)
+        {
+            const int32 Parent = (I - 1) / 2;
+            if (!HeapLess(Shard, Shard.Heap[I], Shard.Heap[Parent]))
+            {
+                break;
+            }
+            HeapSwap(Shard, I, Parent);
+            I = Parent;
+        }
+    }
+
+    static void SiftDown(FShard& Shard, int32 I)
+    {
+        const int32 Num = Shard.Heap.Num();
+        for (;;)
+        {
+            const int32 Left = 2 * I + 1;
+            const int32 Right = Left + 1;
+            int32 Smallest = I;
+            if (Left < Num && HeapLess(Shard, Shard.Heap[Left], Shard.Heap[Smallest]))
+            {
+                Smallest = Left;
+            }
+            if (Right < Num && HeapLess(Shard, Shard.Heap[Right], Shard.Heap[Smallest]))
+            {
+                Smallest = Right;
+            }
+            if (Smallest == I)
+            {
+                break;
+            }
+            HeapSwap(Shard, I, Smallest);
+            I = Smallest;
+        }
+    }
+
+    static void HeapPush(FShard& Shard, int32 Slot)
+    {
+        if (UsesHeap(Shard.Policy))
+        {
+            Shard.Entries[Slot].HeapIndex = Shard.Heap.Add(Slot);
+            SiftUp(Shard, Shard.Entries[Slot].HeapIndex);
+        }
+    }
+
+    static void HeapRemove(FShard& Shard, int32 Slot)
+    {
+        const int32 I = Shard.Entries[Slot].HeapIndex;
+        if (I == INDEX_NONE)
+        {
+            return;
+        }
+
+        const int32 Last = Shard.Heap.Num() - 1;
+        if (I != Last)
+        {
+            HeapSwap(Shard, I, Last);
+        }
+        Shard.Heap.Pop(false);
+        Shard.Entries[Slot].HeapIndex = INDEX_NONE;
+        if (I != Last)
+        {
+            HeapUpdate(Shard, Shard.Heap[I]);
+        }
+    }
+
+    /** Reposiciona uma entrada cujo score mudou */
+    static void HeapUpdate(FShard& Shard, int32 Slot)
+    {
+        const int32 I = Shard.Entries[Slot].HeapIndex;
+        if (I != INDEX_NONE)
+        {
+            SiftUp(Shard, I);
+            SiftDown(Shard, Shard.Entries[Slot].HeapIndex);
+        }
+    }
+
+    static void RebuildHeap(FShard& Shard)
+    {
+        Shard.Heap.Reset();
+        for (int32 Slot = 0; Slot < Shard.Entries.Num(); ++Slot)
+        {
+            FEntry& Entry = Shard.Entries[Slot];
+            Entry.HeapIndex = INDEX_NONE;
+            if (Entry.bUsed && UsesHeap(Shard.Policy))
+            {
+                Entry.HeapIndex = Shard.Heap.Add(Slot);
+            }
+        }
+        for (int32 I = Shard.Heap.Num() / 2 - 1; I >= 0; --I)
+        {
+            SiftDown(Shard, I);
+        }
+    }
+
+    static void LinkFront(FShard& Shard, int32 Slot)
+    {
+        FEntry& Entry = Shard.Entries[Slot];
+        Entry.Prev = INDEX_NONE;
+        Entry.Next = Shard.Head;
+        if (Shard.Head != INDEX_NONE)
+        {
+            Shard.Entries[Shard.Head].Prev = Slot;
+        }
+        Shard.Head = Slot;
+        if (Shard.Tail == INDEX_NONE)
+        {
+            Shard.Tail = Slot;
+        }
+    }
+
+    static void LinkBack(FShard& Shard, int32 Slot)
+    {
+        FEntry& Entry = Shard.Entries[Slot];
+        Entry.Prev = Shard.Tail;
+        Entry.Next = INDEX_NONE;
+        if (Shard.Tail != INDEX_NONE)
+        {
+            Shard.Entries[Shard.Tail].Next = Slot;
+        }
+        Shard.Tail = Slot;
+        if (Shard.Head == INDEX_NONE)
+        {
+            Shard.Head = Slot;
+        }
+    }
+
+    static void Unlink(FShard& Shard, int32 Slot)
+    {
+        FEntry& Entry = Shard.Entries[Slot];
+        if (Entry.Prev != INDEX_NONE)
+        {
+            Shard.Entries[Entry.Prev].Next = Entry.Next;
+        }
+        else
+        {
+            Shard.Head = Entry.Next;
+        }
+
+        if (Entry.Next != INDEX_NONE)
+        {
+            Shard.Entries[Entry.Next].Prev = Entry.Prev;
+        }
+        else
+        {
+            Shard.Tail = Entry.Prev;
+        }
+
+        Entry.Prev = INDEX_NONE;
+        Entry.Next = INDEX_NONE;
+    }
+
+    static void RemoveSlot(FShard& Shard, int32 Slot)
+    {
+        Unlink(Shard, Slot);
+        HeapRemove(Shard, Slot);
+
+        FEntry& Entry = Shard.Entries[Slot];
+        Shard.Index.Remove(Entry.Key);
+        Shard.Bytes -= Entry.Info.Bytes;
+
+        // solta a referência do cache; quem ainda usa o valor o mantém vivo
+        Entry.Value.Reset();
+        Entry.Info = FEntryInfo();
+        Entry.Sequence = 0;
+        Entry.bUsed = false;
+        Shard.FreeSlots.Add(Slot);
+    }
+
+    int32 NumShards = 1;
+    int32 ShardBits = 0;
+    TArray<TUniquePtr<FShard>> Shards;
+
+    std::atomic<int32> MaxEntries { 1000 };
+    std::atomic<int64> MaxBytes { 0 };
+    std::atomic<EPlanetCachePolicy> Policy { EPlanetCachePolicy::LRU };
+
+    FEvictionHandler EvictionHandler;
+};
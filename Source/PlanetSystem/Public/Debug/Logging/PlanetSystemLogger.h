@@ -1,6 +1,7 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Engine/Engine.h"
+#include "HAL/CriticalSection.h"
 #include "PlanetSystemLogger.generated.h"
 
 /**
@@ -79,6 +80,9 @@ private:
     UPROPERTY()
     FDateTime StartTime;
     
+    /** Protege buffer, contadores, filtros e arquivo: caches e workers logam de qualquer thread */
+    mutable FCriticalSection LogLock;
+    
 public:
     UPlanetSystemLogger();
     
@@ -45,4 +45,7 @@ public:
     FNoiseConfig GetNoiseConfig() const;
 
     float GetHeight(const FVector& Dir) const;
+
+    /** Maior |GetHeight| possível: soma das amplitudes das oitavas, cada uma em [-1, 1] */
+    float GetMaxAmplitude() const;
 };
@@ -0,0 +1,96 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Rendering/Chunks/ChunkCache.h"
+
+struct FPatchNode;
+struct FPlanetLODViewer;
+class UNoiseModule;
+
+/**
+ * Prefetch de chunks guiado pela velocidade dos observadores
+ * Extrapola a posição de cada observador em movimento, percorre a quadtree com o mesmo critério de
+ * subdivisão do LOD (só horizonte: a orientação futura é desconhecida) e enfileira as folhas que ainda
+ * não estão no cache. A fila é refeita a cada atualização do LOD, então pedidos de uma trajetória
+ * abandonada são cancelados antes de gerar. A geração roda no game thread com orçamento de tempo,
+ * depois dos patches visíveis: noise, erosão e biomas não são thread-safe.
+ */
+class PLANETSYSTEM_API FChunkPrefetcher
+{
+public:
+    struct FParams
+    {
+        float PlanetRadius = 1000.f;
+        int32 MaxLOD = 8;
+        float SplitFactor = 2.5f;
+        float MinAltitude = 0.f;     // faixa de altitude usada para estimar os limites
+        float MaxAltitude = 0.f;
+        float HorizonSeconds = 2.f;  // quanto à frente prever
+        uint32 KeySeed = 0;          // parte de toda chave do cache
+    };
+
+    struct FStats
+    {
+        int32 Queued = 0;
+        int64 Requested = 0;
+        int64 Generated = 0;
+        int64 Promoted = 0;          // já estava no tier comprimido ou no disco: só promovido para a memória
+        int64 Cancelled = 0;
+    };
+
+    /** Amostras por trajetória, espaçadas igualmente até o horizonte */
+    static constexpr int32 TrajectorySteps = 4;
+
+    /** Observadores mais lentos que isso (unidades/s) não geram previsões */
+    static constexpr float MinSpeed = 1.f;
+
+    /** Prioridade de cache dos chunks prefetched: saem antes dos que já foram vistos (no LRU, entram na ponta fria) */
+    static constexpr float CachePriority = 0.5f;
+
+    /**
+     * Refaz a fila a partir das trajetórias atuais; pedidos que não aparecem mais são cancelados
+     * @param Roots Raízes da quadtree
+     * @param Viewers Observadores do LOD (origem e velocidade em espaço de mundo)
+     * @param PlanetTransform Transform do planeta
+     * @param Params Critérios de LOD e horizonte de previsão
+     * @param Cache Cache consultado para descartar o que já está residente
+     */
+    void Update(const TArray<FPatchNode*>& Roots, TArrayView<const FPlanetLODViewer> Viewers, const FTransform& PlanetTransform,
+                const FParams& Params, const UChunkCache& Cache);
+
+    /**
+     * Gera pedidos da fila, mais urgentes primeiro, até esgotar o orçamento
+     * @return Número de chunks gerados ou promovidos do disco
+     */
+    int32 Process(const TArray<FPatchNode*>& Roots, UChunkCache& Cache, float PlanetRadius, UNoiseModule* Noise, double BudgetSeconds);
+
+    /** Descarta a fila (ex.: prefetch desligado ou planeta reconfigurado) */
+    void Cancel();
+
+    FStats GetStats() const;
+
+private:
+    struct FRequest
+    {
+        FChunkKey Key;
+        uint8 Face = 0;
+        int32 Level = 0;
+        FVector2D UVMin;
+        FVector2D UVMax;
+        float Time = 0.f;            // segundos até o observador precisar do patch
+        float Distance = 0.f;        // distância prevista nesse instante
+    };
+
+    /** Folhas que o LOD escolheria para um observador na posição prevista */
+    void CollectLeaves(const TArray<FPatchNode*>& Roots, const FVector& Origin, const FVector& PlanetCenter, float OccluderRadius,
+                       const FTransform& PlanetTransform, const FParams& Params, int32 PatchBudget, float Time,
+                       const UChunkCache& Cache, TSet<FChunkKey>& Index, TArray<FRequest>& OutRequests) const;
+
+    /** Ordenada do mais urgente ao menos urgente; Process consome pelo início */
+    TArray<FRequest> Queue;
+    int32 Head = 0;
+
+    int64 Requested = 0;
+    int64 Generated = 0;
+    int64 Promoted = 0;
+    int64 Cancelled = 0;
+};
@@ -2,18 +2,32 @@
 #include "CoreMinimal.h"
 #include "Services/Terrain/ErosionModule.h"
 #include "Generation/Noise/NoiseModule.h"
+#include "Rendering/Chunks/ChunkCache.h"
 
 struct FPatchNode
 {
     int32 Level;
+    uint8 Face = 0;                  // raiz de origem (parte da chave do cache)
     FVector2D UVMin, UVMax;
     uint32 PatchSeed;
-    TArray<FVector> Vertices;
-    TArray<int32> Indices;
+    FChunkDataPtr RenderData;        // malha gerada (vértices, índices, biomas), compartilhada com o cache
+    int32 Resolution = 0;
+    float MinAltitude = 0.f;         // altitude mínima/máxima acima do raio base
+    float MaxAltitude = 0.f;
+    FBox Bounds = FBox(ForceInit);   // limites no espaço do planeta
+    FSphere BoundingSphere = FSphere(ForceInit);
+    bool bHasExactBounds = false;    // false: limites estimados (patch ainda não gerado)
+    TArray<float> CollisionHeights;  // altitude por vértice da grade de colisão
+    TArray<int32> CollisionIndices;
+    int32 CollisionResolution = 0;
     struct UErosionModule* ErosionModule = nullptr;
+    class UBiomeSystem* BiomeSystem = nullptr;
     FPatchNode* Children[4] = { nullptr, nullptr, nullptr, nullptr };
     bool bIsSplit = false;
 
+    /** Células por lado da malha de render no nível 0 */
+    static constexpr int32 BaseResolution = 8;
+
     FPatchNode(int32 InLevel, const FVector2D& InMin, const FVector2D& InMax)
         : Level(InLevel), UVMin(InMin), UVMax(InMax)
     {
@@ -28,6 +42,63 @@ struct FPatchNode
             delete Child;
     }
 
+    /** Identificador estável do patch (nível + seed) */
+    uint64 GetPatchId() const { return (uint64(Level) << 32) | PatchSeed; }
+
     void Subdivide();
-    void GenerateMesh(class UProceduralMeshComponent* MeshComp, float PlanetRadius, class UNoiseModule* Noise);
+
+    /** Região UV do filho Index (0..3), a mesma que Subdivide usa: a seed e a chave do cache dependem dela */
+    static void GetChildUV(int32 Index, const FVector2D& InMin, const FVector2D& InMax, FVector2D& OutMin, FVector2D& OutMax);
+
+    /** Descarta os filhos e volta a ser folha */
+    void Merge();
+
+    /** Recalcula altitude mínima/máxima e limites a partir dos vértices gerados */
+    void ComputeBounds(float PlanetRadius, TArrayView<const FVector> Points);
+
+    /** Adota um payload já gerado (ex.: vindo do cache) sem copiar os arrays */
+    void SetRenderData(const FChunkDataRef& Data);
+
+    /** O patch tem malha gerada ou adotada do cache */
+    bool HasRenderData() const { return RenderData.IsValid(); }
+
+    /**
+     * Limites conservadores sem gerar o patch: região UV projetada entre duas altitudes
+     * @param PlanetRadius Raio base
+     * @param InMinAltitude Altitude mínima esperada
+     * @param InMaxAltitude Altitude máxima esperada
+     */
+    void EstimateBounds(float PlanetRadius, float InMinAltitude, float InMaxAltitude);
+    void GenerateMesh(class UProceduralMeshComponent* MeshComp, int32 SectionIndex, float PlanetRadius, class UNoiseModule* Noise);
+
+    /**
+     * Gera o payload de render (noise, erosão, biomas) sem criar seção de mesh; usado pelo prefetch
+     * @param PlanetRadius Raio base
+     * @param Noise Módulo de noise (a seed é trocada pela do patch)
+     */
+    FChunkDataRef BuildRenderData(float PlanetRadius, class UNoiseModule* Noise);
+
+    /** Resolução da malha de render neste nível */
+    int32 GetRenderResolution() const { return FPlanetGenerationConfig::GetGridResolution(BaseResolution, Level); }
+
+    /** Resolução da grade de colisão: a de render deslocada por ResolutionShift (mínimo 2) */
+    int32 GetCollisionResolution(int32 ResolutionShift) const;
+
+    /**
+     * Gera apenas alturas e índices para física: sem biomas, vegetação, água nem seção de mesh
+     * Com payload de render, subamostra a superfície de render; sem ele, noise e erosão rodam na resolução de colisão
+     * @param PlanetRadius Raio base
+     * @param Noise Módulo de noise
+     * @param ResolutionShift Redução da resolução em relação ao render
+     */
+    void GenerateCollision(float PlanetRadius, class UNoiseModule* Noise, int32 ResolutionShift);
+
+    bool HasCollision() const { return CollisionHeights.Num() > 0; }
+
+    /** Posição no espaço do planeta de um vértice da grade de colisão */
+    FVector GetCollisionVertex(int32 Index, float PlanetRadius) const;
+
+private:
+    /** Grade de noise com erosão na resolução Res (render, ou colisão quando não há payload de render) */
+    void BuildSurface(float PlanetRadius, UNoiseModule* Noise, int32 Res, TArray<FVector>& OutVertices) const;
 };
@@ -39,6 +39,23 @@ public:
     UFUNCTION(BlueprintCallable, Category="Terrain Generation")
     FPlanetChunk GenerateTerrainChunk(const FVector& Center, int32 LODLevel);
 
+    /**
+     * Gera apenas alturas e índices para física (servidores)
+     * Pula biomas, vegetação e água; a resolução segue GetCollisionResolution
+     * @param Center - Centro do chunk
+     * @param LODLevel - Nível de detalhe
+     * @return Chunk com HeightMap e CollisionIndices
+     */
+    UFUNCTION(BlueprintCallable, Category="Terrain Generation")
+    FPlanetChunk GenerateCollisionChunk(const FVector& Center, int32 LODLevel);
+
+    /**
+     * Resolução da grade de colisão para um LOD
+     * @param LODLevel - Nível de detalhe
+     * @return Lado da grade (mínimo 2)
+     */
+    int32 GetCollisionResolution(int32 LODLevel) const;
+
     /**
      * Aplica biomas ao chunk
      * @param Chunk - Chunk a ser modificado
@@ -51,9 +68,10 @@ public:
      * Gera vegetação para o chunk
      * @param Chunk - Chunk base
      * @param OutVegetation - Vegetação gerada
+     * @param OutBounds - Limites usados na quantização das posições (FPlanetChunk::VegetationBounds)
      */
     UFUNCTION(BlueprintCallable, Category="Terrain Generation")
-    void GenerateVegetationForChunk(const FPlanetChunk& Chunk, TArray<FVegetationInstance>& OutVegetation);
+    void GenerateVegetationForChunk(const FPlanetChunk& Chunk, TArray<FPackedVegetationInstance>& OutVegetation, FBox& OutBounds);
 
     /**
      * Gera sistema de água para o chunk
@@ -63,6 +81,13 @@ public:
     UFUNCTION(BlueprintCallable, Category="Terrain Generation")
     void GenerateWaterSystem(const FPlanetChunk& Chunk, FWaterSystem& OutWaterSystem);
 
+    /**
+     * Libera o que o chunk deixou em sistemas compartilhados (tile da rede de rios)
+     * @param Chunk - Chunk descarregado
+     */
+    UFUNCTION(BlueprintCallable, Category="Terrain Generation")
+    void ReleaseChunk(const FPlanetChunk& Chunk);
+
     // === CONFIGURAÇÃO ===
     
     /**
@@ -105,6 +130,14 @@ protected:
      */
     void GenerateHeightMap(const FVector& Center, int32 LODLevel, TArray<float>& OutHeightMap);
 
+    /**
+     * Gera mapa de altura com resolução explícita
+     * @param Center - Centro do chunk
+     * @param Resolution - Lado da grade
+     * @param OutHeightMap - Mapa de altura gerado
+     */
+    void GenerateHeightGrid(const FVector& Center, int32 Resolution, TArray<float>& OutHeightMap);
+
     /**
      * Aplica erosão ao mapa de altura
      * @param HeightMap - Mapa de altura a ser modificado
@@ -113,18 +146,23 @@ protected:
     void ApplyErosion(TArray<float>& HeightMap, const FErosionConfig& ErosionConfig);
 
     /**
-     * Gera mapa de biomas
+     * Gera mapa de biomas por vértice (altura, inclinação, temperatura e umidade)
+     * @param Center - Centro do chunk (define a latitude)
      * @param HeightMap - Mapa de altura base
      * @param OutBiomeMap - Mapa de biomas gerado
      */
-    void GenerateBiomeMap(const TArray<float>& HeightMap, TArray<EBiomeType>& OutBiomeMap);
+    void GenerateBiomeMap(const FVector& Center, const TArray<float>& HeightMap, TArray<EBiomeType>& OutBiomeMap);
 
     /**
-     * Gera mapa de vegetação
+     * Gera mapa de vegetação com distribuição Poisson-disk determinística
+     * @param Center - Centro do chunk (posiciona a janela no ladrilho de amostras)
+     * @param HeightMap - Mapa de altura do chunk (altura das instâncias)
      * @param BiomeMap - Mapa de biomas base
      * @param OutVegetation - Vegetação gerada
+     * @param OutBounds - Limites das instâncias, usados na quantização das posições
      */
-    void GenerateVegetationMap(const TArray<EBiomeType>& BiomeMap, TArray<FVegetationInstance>& OutVegetation);
+    void GenerateVegetationMap(const FVector& Center, const TArray<float>& HeightMap, const TArray<EBiomeType>& BiomeMap,
+                               TArray<FPackedVegetationInstance>& OutVegetation, FBox& OutBounds);
 
     /**
      * Calcula temperatura baseada na latitude
@@ -5,8 +5,29 @@
 #include "Configuration/DataAssets/CoreConfig.h"
 #include "Services/Core/ServiceLocator.h"
 #include "Rendering/Chunks/ChunkCache.h"
+#include "Rendering/Culling/PlanetCulling.h"
+#include "Generation/Terrain/SurfaceHeightQuery.h"
+#include "Generation/Terrain/ChunkPrefetcher.h"
 #include "ProceduralPlanet.generated.h"
 
+class APlayerController;
+
+UENUM(BlueprintType)
+enum class EPlanetGenerationMode : uint8
+{
+    Auto            UMETA(DisplayName="Auto (collision only on dedicated servers)"),
+    Full            UMETA(DisplayName="Full"),
+    CollisionOnly   UMETA(DisplayName="Collision Only")
+};
+
+/** One viewer driving LOD refinement: its culling view and how many extra patches it may cause */
+struct FPlanetLODViewer
+{
+    FPlanetCullingView View;
+    int32 PatchBudget = 0;
+    FVector Velocity = FVector::ZeroVector;   // world units per second, drives prefetching
+};
+
 UCLASS()
 class PLANETSYSTEM_API AProceduralPlanet : public AActor
 {
@@ -27,6 +48,37 @@ protected:
     
     UFUNCTION(BlueprintCallable, Category="Planet")
     void GetPerformanceStats(int32& OutTotalChunks, int32& OutCachedChunks, float& OutCacheHitRate);
+    
+    /** Extra viewer positions refined alongside the players (e.g. AI or replay cameras on a server) */
+    UFUNCTION(BlueprintCallable, Category="Planet")
+    void SetAdditionalViewers(const TArray<FVector>& Locations);
+    
+    /** Overrides MaxPatchesPerViewer for one player; a negative budget restores the default */
+    UFUNCTION(BlueprintCallable, Category="Planet")
+    void SetViewerPatchBudget(APlayerController* Player, int32 Budget);
+    
+    UFUNCTION(BlueprintCallable, Category="Planet")
+    bool IsCollisionOnly() const;
+
+public:
+    /** Leaf patches selected by the last LOD update (render or collision data, depending on the mode) */
+    const TArray<FPatchNode*>& GetActivePatches() const { return ActivePatches; }
+    
+    /**
+     * Surface altitude above the base radius along a planet-space direction.
+     * Samples the finest generated patch (eroded heights) and falls back to cached noise tiles.
+     */
+    UFUNCTION(BlueprintCallable, Category="Planet")
+    float GetSurfaceHeight(const FVector& Dir);
+    
+    /** Batched GetSurfaceHeight; OutHeights matches Dirs */
+    UFUNCTION(BlueprintCallable, Category="Planet")
+    void GetSurfaceHeights(const TArray<FVector>& Dirs, TArray<float>& OutHeights);
+
+protected:
+    /** Collision-only patches carry heights and indices for physics; no mesh sections, biomes, vegetation or water */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Planet")
+    EPlanetGenerationMode GenerationMode = EPlanetGenerationMode::Auto;
 
 private:
     UPROPERTY()
@@ -39,13 +91,30 @@ private:
     UChunkCache* ChunkCache = nullptr;
     
     TArray<FPatchNode*> Roots;
+    uint32 ChunkKeySeed = 0;   // hash of the generation config, part of every cache key
+    TArray<FPatchNode*> ActivePatches;
+    FSurfaceHeightQuery HeightQuery;
+    FChunkPrefetcher Prefetcher;     // patches moving viewers will need soon, generated after the visible ones
     FTimerHandle LODTimer;
     FTimerHandle CacheCleanupTimer;
 
     void InitializeQuadTrees();
     void UpdateLOD();
+    
+    // Hash of everything that shapes a chunk (noise, radius, erosion and biome settings)
+    uint32 ComputeChunkKeySeed() const;
     void InitializeServices();
     void CleanupCache();
+    int32 BuildLODViewers(TArray<FPlanetLODViewer>& OutViewers, float PlanetRadius) const;
+    
+    // Largest |altitude| noise plus erosion can produce: conservative bounds for patches not built yet
+    float GetAltitudeBound() const;
+    
+    // Viewers are tracked per node in a 64-bit mask
+    static constexpr int32 MaxLODViewers = 64;
+    
+    TArray<FVector> AdditionalViewers;
+    TMap<TWeakObjectPtr<const APlayerController>, int32> ViewerBudgets;
     
     // Performance tracking
     double LastLODUpdateTime = 0.0;
@@ -0,0 +1,67 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FPatchNode;
+class UNoiseModule;
+
+/**
+ * Consulta de altura da superfície por direção
+ * Amostra bilinearmente o patch gerado mais fino que contém a direção (render ou colisão,
+ * já com erosão). Fora da área gerada, avalia o noise em tiles sob demanda guardados em um LRU pequeno.
+ */
+class PLANETSYSTEM_API FSurfaceHeightQuery
+{
+public:
+    /** Nível de subdivisão UV dos tiles sob demanda */
+    static constexpr int32 TileLevel = 6;
+    /** Lado da grade de cada tile sob demanda (TileResolution+1 amostras) */
+    static constexpr int32 TileResolution = 8;
+
+    explicit FSurfaceHeightQuery(int32 InMaxTiles = 64);
+
+    /**
+     * Altitude da superfície acima do raio base
+     * @param Roots Raízes da quadtree do planeta
+     * @param Dir Direção no espaço do planeta
+     * @param PlanetRadius Raio base
+     * @param Noise Noise usado quando nenhum patch cobre a direção
+     */
+    float GetHeight(const TArray<FPatchNode*>& Roots, const FVector& Dir, float PlanetRadius, UNoiseModule* Noise);
+
+    /** Versão em lote: OutHeights[i] corresponde a Dirs[i] */
+    void GetHeights(const TArray<FPatchNode*>& Roots, TArrayView<const FVector> Dirs, float PlanetRadius,
+                    UNoiseModule* Noise, TArrayView<float> OutHeights);
+
+    /** Descarta os tiles sob demanda (ex.: noise reconfigurado) */
+    void Reset();
+
+    void GetStats(int32& OutPatchHits, int32& OutTileHits, int32& OutTileMisses) const;
+
+private:
+    struct FTile
+    {
+        uint64 Key = 0;             // seed do noise (32 bits altos) e célula (X, Y)
+        uint64 LastUsed = 0;
+        TArray<float> Heights;
+    };
+
+    /** Coordenadas UV da face a partir da direção; false fora da face */
+    static bool DirToUV(const FVector& Dir, FVector2D& OutUV);
+
+    /** Patch mais profundo que contém UV; bWithData exige alturas geradas */
+    static const FPatchNode* FindPatch(const TArray<FPatchNode*>& Roots, const FVector2D& UV, bool bWithData);
+
+    static float SamplePatch(const FPatchNode& Patch, const FVector2D& UV, float PlanetRadius);
+
+    float SampleTile(const TArray<FPatchNode*>& Roots, const FVector2D& UV, UNoiseModule* Noise);
+    FTile& FindOrBuildTile(const TArray<FPatchNode*>& Roots, int32 CellX, int32 CellY, UNoiseModule* Noise);
+
+    int32 MaxTiles;
+    TArray<FTile> Tiles;
+    TMap<uint64, int32> TileIndex;
+    uint64 UseCounter = 0;
+
+    int32 PatchHits = 0;
+    int32 TileHits = 0;
+    int32 TileMisses = 0;
+};
@@ -4,6 +4,8 @@
 #include "UObject/Object.h"
 #include "Configuration/DataAssets/CoreConfig.h"
 #include "Core/Cache/PlanetCachePolicy.h"
+#include "Core/Cache/PlanetShardedCache.h"
+#include "Core/Cache/PlanetCacheInstrumentation.h"
 #include "Common/PlanetTypes.h"
 #include "PlanetChunkNetworkCache.generated.h"
 
@@ -14,6 +16,10 @@ class UPlanetEventBus;
 /**
  * Sistema de cache distribuído para chunks de planeta
  * Implementa cache inteligente com sincronização de rede
+ * Fachada sobre TPlanetShardedCache: a política de substituição é aplicada pelo núcleo,
+ * e sincronização/busca podem ser chamadas de threads de rede
+ * Sincronização e busca só contam em FPlanetCacheInstrumentation; a mensagem de log (que passa pelo
+ * lock do logger e pelo arquivo) fica para as operações amostradas ou para o modo verbose
  */
 UCLASS(Blueprintable, BlueprintType)
 class PLANETSYSTEM_API UPlanetChunkNetworkCache : public UObject
@@ -22,6 +28,9 @@ class PLANETSYSTEM_API UPlanetChunkNetworkCache : public UObject
 
 public:
     UPlanetChunkNetworkCache();
+    
+    virtual void PostInitProperties() override;
+    virtual void BeginDestroy() override;
 
     // === SINCRONIZAÇÃO DE CHUNKS ===
     
@@ -72,6 +81,20 @@ public:
     UFUNCTION(BlueprintCallable, Category="Network Cache")
     int32 GetCacheSize() const;
     
+    /**
+     * Obtém a memória ocupada pelos chunks do cache
+     * @return Bytes alocados
+     */
+    UFUNCTION(BlueprintCallable, Category="Network Cache")
+    int64 GetCacheBytes() const;
+    
+    /**
+     * Define limite de memória do cache
+     * @param MaxBytes - Limite em bytes (0 = apenas limite de entradas)
+     */
+    UFUNCTION(BlueprintCallable, Category="Network Cache")
+    void SetMaxCacheBytes(int64 MaxBytes);
+    
     /**
      * Verifica se cache está cheio
      * @return True se cheio
@@ -132,21 +155,8 @@ public:
 protected:
     // === ESTRUTURAS DE DADOS ===
     
-    /** Cache de chunks em rede */
-    UPROPERTY()
-    TMap<FVector, FPlanetChunk> NetworkedChunks;
-    
-    /** Timestamps de chunks */
-    UPROPERTY()
-    TMap<FVector, float> ChunkTimestamps;
-    
-    /** Contadores de acesso */
-    UPROPERTY()
-    TMap<FVector, int32> ChunkAccessCounts;
-    
-    /** Ordem de acesso (LRU) */
-    UPROPERTY()
-    TArray<FVector> AccessOrder;
+    /** Núcleo do cache de chunks em rede (thread-safe) */
+    TPlanetShardedCache<FVector, FPlanetChunk> Cache;
 
     // === CONFIGURAÇÃO ===
     
@@ -154,6 +164,10 @@ protected:
     UPROPERTY()
     int32 MaxCacheSize;
     
+    /** Limite de memória em bytes (0 = apenas limite de entradas) */
+    UPROPERTY()
+    int64 MaxCacheBytes;
+    
     /** Política de substituição */
     UPROPERTY()
     EPlanetCachePolicy ReplacementPolicy;
@@ -164,25 +178,19 @@ protected:
 
     // === ESTATÍSTICAS ===
     
-    /** Hits no cache */
-    UPROPERTY()
-    int32 CacheHits;
-    
-    /** Misses no cache */
-    UPROPERTY()
-    int32 CacheMisses;
-    
-    /** Chunks sincronizados */
+    /** Chunks sincronizados (atualizado com operações atômicas) */
     UPROPERTY()
     int32 ChunksSynchronized;
     
-    /** Chunks removidos */
+    /** Chunks removidos (atualizado com operações atômicas) */
     UPROPERTY()
     int32 ChunksRemoved;
     
-    /** Tempo total de operações */
-    UPROPERTY()
-    float TotalOperationTime;
+    /** Tempo total de operações em ciclos (atualizado com operações atômicas) */
+    volatile int64 TotalOperationCycles = 0;
+    
+    /** Contadores de sincronizações (Add) e buscas (Find) e amostragem do log */
+    mutable FPlanetCacheInstrumentation Instrumentation;
 
     // === COMPONENTES ===
     
@@ -198,25 +206,18 @@ private:
     // === UTILITÁRIOS ===
     
     /**
-     * Atualiza estatísticas de acesso
-     * @param Position - Posição do chunk
-     */
-    void UpdateAccessStats(const FVector& Position);
-    
-    /**
-     * Remove chunk menos usado (LRU)
+     * Callback global de pressão de memória
+     * @param KeepFraction - Fração dos bytes atuais a manter
      */
-    void RemoveLeastRecentlyUsed();
+    void HandleMemoryTrim(float KeepFraction);
     
-    /**
-     * Remove chunk menos frequentemente usado (LFU)
-     */
-    void RemoveLeastFrequentlyUsed();
+    FDelegateHandle MemoryTrimHandle;
     
     /**
-     * Remove chunk aleatório
+     * Acumula o tempo de uma operação
+     * @param StartCycles - Ciclos no início da operação
      */
-    void RemoveRandomChunk();
+    void AddOperationTime(uint64 StartCycles);
     
     /**
      * Calcula hash da posição
@@ -250,4 +251,11 @@ private:
      * @return Eficiência (0-1)
      */
     float CalculateCacheEfficiency() const;
+    
+    /**
+     * Nome legível da política
+     * @param Policy - Política
+     * @return Nome da política
+     */
+    FString GetCachePolicyString(EPlanetCachePolicy Policy) const;
 }; 
\ No newline at end of file
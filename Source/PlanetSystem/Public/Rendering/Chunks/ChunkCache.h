@@ -1,6 +1,8 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Core/Cache/PlanetShardedCache.h"
+#include "Rendering/Chunks/ChunkCompression.h"
 #include "ChunkCache.generated.h"
 
 USTRUCT(BlueprintType)
@@ -20,6 +22,27 @@ struct FChunkData
     UPROPERTY()
     TArray<FVector2D> UVs;
     
+    UPROPERTY()
+    TArray<uint8> BiomeMap;
+    
+    UPROPERTY()
+    TArray<FColor> BiomeWeights;
+    
+    UPROPERTY()
+    TArray<FVector2D> BiomeIndices;
+    
+    UPROPERTY()
+    float MinAltitude = 0.0f;
+    
+    UPROPERTY()
+    float MaxAltitude = 0.0f;
+    
+    UPROPERTY()
+    FBox Bounds = FBox(ForceInit);
+    
+    UPROPERTY()
+    FSphere BoundingSphere = FSphere(ForceInit);
+    
     UPROPERTY()
     uint32 Seed;
     
@@ -35,8 +58,12 @@ struct FChunkData
     UPROPERTY()
     double LastAccessTime;
     
+    /** Measured time to generate this payload; the cost of evicting it */
+    UPROPERTY()
+    float GenerationSeconds;
+    
     FChunkData()
-        : Seed(0), LODLevel(0), LastAccessTime(0.0)
+        : Seed(0), LODLevel(0), LastAccessTime(0.0), GenerationSeconds(0.0f)
     {
     }
     
@@ -49,87 +76,233 @@ struct FChunkData
     {
         LastAccessTime = FPlatformTime::Seconds();
     }
+    
+    /** Heap bytes held by the arrays plus the struct itself */
+    int64 GetAllocatedSize() const
+    {
+        return sizeof(FChunkData) + Vertices.GetAllocatedSize() + Indices.GetAllocatedSize() + Normals.GetAllocatedSize()
+            + UVs.GetAllocatedSize() + BiomeMap.GetAllocatedSize() + BiomeWeights.GetAllocatedSize() + BiomeIndices.GetAllocatedSize();
+    }
 };
 
+/** Immutable payload shared between the cache and the patches using it */
+using FChunkDataRef = TSharedRef<const FChunkData, ESPMode::ThreadSafe>;
+using FChunkDataPtr = TSharedPtr<const FChunkData, ESPMode::ThreadSafe>;
+
+/**
+ * Integer chunk address: quadtree face (root), level and cell coordinates, plus a seed
+ * hashed from the generation config. Cells are 1/2^(Level+1) wide in UV, so a key
+ * converts exactly to and from the float UV rectangle of its patch.
+ */
 USTRUCT(BlueprintType)
 struct FChunkKey
 {
     GENERATED_BODY()
     
     UPROPERTY()
-    FVector2D UVMin;
+    uint8 Face;
     
+    /** Bit 0: UV rectangle runs towards -U, bit 1: towards -V */
     UPROPERTY()
-    FVector2D UVMax;
+    uint8 Flip;
     
     UPROPERTY()
     int32 LODLevel;
     
+    UPROPERTY()
+    int32 X;
+    
+    UPROPERTY()
+    int32 Y;
+    
     UPROPERTY()
     uint32 Seed;
     
     FChunkKey()
-        : LODLevel(0), Seed(0)
+        : Face(0), Flip(0), LODLevel(0), X(0), Y(0), Seed(0)
+    {
+    }
+    
+    FChunkKey(uint8 InFace, int32 InLODLevel, int32 InX, int32 InY, uint32 InSeed, uint8 InFlip = 0)
+        : Face(InFace), Flip(InFlip), LODLevel(InLODLevel), X(InX), Y(InY), Seed(InSeed)
+    {
+    }
+    
+    /** Cell size in UV at a level (roots span half the UV square) */
+    static double GetCellSize(int32 Level)
+    {
+        return 1.0 / double(1 << (Level + 1));
+    }
+    
+    static FChunkKey FromUV(uint8 InFace, const FVector2D& UVMin, const FVector2D& UVMax, int32 InLODLevel, uint32 InSeed)
+    {
+        const double Cells = double(1 << (InLODLevel + 1));
+        const uint8 InFlip = (UVMax.X < UVMin.X ? 1 : 0) | (UVMax.Y < UVMin.Y ? 2 : 0);
+        return FChunkKey(InFace, InLODLevel, FMath::RoundToInt(UVMin.X * Cells), FMath::RoundToInt(UVMin.Y * Cells), InSeed, InFlip);
+    }
+    
+    void ToUV(FVector2D& OutUVMin, FVector2D& OutUVMax) const
     {
+        const double Cell = GetCellSize(LODLevel);
+        OutUVMin = FVector2D(X * Cell, Y * Cell);
+        OutUVMax = OutUVMin + FVector2D((Flip & 1) ? -Cell : Cell, (Flip & 2) ? -Cell : Cell);
     }
     
-    FChunkKey(const FVector2D& InUVMin, const FVector2D& InUVMax, int32 InLODLevel, uint32 InSeed)
-        : UVMin(InUVMin), UVMax(InUVMax), LODLevel(InLODLevel), Seed(InSeed)
+    /** Face 3 bits | Flip 2 | Level 5 | X 27 | Y 27 */
+    uint64 Pack() const
     {
+        return (uint64(Face & 0x7) << 61) | (uint64(Flip & 0x3) << 59) | (uint64(LODLevel & 0x1F) << 54)
+             | (uint64(X & 0x7FFFFFF) << 27) | uint64(Y & 0x7FFFFFF);
     }
     
     bool operator==(const FChunkKey& Other) const
     {
-        return UVMin.Equals(Other.UVMin, 0.001f) && 
-               UVMax.Equals(Other.UVMax, 0.001f) && 
-               LODLevel == Other.LODLevel && 
-               Seed == Other.Seed;
+        return Pack() == Other.Pack() && Seed == Other.Seed;
+    }
+    
+    /** 64-bit finalizer (splitmix64) */
+    static uint64 Mix(uint64 Value)
+    {
+        Value ^= Value >> 30;
+        Value *= 0xBF58476D1CE4E5B9ull;
+        Value ^= Value >> 27;
+        Value *= 0x94D049BB133111EBull;
+        Value ^= Value >> 31;
+        return Value;
+    }
+    
+    /** Full 64-bit hash of the address and seed (also used as the key in access traces) */
+    uint64 GetHash64() const
+    {
+        return Mix(Pack() ^ (uint64(Seed) * 0x9E3779B97F4A7C15ull));
     }
     
     friend uint32 GetTypeHash(const FChunkKey& Key)
     {
-        return FCrc::MemCrc32(&Key, sizeof(Key));
+        const uint64 Hash = Key.GetHash64();
+        return uint32(Hash ^ (Hash >> 32));
     }
 };
 
+class FChunkDiskCache;
+class FPlanetCacheTrace;
+
 UCLASS(Blueprintable, ClassGroup=(Procedural))
 class PLANETSYSTEM_API UChunkCache : public UObject
 {
     GENERATED_BODY()
     
 private:
-    UPROPERTY()
-    TMap<FChunkKey, FChunkData> CachedChunks;
+    /** Sharded, thread-safe LRU core; workers may look up and store chunks directly */
+    TPlanetShardedCache<FChunkKey, FChunkData> Cache;
+    
+    /** Second tier: chunks evicted from the hot tier, kept as compressed heights and rebuilt on a hit */
+    TPlanetShardedCache<FChunkKey, FCompressedChunk> ColdCache;
+    
+    /** Third tier: chunks evicted from memory are spilled here and promoted back on a miss */
+    TUniquePtr<FChunkDiskCache> DiskCache;
+    
+    /** Access trace being recorded (lookups and stores), null when not recording */
+    TSharedPtr<FPlanetCacheTrace, ESPMode::ThreadSafe> Trace;
+    
+    /** Guards swapping Trace; workers only take it while a recording is active */
+    mutable FCriticalSection TraceLock;
+    std::atomic<bool> bTraceActive { false };
     
     UPROPERTY()
     int32 MaxCacheSize = 1000;
     
+    /** Byte budget across all entries (exact allocated sizes); 0 keeps only the entry count limit */
+    UPROPERTY()
+    int64 MaxCacheBytes = 512ll * 1024 * 1024;
+    
     UPROPERTY()
     double CacheTimeoutSeconds = 300.0; // 5 minutes
     
     UPROPERTY()
     bool bEnableCache = true;
     
+    UPROPERTY()
+    EPlanetCachePolicy ReplacementPolicy = EPlanetCachePolicy::LRU;
+    
+    UPROPERTY()
+    bool bEnableColdCache = true;
+    
+    /** Budget for compressed cold chunks (roughly a tenth of a hot chunk each) */
+    UPROPERTY()
+    int64 MaxColdCacheBytes = 64ll * 1024 * 1024;
+    
+    UPROPERTY()
+    bool bEnableDiskCache = true;
+    
+    /** Disk budget for spilled chunks (compressed bytes) */
+    UPROPERTY()
+    int64 MaxDiskCacheBytes = 1024ll * 1024 * 1024;
+    
 public:
     UChunkCache();
+    virtual ~UChunkCache();
+    
+    virtual void PostInitProperties() override;
+    virtual void BeginDestroy() override;
     
     // Cache management
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     void SetMaxCacheSize(int32 NewMaxSize);
     
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void SetMaxCacheBytes(int64 NewMaxBytes);
+    
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     void SetCacheTimeout(double TimeoutSeconds);
     
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     void EnableCache(bool bEnable);
     
-    // Cache operations
+    /** LRU by default; GDSF keeps chunks that were expensive to generate */
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void SetReplacementPolicy(EPlanetCachePolicy Policy);
+    
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    EPlanetCachePolicy GetReplacementPolicy() const { return ReplacementPolicy; }
+    
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void SetMaxColdCacheBytes(int64 NewMaxBytes);
+    
+    /** Toggle the compressed tier; disabling drops its chunks */
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void EnableColdCache(bool bEnable);
+    
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void SetMaxDiskCacheBytes(int64 NewMaxBytes);
+    
+    /** Toggle the disk tier; call from the game thread while no worker uses the cache */
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void EnableDiskCache(bool bEnable);
+    
+    // Cache operations (Blueprint copies; C++ callers use FindChunkData/StoreChunkData)
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     bool GetChunk(const FChunkKey& Key, FChunkData& OutChunkData);
     
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     void StoreChunk(const FChunkKey& Key, const FChunkData& ChunkData);
     
+    /** Shared payload on hit (a refcount bump, no array copies), null on miss; cold and disk hits are promoted to the hot tier */
+    FChunkDataPtr FindChunkData(const FChunkKey& Key);
+    
+    /** Stores a shared payload without copying it; prefetched chunks use a lower priority (cold end under LRU) */
+    void StoreChunkData(const FChunkKey& Key, const FChunkDataRef& ChunkData, float Priority = 1.0f);
+    
+    /**
+     * Moves a chunk from the cold or disk tier into the hot tier at the given priority, for speculative callers
+     * (prefetch). Unlike FindChunkData it is not an access: no hit/miss stats, no trace event, no recency change.
+     * @return True if the chunk is now in the hot tier
+     */
+    bool PromoteChunk(const FChunkKey& Key, float Priority);
+    
+    /** Resident in the hot tier; does not count as an access, touch recency or read the colder tiers */
+    bool ContainsChunk(const FChunkKey& Key) const { return bEnableCache && Cache.Contains(Key); }
+    
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     void RemoveChunk(const FChunkKey& Key);
     
@@ -143,9 +316,18 @@ public:
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     float GetCacheHitRate() const;
     
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    int64 GetCacheBytes() const { return Cache.GetBytes(); }
+    
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     void GetCacheStats(int32& OutSize, int32& OutMaxSize, float& OutHitRate);
     
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void GetColdCacheStats(int32& OutEntries, int64& OutBytes, float& OutHitRate) const;
+    
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void GetDiskCacheStats(int32& OutEntries, int64& OutBytes, float& OutHitRate) const;
+    
     // Maintenance
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     void CleanupExpiredChunks();
@@ -153,11 +335,39 @@ public:
     UFUNCTION(BlueprintCallable, Category="ChunkCache")
     void OptimizeCache();
     
+    // Access traces (start/stop from the game thread; workers may keep looking up and storing meanwhile)
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    void StartTraceRecording();
+    
+    /** Stops recording and writes the trace; false if nothing was recorded or the write failed */
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    bool StopTraceRecording(const FString& FilePath);
+    
+    /** Replays a recorded trace against every policy at the given byte budget and reports hit rates */
+    UFUNCTION(BlueprintCallable, Category="ChunkCache")
+    static FString BenchmarkTrace(const FString& FilePath, int64 MaxBytes);
+    
 private:
-    void EvictOldestChunks(int32 Count);
-    double GetCurrentTime() const;
+    /** Trace being recorded or null; the returned reference keeps it alive if recording stops meanwhile */
+    TSharedPtr<FPlanetCacheTrace, ESPMode::ThreadSafe> GetActiveTrace() const;
+    
+    void CreateDiskCache();
+    void DestroyDiskCache();
+    
+    /** Eviction handlers: hot chunks move to the cold tier (or disk if not compressible), cold chunks to disk */
+    void HandleHotEviction(const FChunkKey& Key, const FChunkDataRef& Data);
+    void HandleColdEviction(const FChunkKey& Key, const FCompressedChunkRef& Compressed);
+    
+    /** Global memory-pressure callback (FPlanetCacheMemory) */
+    void HandleMemoryTrim(float KeepFraction);
+    
+    FDelegateHandle MemoryTrimHandle;
+    
+    /** Disk directory slot (Saved/PlanetChunkCache/P<pid>_Cache<N>) held by this cache; slots are claimed on the game thread */
+    int32 DiskCacheSlot = INDEX_NONE;
+    static TSet<int32> ActiveDiskCacheSlots;
     
-    // Statistics
-    mutable int32 CacheHits = 0;
-    mutable int32 CacheMisses = 0;
+    /** Lock file held open next to the directory while it is in use, so other processes leave it alone */
+    TUniquePtr<FArchive> DiskCacheLock;
+    FString DiskCacheLockPath;
 }; 
\ No newline at end of file
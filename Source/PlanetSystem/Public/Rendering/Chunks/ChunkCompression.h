@@ -0,0 +1,65 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FChunkData;
+
+/**
+ * Compact form of a generated chunk, kept by the cold in-memory tier of UChunkCache.
+ * A generated patch is a regular grid of vertices along the cube-sphere directions of its
+ * UV rectangle, so only the radius of each vertex is stored: 16 bits relative to the
+ * patch's radius range, row-delta coded, then LZ4-compressed together with the biome
+ * streams. Positions and triangle indices are rebuilt from the grid on promotion; the
+ * bounds and altitude range are kept exactly. Radii are within (range / 131070) of the
+ * originals.
+ */
+class PLANETSYSTEM_API FCompressedChunk
+{
+public:
+    /**
+     * Compresses a chunk with the generated grid layout. Returns null when the payload does
+     * not match that layout (custom indices, normals or UVs, off-grid vertices, biome ids
+     * outside a byte); such chunks skip the cold tier.
+     */
+    static TSharedPtr<const FCompressedChunk, ESPMode::ThreadSafe> Compress(const FChunkData& Data);
+
+    /** Rebuilds the full payload, null if the compressed stream is corrupt */
+    TSharedPtr<const FChunkData, ESPMode::ThreadSafe> Decompress() const;
+
+    /** Heap bytes held plus the object itself */
+    int64 GetAllocatedSize() const { return sizeof(FCompressedChunk) + Payload.GetAllocatedSize(); }
+
+    float GetGenerationSeconds() const { return GenerationSeconds; }
+
+    /** Reads or writes every field as is; the disk tier stores cold chunks this way without decompressing them */
+    void Serialize(FArchive& Ar);
+
+private:
+    /** Optional streams present in the payload */
+    enum EStreamFlags : uint8
+    {
+        HasBiomeMap     = 1 << 0,
+        HasBiomeWeights = 1 << 1,
+        HasBiomeIndices = 1 << 2,
+    };
+
+    TArray<uint8> Payload;
+    int32 RawSize = 0;
+    int32 Resolution = 0;
+    uint8 Streams = 0;
+    float MinRadius = 0.0f;
+    float MaxRadius = 0.0f;
+
+    // Copied verbatim from the source chunk
+    float MinAltitude = 0.0f;
+    float MaxAltitude = 0.0f;
+    FBox Bounds = FBox(ForceInit);
+    FSphere BoundingSphere = FSphere(ForceInit);
+    uint32 Seed = 0;
+    int32 LODLevel = 0;
+    FVector2D UVMin = FVector2D::ZeroVector;
+    FVector2D UVMax = FVector2D::ZeroVector;
+    float GenerationSeconds = 0.0f;
+};
+
+using FCompressedChunkRef = TSharedRef<const FCompressedChunk, ESPMode::ThreadSafe>;
+using FCompressedChunkPtr = TSharedPtr<const FCompressedChunk, ESPMode::ThreadSafe>;
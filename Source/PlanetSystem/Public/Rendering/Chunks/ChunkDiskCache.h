@@ -0,0 +1,100 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Rendering/Chunks/ChunkCache.h"
+#include "Rendering/Chunks/ChunkCompression.h"
+
+/**
+ * Disk tier behind UChunkCache. Chunks evicted from memory are serialized, LZ4-compressed
+ * and written by a thread-pool task; chunks from the cold tier are written in their
+ * compressed form as is, so spilling them never rebuilds the full payload; lookups read them back synchronously (a compressed
+ * chunk decodes much faster than noise + erosion regenerate it). The index lives in memory,
+ * so the directory only holds chunks from the current session and is deleted on destruction.
+ */
+class PLANETSYSTEM_API FChunkDiskCache
+{
+public:
+    struct FStats
+    {
+        int32 Entries = 0;
+        int64 Bytes = 0;
+        int64 Hits = 0;
+        int64 Misses = 0;
+        int64 Writes = 0;
+        int64 Dropped = 0;
+    };
+
+    /** Payloads waiting to be written are capped; spills beyond this are dropped */
+    static constexpr int64 MaxPendingBytes = 64ll * 1024 * 1024;
+
+    FChunkDiskCache(const FString& InDirectory, int64 InMaxBytes);
+    ~FChunkDiskCache();
+
+    FChunkDiskCache(const FChunkDiskCache&) = delete;
+    FChunkDiskCache& operator=(const FChunkDiskCache&) = delete;
+
+    /** Disk budget in bytes (compressed file sizes); oldest files are deleted first */
+    void SetMaxBytes(int64 InMaxBytes);
+
+    /** Queues a payload for writing; returns immediately */
+    void Spill(const FChunkKey& Key, const FChunkDataRef& Data);
+
+    /** Queues a cold-tier chunk for writing without decompressing it */
+    void Spill(const FChunkKey& Key, const FCompressedChunkRef& Compressed);
+
+    /** Payload from a pending write or from disk, null on miss; speculative reads pass bCountAccess = false to leave the hit rate alone */
+    FChunkDataPtr Load(const FChunkKey& Key, bool bCountAccess = true);
+
+    void Remove(const FChunkKey& Key);
+    void Clear();
+
+    /** Blocks until every queued spill has been written */
+    void Flush();
+
+    FStats GetStats() const;
+
+private:
+    /** Compressed file of one chunk */
+    struct FDiskRecord
+    {
+        FString Path;
+    };
+
+    /** Queued chunk: a full payload or a cold-tier compressed one */
+    struct FPendingChunk
+    {
+        FChunkDataPtr Data;
+        FCompressedChunkPtr Compressed;
+
+        int64 GetAllocatedSize() const { return Data.IsValid() ? Data->GetAllocatedSize() : Compressed->GetAllocatedSize(); }
+        bool operator==(const FPendingChunk& Other) const { return Data == Other.Data && Compressed == Other.Compressed; }
+    };
+
+    void Enqueue(const FChunkKey& Key, FPendingChunk&& Chunk);
+    void StartWriter();
+    void WritePending();
+    bool WriteChunk(const FChunkKey& Key, const FPendingChunk& Chunk, int64& OutFileBytes) const;
+    FChunkDataPtr ReadChunk(const FString& Path) const;
+    FString GetChunkPath(const FChunkKey& Key) const;
+
+    FString Directory;
+
+    /** Files on disk, LRU by access with the disk budget as byte limit; evictions delete the file */
+    TPlanetShardedCache<FChunkKey, FDiskRecord> Index;
+
+    mutable FCriticalSection PendingMutex;
+    TMap<FChunkKey, FPendingChunk> Pending;
+    TArray<FChunkKey> PendingOrder;
+    int64 PendingBytes = 0;
+    bool bWriterActive = false;
+
+    /** Key the writer is writing outside the lock; Remove marks it so the finished file is deleted instead of indexed */
+    TOptional<FChunkKey> WritingKey;
+    bool bWritingKeyRemoved = false;
+    TFuture<void> Writer;
+
+    std::atomic<int64> Hits { 0 };
+    std::atomic<int64> Misses { 0 };
+    std::atomic<int64> Writes { 0 };
+    std::atomic<int64> Dropped { 0 };
+};
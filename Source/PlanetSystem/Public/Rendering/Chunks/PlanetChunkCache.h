@@ -3,6 +3,8 @@
 #include "UObject/NoExportTypes.h"
 #include "Rendering/Chunks/ChunkCache.h"
 #include "Common/PlanetTypes.h"
+#include "Core/Cache/PlanetShardedCache.h"
+#include "Core/Cache/PlanetCacheInstrumentation.h"
 #include "PlanetChunkCache.generated.h"
 
 // Forward declarations
@@ -11,7 +13,9 @@ struct FPlanetChunk;
 
 /**
  * Sistema de cache avançado para chunks do PlanetSystem
- * Gerenciamento inteligente de memória e performance
+ * Fachada sobre TPlanetShardedCache com política por prioridade e limite em MB;
+ * pode ser usado por workers. Consultas e inserções só contam em contadores atômicos; eventos,
+ * profiler e log detalhado ficam para operações amostradas na game thread (FPlanetCacheInstrumentation)
  * Segue o padrão AAA data-driven inspirado na Source2
  */
 UCLASS(BlueprintType, Blueprintable)
@@ -22,6 +26,9 @@ class PLANETSYSTEM_API UPlanetChunkCache : public UObject
 public:
     UPlanetChunkCache();
     
+    virtual void PostInitProperties() override;
+    virtual void BeginDestroy() override;
+    
     /**
      * Obtém a instância singleton do ChunkCache
      * @return Instância do ChunkCache
@@ -31,12 +38,14 @@ public:
     
     /**
      * Adiciona um chunk ao cache
+     * @param ChunkKey Chave do chunk
      * @param Chunk Chunk a ser adicionado
      * @param Priority Prioridade do chunk
+     * @param GenerationCost Tempo medido de geração do chunk em segundos (política GDSF)
      * @return true se adicionou com sucesso
      */
     UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
-    bool AddChunk(const FPlanetChunk& Chunk, float Priority = 1.0f);
+    bool AddChunk(const FString& ChunkKey, const FPlanetChunk& Chunk, float Priority = 1.0f, float GenerationCost = 0.0f);
     
     /**
      * Obtém um chunk do cache
@@ -47,6 +56,13 @@ public:
     UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
     bool GetChunk(const FString& ChunkKey, FPlanetChunk& OutChunk);
     
+    /**
+     * Obtém o chunk compartilhado, sem cópia (C++)
+     * @param ChunkKey Chave do chunk
+     * @return Chunk ou nullptr
+     */
+    TSharedPtr<const FPlanetChunk, ESPMode::ThreadSafe> FindChunk(const FString& ChunkKey);
+    
     /**
      * Remove um chunk do cache
      * @param ChunkKey Chave do chunk
@@ -68,7 +84,7 @@ public:
      * @param OutStats String com estatísticas
      */
     UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
-    void GetCacheStats(FString& OutStats) const;
+    void GetCacheStats(FString& OutStats);
     
     /**
      * Limpa o cache
@@ -78,7 +94,7 @@ public:
     void ClearCache(bool bForce = false);
     
     /**
-     * Otimiza o cache (remove chunks de baixa prioridade)
+     * Otimiza o cache: encolhe para 80% do orçamento pela política de substituição
      */
     UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
     void OptimizeCache();
@@ -90,12 +106,22 @@ public:
     UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
     void SetMaxCacheSize(int32 MaxSize);
     
+    /**
+     * Define a política de substituição (padrão: Priority)
+     * @param Policy Política
+     */
+    UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
+    void SetReplacementPolicy(EPlanetCachePolicy Policy);
+    
+    UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
+    EPlanetCachePolicy GetReplacementPolicy() const;
+    
     /**
      * Obtém o tamanho atual do cache
-     * @return Tamanho em MB
+     * @return Tamanho em bytes (soma dos tamanhos alocados dos chunks)
      */
     UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
-    int32 GetCurrentCacheSize() const;
+    int64 GetCurrentCacheSize() const;
     
     /**
      * Habilita/desabilita o cache
@@ -111,45 +137,45 @@ public:
     UFUNCTION(BlueprintCallable, Category="PlanetChunkCache")
     bool IsCacheEnabled() const;
     
+    // Análise do cache
+    TArray<FString> GetAllChunkKeys() const;
+    int32 GetChunkAccessCount(const FString& ChunkKey) const;
+    float GetChunkPriority(const FString& ChunkKey) const;
+    float GetChunkLastAccessTime(const FString& ChunkKey) const;
+    int64 GetChunkSize(const FString& ChunkKey) const;
+    void GetMostAccessedChunks(int32 Count, TArray<TPair<FString, int32>>& OutMostAccessed) const;
+    void GetLargestChunks(int32 Count, TArray<TPair<FString, int64>>& OutLargestChunks) const;
+    void GetOldestChunks(int32 Count, TArray<TPair<FString, float>>& OutOldestChunks) const;
+    float GetHitRate() const;
+    int64 GetTotalHits() const;
+    int64 GetTotalMisses() const;
+    int32 GetEntryCount() const;
+    float GetCacheUsagePercent() const;
+    
 private:
     // Instância singleton
     static UPlanetChunkCache* Instance;
     
-    // Estrutura para entrada do cache
-    struct FCacheEntry
-    {
-        FPlanetChunk Chunk;
-        float Priority;
-        float LastAccessTime;
-        int32 AccessCount;
-        int32 SizeInBytes;
-        
-        FCacheEntry(const FPlanetChunk& InChunk, float InPriority)
-            : Chunk(InChunk), Priority(InPriority), LastAccessTime(FPlatformTime::Seconds())
-            , AccessCount(1), SizeInBytes(0)
-        {}
-    };
-    
-    // Mapa do cache
-    UPROPERTY()
-    TMap<FString, FCacheEntry> CacheEntries;
+    /** Callback global de pressão de memória (FPlanetCacheMemory) */
+    void HandleMemoryTrim(float KeepFraction);
     
-    // Configurações
-    UPROPERTY()
-    int32 MaxCacheSizeMB = 1024;
+    FDelegateHandle MemoryTrimHandle;
     
-    UPROPERTY()
-    bool bCacheEnabled = true;
+    int64 GetMaxCacheBytes() const { return int64(MaxCacheSizeMB) * 1024 * 1024; }
     
-    UPROPERTY()
-    int32 CurrentCacheSizeBytes = 0;
+    // Núcleo do cache (thread-safe)
+    TPlanetShardedCache<FString, FPlanetChunk> Cache;
+    
+    // Contadores por operação (HasChunk é const)
+    mutable FPlanetCacheInstrumentation Instrumentation;
     
+    // Configurações
     UPROPERTY()
-    int32 TotalHits = 0;
+    int32 MaxCacheSizeMB = 1024;
     
     UPROPERTY()
-    int32 TotalMisses = 0;
+    bool bCacheEnabled = true;
     
     UPROPERTY()
     float LastOptimizationTime = 0.0f;
-}; 
\ No newline at end of file
+};
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ConvexVolume.h"
+
+/**
+ * Estado de visibilidade de um observador em relação ao planeta
+ * Combina frustum da câmera e horizonte do planeta (esfera oclusora no raio mínimo da superfície)
+ */
+struct PLANETSYSTEM_API FPlanetCullingView
+{
+    FVector ViewOrigin = FVector::ZeroVector;
+    FConvexVolume Frustum;
+    bool bHasFrustum = false;
+
+    FVector PlanetCenter = FVector::ZeroVector;
+    float OccluderRadius = 0.f;
+
+    /**
+     * Monta o frustum a partir dos parâmetros da câmera
+     * @param Location Posição da câmera
+     * @param Rotation Rotação da câmera
+     * @param FOVDegrees Campo de visão horizontal
+     * @param AspectRatio Largura / altura do viewport
+     */
+    void SetFrustum(const FVector& Location, const FRotator& Rotation, float FOVDegrees, float AspectRatio);
+
+    /**
+     * Define a esfera oclusora do horizonte
+     * @param Center Centro do planeta (mundo)
+     * @param Radius Raio mínimo da superfície
+     */
+    void SetPlanet(const FVector& Center, float Radius);
+
+    /** A esfera está dentro do frustum (sempre true sem frustum) */
+    bool IsInFrustum(const FSphere& Bounds) const;
+
+    /** A esfera está inteiramente atrás do horizonte do planeta */
+    bool IsBeyondHorizon(const FSphere& Bounds) const;
+
+    /** Frustum e horizonte combinados */
+    bool IsVisible(const FSphere& Bounds) const { return IsInFrustum(Bounds) && !IsBeyondHorizon(Bounds); }
+};
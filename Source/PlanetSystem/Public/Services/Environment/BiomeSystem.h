@@ -2,6 +2,7 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "Configuration/DataAssets/CoreConfig.h"
+#include "HAL/CriticalSection.h"
 #include "BiomeSystem.generated.h"
 
 UENUM(BlueprintType)
@@ -14,6 +15,31 @@ enum class EBiomeType : uint8
     Snow
 };
 
+constexpr int32 BiomeTypeCount = int32(EBiomeType::Snow) + 1;
+
+/**
+ * Pesos de mistura dos 4 biomas mais fortes por vértice, prontos para o material
+ * Weights: RGBA = pesos (somam 255); Indices: X = i0 + i1*8, Y = i2 + i3*8
+ */
+struct FBiomeBlendStream
+{
+    TArray<FColor> Weights;
+    TArray<FVector2D> Indices;
+};
+
+/**
+ * Tabela de biomas decodificada uma única vez a partir da textura de lookup
+ * Imutável depois de publicada: o ponteiro é trocado sob FRWLock e cada leitor pega a referência
+ * com um read lock curto; as células são lidas fora do lock enquanto a referência estiver viva
+ */
+struct FBiomeLookupTable
+{
+    TArray<uint8> Cells;
+    int32 SizeX = 0;
+    int32 SizeY = 0;
+    uint32 Hash = 0;    // CRC das células: parte de GetConfigHash
+};
+
 UCLASS(Blueprintable, ClassGroup=(Procedural), meta=(BlueprintSpawnableComponent))
 class PLANETSYSTEM_API UBiomeSystem : public UObject
 {
@@ -26,10 +52,106 @@ public:
     FBiomeConfig BiomeConfig;
 
     EBiomeType GetBiome(float Altitude, float Slope, float Humidity) const;
+
+    /**
+     * Classifica vários pontos de uma vez usando a tabela de lookup (thread-safe)
+     * @param Altitudes Altitude de cada ponto
+     * @param Slopes Inclinação de cada ponto (0-1)
+     * @param Humidities Umidade de cada ponto (0-1)
+     * @param OutBiomes Bioma de cada ponto (EBiomeType empacotado em uint8)
+     */
+    void GetBiomes(TArrayView<const float> Altitudes, TArrayView<const float> Slopes,
+                   TArrayView<const float> Humidities, TArrayView<uint8> OutBiomes) const;
+
+    /**
+     * Classificação por regras (altura, inclinação, temperatura, umidade) avaliada 4 pontos por vez, sem desvios
+     * Se houver textura de lookup ela tem precedência (ver GetBiomes)
+     * @param Altitudes Altitude de cada ponto acima do raio base
+     * @param Slopes Inclinação de cada ponto (0 = plano, 1 = vertical)
+     * @param Temperatures Temperatura normalizada (0-1)
+     * @param Humidities Umidade normalizada (0-1)
+     * @param OutBiomes Bioma de cada ponto (EBiomeType empacotado em uint8)
+     * @param OutWeights Opcional: pesos suaves por bioma, BiomeTypeCount blocos de Num valores
+     */
+    void ClassifyBiomes(TArrayView<const float> Altitudes, TArrayView<const float> Slopes,
+                        TArrayView<const float> Temperatures, TArrayView<const float> Humidities,
+                        TArrayView<uint8> OutBiomes, TArrayView<float> OutWeights = TArrayView<float>()) const;
+
+    /**
+     * Classifica cada vértice de um patch em grade (Res+1)x(Res+1)
+     * @param Vertices Vértices do patch
+     * @param Resolution Resolução da grade
+     * @param PlanetRadius Raio base do planeta
+     * @param OutBiomeMap Bioma por vértice
+     * @param OutBlend Opcional: pesos de mistura top-4 calculados na mesma passada
+     */
+    void ClassifyPatch(const TArray<FVector>& Vertices, int32 Resolution, float PlanetRadius, TArray<uint8>& OutBiomeMap,
+                       FBiomeBlendStream* OutBlend = nullptr) const;
+
+    /**
+     * Suaviza as transições de um mapa de biomas com blur separável dos pesos
+     * @param BiomeMap Mapa de biomas em grade quadrada
+     */
+    void SmoothBiomeTransitions(TArray<EBiomeType>& BiomeMap) const;
+
+    /**
+     * Blur de caixa separável (horizontal e vertical) sobre os pesos de cada bioma
+     * @param Weights Pesos em blocos por bioma (BiomeTypeCount x Size x Size)
+     * @param Size Lado da grade
+     * @param Radius Raio do blur em vértices
+     */
+    static void BlurBiomeWeights(TArray<float>& Weights, int32 Size, int32 Radius);
+
+    /**
+     * Seleciona os 4 biomas mais fortes por vértice e empacota pesos e índices
+     * @param Weights Pesos em blocos por bioma
+     * @param Num Número de vértices
+     * @param OutBlend Stream empacotado
+     * @param OutBiomeMap Opcional: bioma dominante por vértice
+     */
+    static void PackBiomeBlend(const TArray<float>& Weights, int32 Num, FBiomeBlendStream& OutBlend, TArray<uint8>* OutBiomeMap = nullptr);
+
+    /** Temperatura normalizada por latitude (1 = equador, 0 = polo) */
+    static float CalculateTemperature(float Latitude);
+
+    /** Umidade normalizada a partir de altura (0-1) e temperatura */
+    static float CalculateHumidity(float Height, float Temperature);
+
+    /**
+     * Troca a textura de lookup e reconstrói a tabela (game thread)
+     * @param NewLookup Nova textura de lookup
+     */
+    UFUNCTION(BlueprintCallable, Category="Biomes")
+    void SetBiomeLookup(UTexture2D* NewLookup);
+
+    /** Decodifica a textura de lookup para a tabela em memória (game thread) */
+    UFUNCTION(BlueprintCallable, Category="Biomes")
+    void RebuildLookupTable();
     
     UFUNCTION(BlueprintCallable, Category="Biomes")
     void SetBiomeConfig(const FBiomeConfig& NewConfig);
     
     UFUNCTION(BlueprintCallable, Category="Biomes")
     FBiomeConfig GetBiomeConfig() const { return BiomeConfig; }
+
+    /** Hash da configuração e da tabela de lookup: muda sempre que a classificação dos biomas pode mudar */
+    uint32 GetConfigHash() const;
+
+    virtual void PostLoad() override;
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+    typedef TSharedPtr<const FBiomeLookupTable, ESPMode::ThreadSafe> FLookupTableRef;
+
+    /** Referência para a tabela ativa; o leitor a segura durante a consulta */
+    FLookupTableRef GetLookupTable() const;
+
+    /** Publica uma nova tabela (ou nenhuma); a antiga é liberada quando o último leitor a soltar */
+    void SetLookupTable(FLookupTableRef NewTable);
+
+    /** Tabela ativa; o lock protege só a troca do ponteiro, nunca a leitura das células */
+    FLookupTableRef ActiveLookupTable;
+    mutable FRWLock LookupTableLock;
 };
@@ -0,0 +1,70 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Tile de amostras Poisson-disk em um toro unitário
+ * Ranks seguem uma ordem progressiva (farthest-point): qualquer prefixo continua bem distribuído,
+ * então filtrar por Rank < Densidade mantém o padrão blue-noise em densidades menores.
+ */
+struct FPoissonDiskTile
+{
+    TArray<FVector2D> Points;
+    TArray<float> Ranks;
+};
+
+/**
+ * Amostrador Poisson-disk determinístico e repetível
+ * Um único tile (seed fixa) ladrilha um espaço 2D comum a todos os patches, ancorado na origem:
+ * cada patch visita só a janela que cobre, então amostras de patches vizinhos vêm do mesmo
+ * ladrilho e o raio mínimo vale também através das bordas. Variantes por célula quebrariam o raio
+ * nas bordas dos tiles (cada variante só fecha com ela mesma); a variação fica no hash da amostra.
+ */
+class PLANETSYSTEM_API FPoissonDiskSampler
+{
+public:
+    /** Distância mínima entre amostras em unidades de tile */
+    static constexpr float TileRadius = 1.0f / 32.0f;
+
+    /** Tile pré-calculado (thread-safe, construído no primeiro acesso) */
+    static const FPoissonDiskTile& GetTile();
+
+    /** Hash determinístico de uma célula da grade de tiles */
+    static uint32 HashCell(int32 X, int32 Y, uint32 Seed);
+
+    /**
+     * Visita as amostras do ladrilho global dentro de [Origin, Origin+Extent) em unidades de tile
+     * @param Origin Canto da janela no espaço comum (ex.: UV da face em unidades de tile)
+     * @param Seed Só altera o hash das amostras; deve ser o mesmo para patches que se tocam
+     * @param Visit Chamado com (posição relativa a Origin em unidades de tile, Rank 0-1, hash da amostra)
+     */
+    template<typename FunctorType>
+    static void ForEachSample(const FVector2D& Origin, float ExtentX, float ExtentY, uint32 Seed, FunctorType&& Visit)
+    {
+        const FPoissonDiskTile& Tile = GetTile();
+        const int32 FirstX = FMath::FloorToInt(Origin.X);
+        const int32 FirstY = FMath::FloorToInt(Origin.Y);
+        const int32 EndX = FMath::CeilToInt(Origin.X + ExtentX);
+        const int32 EndY = FMath::CeilToInt(Origin.Y + ExtentY);
+
+        for (int32 TY = FirstY; TY < EndY; ++TY)
+        {
+            for (int32 TX = FirstX; TX < EndX; ++TX)
+            {
+                const uint32 CellHash = HashCell(TX, TY, Seed);
+
+                for (int32 i = 0; i < Tile.Points.Num(); ++i)
+                {
+                    const FVector2D Position(TX + Tile.Points[i].X - Origin.X, TY + Tile.Points[i].Y - Origin.Y);
+                    if (Position.X < 0.0f || Position.Y < 0.0f || Position.X >= ExtentX || Position.Y >= ExtentY)
+                    {
+                        continue;
+                    }
+                    Visit(Position, Tile.Ranks[i], HashCombine(CellHash, uint32(i)));
+                }
+            }
+        }
+    }
+
+private:
+    static void BuildTile(uint32 Seed, FPoissonDiskTile& OutTile);
+};
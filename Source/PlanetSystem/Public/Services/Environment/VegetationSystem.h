@@ -1,16 +1,244 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Containers/Queue.h"
 #include "Services/Environment/BiomeSystem.h"
+#include "Common/PlanetTypes.h"
 #include "VegetationSystem.generated.h"
 
+/** Nível de detalhe da vegetação de um patch */
+UENUM(BlueprintType)
+enum class EVegetationTier : uint8
+{
+    None,       // longe: sem vegetação
+    Sparse,     // distância média: densidade reduzida / impostores
+    Dense       // perto: densidade total
+};
+
+/** Cópia dos parâmetros de posicionamento entregue às worker threads */
+struct FVegetationPlacementSettings
+{
+    /** Distância mínima entre instâncias com densidade 1 (unidades de mundo) */
+    float SampleSpacing = 40.0f;
+
+    /** Multiplicador de densidade do tier */
+    float DensityScale = 1.0f;
+
+    /** Fração das amostras Poisson mantidas em cada bioma */
+    float BiomeDensity[BiomeTypeCount] = {};
+};
+
+/**
+ * Onde o patch fica na face: as amostras Poisson são ancoradas nesse espaço, então patches
+ * vizinhos (de qualquer nível) compartilham as mesmas amostras nas bordas
+ */
+struct FVegetationPatchRegion
+{
+    FVector2D UVMin = FVector2D(0.0f, 0.0f);
+    FVector2D UVMax = FVector2D(1.0f, 1.0f);
+
+    /** Comprimento em unidades de mundo de UV 0-1 na face */
+    float FaceWorldSize = 1.0f;
+
+    /** Seed das amostras (yaw/escala): a mesma para todos os patches da face */
+    uint32 Seed = 0;
+};
+
+/** Instâncias de vegetação de um patch calculadas fora da game thread */
+struct FVegetationPatchBuffer
+{
+    uint64 PatchId = 0;
+    uint32 Serial = 0;
+    EVegetationTier Tier = EVegetationTier::None;
+    TArray<FPackedVegetationInstance> Instances;
+    FBox Bounds = FBox(ForceInit);
+};
+
 UCLASS(ClassGroup=(Procedural), meta=(BlueprintSpawnableComponent))
 class PLANETSYSTEM_API UVegetationSystem : public UObject
 {
     GENERATED_BODY()
 public:
+    UVegetationSystem();
+
     UPROPERTY(EditAnywhere, Category="Vegetation")
     UHierarchicalInstancedStaticMeshComponent* HISM = nullptr;
 
-    void Populate(const TArray<FVector>& Vertices, const TArray<int32>& Indices, EBiomeType Biome, uint32 Seed);
+    /** Distância mínima entre instâncias com densidade 1 (unidades de mundo) */
+    UPROPERTY(EditAnywhere, Category="Vegetation|Distribution", meta=(ClampMin="1"))
+    float SampleSpacing = 40.0f;
+
+    /** Densidade por bioma (0-1): fração das amostras Poisson-disk mantidas */
+    UPROPERTY(EditAnywhere, Category="Vegetation|Distribution")
+    TMap<EBiomeType, float> BiomeDensity;
+
+    /** HISM opcional para o tier esparso (impostores); sem ele o tier esparso usa o HISM principal */
+    UPROPERTY(EditAnywhere, Category="Vegetation|LOD")
+    UHierarchicalInstancedStaticMeshComponent* ImpostorHISM = nullptr;
+
+    /** Até esta distância do observador a vegetação é densa */
+    UPROPERTY(EditAnywhere, Category="Vegetation|LOD", meta=(ClampMin="0"))
+    float DenseDistance = 3000.0f;
+
+    /** Até esta distância a vegetação é esparsa; além dela não há vegetação */
+    UPROPERTY(EditAnywhere, Category="Vegetation|LOD", meta=(ClampMin="0"))
+    float SparseDistance = 10000.0f;
+
+    /** Nível mínimo do patch para receber vegetação densa */
+    UPROPERTY(EditAnywhere, Category="Vegetation|LOD", meta=(ClampMin="0"))
+    int32 DenseMinLevel = 2;
+
+    /** Nível mínimo do patch para receber qualquer vegetação */
+    UPROPERTY(EditAnywhere, Category="Vegetation|LOD", meta=(ClampMin="0"))
+    int32 SparseMinLevel = 0;
+
+    /** Fração da densidade mantida no tier esparso */
+    UPROPERTY(EditAnywhere, Category="Vegetation|LOD", meta=(ClampMin="0", ClampMax="1"))
+    float SparseDensityScale = 0.2f;
+
+    /** Parâmetros atuais copiados para uso fora da game thread */
+    FVegetationPlacementSettings GetPlacementSettings(EVegetationTier Tier = EVegetationTier::Dense) const;
+
+    /**
+     * Tier de um patch pelo nível na quadtree e distância ao observador
+     * @param Level Nível do patch
+     * @param ViewerDistance Distância do observador ao patch
+     */
+    EVegetationTier ComputeTier(int32 Level, float ViewerDistance) const;
+
+    /**
+     * Atualiza o tier de um patch: só reagenda quando o tier muda (game thread)
+     * @param PatchId Identificador do patch (FPatchNode::GetPatchId)
+     * @param Level Nível do patch
+     * @param ViewerDistance Distância do observador ao patch
+     * @param Vertices Vértices do patch
+     * @param BiomeMap Bioma por vértice
+     * @param Region Posição do patch na face
+     */
+    void UpdatePatch(uint64 PatchId, int32 Level, float ViewerDistance,
+                     const TArray<FVector>& Vertices, const TArray<uint8>& BiomeMap, const FVegetationPatchRegion& Region);
+
+    /**
+     * Agenda o posicionamento da vegetação de um patch em uma worker thread
+     * Ignorado se o patch já estiver pendente ou aplicado com o mesmo tier; instâncias já aplicadas
+     * continuam no HISM até o commit do novo resultado
+     * @param PatchId Identificador do patch (FPatchNode::GetPatchId)
+     * @param Tier Tier de vegetação
+     * @param Vertices Vértices do patch (copiados para a tarefa)
+     * @param BiomeMap Bioma por vértice
+     * @param Region Posição do patch na face
+     */
+    void PopulateAsync(uint64 PatchId, EVegetationTier Tier, const TArray<FVector>& Vertices, const TArray<uint8>& BiomeMap,
+                       const FVegetationPatchRegion& Region);
+
+    /**
+     * Remove patches que saíram da árvore (split ou merge) (game thread)
+     * As instâncias de um patch que saiu ficam até o commit dos patches em voo que cobrem a mesma
+     * região (os filhos no split, o pai no merge), sem buraco de vegetação entre um e outro
+     * @param ActivePatches Patches presentes na atualização atual
+     */
+    void PruneStalePatches(const TSet<uint64>& ActivePatches);
+
+    /**
+     * Aplica no HISM os buffers prontos, um AddInstances por patch (game thread)
+     * @param MaxPatches Limite de patches aplicados nesta chamada
+     * @return Número de patches aplicados
+     */
+    int32 CommitPendingPatches(int32 MaxPatches = MAX_int32);
+
+    /** Remove as instâncias de um patch e descarta resultados ainda em voo (game thread) */
+    void RemovePatch(uint64 PatchId);
+
+    /** Remove todas as instâncias e descarta resultados em voo (game thread) */
+    void ClearAllPatches();
+
+    bool HasPatch(uint64 PatchId) const;
+    EVegetationTier GetPatchTier(uint64 PatchId) const;
+    int32 GetNumCommittedPatches() const { return CommittedPatches.Num(); }
+    int32 GetNumInstances() const { return Layers[0].InstanceOwners.Num() + Layers[1].InstanceOwners.Num(); }
+
+    /**
+     * Posicionamento Poisson-disk sobre a grade do patch, puro e seguro para qualquer thread
+     * @param Settings Parâmetros de distribuição
+     * @param Vertices Vértices do patch em grade (Res+1)x(Res+1)
+     * @param BiomeMap Bioma por vértice
+     * @param Region Posição do patch na face (âncora das amostras)
+     * @param OutInstances Instâncias aceitas, empacotadas (TypeIndex = MakeTypeIndex(bioma, 0))
+     * @param OutBounds Limites usados na quantização das posições
+     */
+    static void BuildInstances(const FVegetationPlacementSettings& Settings, const TArray<FVector>& Vertices, const TArray<uint8>& BiomeMap,
+                               const FVegetationPatchRegion& Region, TArray<FPackedVegetationInstance>& OutInstances, FBox& OutBounds);
+
+    /**
+     * Decodifica instâncias empacotadas em transformações, alinhadas à normal da esfera
+     * @param Instances Instâncias empacotadas
+     * @param Bounds Limites usados na quantização
+     * @param OutTransforms Transformações decodificadas
+     */
+    static void DecodeInstances(TArrayView<const FPackedVegetationInstance> Instances, const FBox& Bounds, TArray<FTransform>& OutTransforms);
+
+    virtual void BeginDestroy() override;
+
+private:
+    using FCompletedQueue = TQueue<FVegetationPatchBuffer, EQueueMode::Mpsc>;
+
+    /** Fila compartilhada com as tarefas, sobrevive ao UObject se necessário */
+    TSharedPtr<FCompletedQueue, ESPMode::ThreadSafe> CompletedQueue = MakeShared<FCompletedQueue, ESPMode::ThreadSafe>();
+
+    struct FInFlightPatch
+    {
+        uint32 Serial = 0;
+        EVegetationTier Tier = EVegetationTier::None;
+        FVegetationPatchRegion Region;
+    };
+
+    struct FCommittedPatch
+    {
+        EVegetationTier Tier = EVegetationTier::None;
+        int32 Layer = 0;
+        TArray<int32> Slots;
+        FVegetationPatchRegion Region;
+    };
+
+    /** Dono de uma instância: patch e posição dela em FCommittedPatch::Slots (ajuste O(1) na compactação) */
+    struct FInstanceOwner
+    {
+        uint64 PatchId = 0;
+        int32 SlotIndex = INDEX_NONE;
+    };
+
+    /** Instâncias de um HISM; o dono de cada instância espelha a compactação feita na remoção */
+    struct FInstanceLayer
+    {
+        TArray<FInstanceOwner> InstanceOwners;
+    };
+
+    /** Remove do HISM as instâncias aplicadas de um patch, sem mexer em pedidos em voo */
+    void RemoveCommittedInstances(uint64 PatchId);
+
+    /** Remove os patches retidos cuja região não tem mais nenhum patch em voo por cima */
+    void ReleaseRetainedPatches();
+
+    /** Mesma face (seed da região) e interiores das regiões UV se sobrepõem (bordas encostadas não contam) */
+    static bool RegionsOverlap(const FVegetationPatchRegion& A, const FVegetationPatchRegion& B);
+
+    UHierarchicalInstancedStaticMeshComponent* GetLayerComponent(int32 Layer) const;
+    int32 GetLayerForTier(EVegetationTier Tier) const;
+
+    /** Requisição mais recente de cada patch em voo; resultados antigos são descartados */
+    TMap<uint64, FInFlightPatch> InFlight;
+
+    /** Tier e índices das instâncias de cada patch aplicado */
+    TMap<uint64, FCommittedPatch> CommittedPatches;
+
+    /** Patches aplicados que saíram da árvore, mantidos até o commit de quem os substitui */
+    TSet<uint64> RetainedPatches;
+
+    /** 0 = HISM principal, 1 = HISM de impostores */
+    FInstanceLayer Layers[2];
+
+    /** Buffer reutilizado na decodificação em lote do commit */
+    TArray<FTransform> DecodeScratch;
+
+    uint32 NextSerial = 1;
 };
@@ -1,8 +1,12 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Common/PlanetTypes.h"
+#include "Services/Terrain/RiverNetworkBuilder.h"
 #include "WaterComponent.generated.h"
 
+struct FPatchNode;
+
 UCLASS(ClassGroup=(Procedural), meta=(BlueprintSpawnableComponent))
 class PLANETSYSTEM_API UWaterComponent : public UActorComponent
 {
@@ -11,5 +15,90 @@ public:
     UPROPERTY(EditAnywhere, Category="Water")
     float SeaLevel = 0.f;
 
-    void GenerateOcean(class UProceduralMeshComponent* MeshComp, float PlanetRadius);
+    UPROPERTY(EditAnywhere, Category="Water")
+    UMaterialInterface* OceanMaterial = nullptr;
+
+    /** Acumulação mínima (em células drenadas) para uma célula virar rio */
+    UPROPERTY(EditAnywhere, Category="Water|Rivers", meta=(ClampMin="2"))
+    float RiverAccumulationThreshold = 64.f;
+
+    /** Tiles mantidos na rede de rios; acima disso sai o usado há mais tempo */
+    UPROPERTY(EditAnywhere, Category="Water|Rivers", meta=(ClampMin="1"))
+    int32 MaxRiverTiles = 256;
+
+    /**
+     * Gera a superfície do oceano reaproveitando os patches LOD do terreno no raio do nível do mar
+     * Patches totalmente acima do nível do mar não geram seção
+     * @param MeshComp Componente de mesh do planeta
+     * @param PlanetRadius Raio base do planeta
+     * @param Patches Patches de terreno ativos (com MinAltitude calculado)
+     * @param FirstSection Primeira seção reservada para o oceano
+     * @return Número de seções de oceano criadas
+     */
+    int32 GenerateOcean(class UProceduralMeshComponent* MeshComp, float PlanetRadius,
+                        const TArray<FPatchNode*>& Patches, int32 FirstSection);
+
+    /** Remove as seções de oceano criadas anteriormente */
+    void ClearOcean(class UProceduralMeshComponent* MeshComp);
+
+    /** O patch tem algum ponto abaixo do nível do mar? */
+    bool NeedsOcean(float MinAltitude) const { return MinAltitude < SeaLevel; }
+
+    /**
+     * Grade do patch projetada na esfera de raio Radius (mesma parametrização dos patches de terreno)
+     * @param UVMin Canto mínimo do patch
+     * @param UVMax Canto máximo do patch
+     * @param Resolution Resolução da grade
+     * @param Radius Raio da superfície
+     * @param OutVertices Vértices
+     * @param OutNormals Normais (radiais)
+     */
+    static void BuildSurfacePatch(const FVector2D& UVMin, const FVector2D& UVMax, int32 Resolution, float Radius,
+                                  TArray<FVector>& OutVertices, TArray<FVector>& OutNormals);
+
+    /** Índices compartilhados de uma grade (Res+1)x(Res+1), calculados uma vez por resolução */
+    const TArray<int32>& GetGridIndices(int32 Resolution);
+
+    /**
+     * Superfície de oceano de um chunk plano do gerador de terreno
+     * Vazia se nenhum ponto do mapa de altura estiver abaixo do nível do mar
+     * @param Chunk Chunk com mapa de altura
+     * @param ChunkSize Lado do chunk em unidades de mundo
+     * @param OutOceanSystem Oceano gerado
+     */
+    void GenerateOceanSystem(const FPlanetChunk& Chunk, float ChunkSize, FOceanSystem& OutOceanSystem);
+
+    /**
+     * Rios de um chunk: o chunk entra como tile da rede de rios e as polylines acima do limiar são extraídas
+     * Chunks vizinhos do mesmo LOD (mesmo ChunkSize) trocam vazão pelas bordas
+     * @param Chunk Chunk com mapa de altura
+     * @param ChunkSize Lado do chunk em unidades de mundo
+     * @param OutRiverSystem Rios do chunk
+     */
+    void GenerateRiverSystem(const FPlanetChunk& Chunk, float ChunkSize, FRiverSystem& OutRiverSystem);
+
+    /**
+     * Tira o chunk da rede de rios (descarregado); os vizinhos deixam de receber a vazão dele
+     * @param Chunk Chunk descarregado
+     * @param ChunkSize Lado do chunk em unidades de mundo
+     */
+    void ReleaseRiverChunk(const FPlanetChunk& Chunk, float ChunkSize);
+
+    /** Rede de rios compartilhada entre os chunks */
+    FRiverNetworkBuilder& GetRiverNetwork() { return RiverNetwork; }
+
+private:
+    void TouchRiverTile(const FIntPoint& Coord, int32 Layer);
+
+    FRiverNetworkBuilder RiverNetwork;
+
+    /** Último uso de cada tile da rede (Coord.X, Coord.Y, LOD) */
+    TMap<FIntVector, uint64> RiverTileUse;
+    uint64 RiverTileClock = 0;
+
+    /** Índices por resolução: todas as seções de oceano de mesma resolução compartilham a topologia */
+    TMap<int32, TArray<int32>> GridIndexCache;
+
+    int32 FirstOceanSection = INDEX_NONE;
+    int32 NumOceanSections = 0;
 };
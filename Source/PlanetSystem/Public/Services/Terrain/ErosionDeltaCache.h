@@ -0,0 +1,142 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Cache persistente de deltas de erosão
+ * A erosão é determinística por (PatchSeed, resolução, configuração), então o resultado
+ * é guardado em disco como deltas de altura quantizados e comprimidos.
+ * O arquivo é mapeado em memória na inicialização e descartado quando o hash da configuração muda.
+ * Flush só acrescenta os payloads novos e um índice novo no fim do arquivo; a reescrita completa
+ * acontece quando o espaço morto (índices antigos, entradas substituídas ou podadas) passa do vivo.
+ * Acima de MaxBytes as entradas usadas há mais tempo são descartadas.
+ */
+class PLANETSYSTEM_API FErosionDeltaCache
+{
+public:
+    /** Deltas na precisão do cache: int16 relativo ao maior delta absoluto do patch */
+    struct FQuantizedDeltas
+    {
+        TArray<int16> Values;
+        float Scale = 0.0f;
+
+        /** Mesmos valores que Find devolve para estes deltas */
+        void Dequantize(TArray<float>& OutDeltas) const;
+    };
+
+    static constexpr int64 DefaultMaxBytes = 128ll * 1024 * 1024;
+
+    FErosionDeltaCache(const FString& InFilePath, uint32 InConfigHash, int64 InMaxBytes = DefaultMaxBytes);
+    ~FErosionDeltaCache();
+
+    /**
+     * Mapeia o arquivo de cache e carrega o índice
+     * @return true se havia um arquivo válido para a configuração atual
+     */
+    bool Open();
+
+    /**
+     * Procura os deltas de um patch
+     * @param Key Chave do patch (ver MakeKey)
+     * @param NumVertices Número esperado de vértices
+     * @param OutDeltas Deltas de altura por vértice
+     * @return true se encontrou
+     */
+    bool Find(uint64 Key, int32 NumVertices, TArray<float>& OutDeltas) const;
+
+    /**
+     * Armazena os deltas de um patch (persistidos no próximo Flush)
+     * @param Key Chave do patch
+     * @param Deltas Deltas já quantizados (ver Quantize)
+     */
+    void Store(uint64 Key, const FQuantizedDeltas& Deltas);
+
+    /**
+     * Quantiza deltas para a precisão do cache
+     * Quem gera os deltas deve aplicar a versão dequantizada: um patch gerado agora e o mesmo patch
+     * lido do cache depois ficam idênticos.
+     */
+    static FQuantizedDeltas Quantize(const TArray<float>& Deltas);
+
+    /**
+     * Descarta todas as entradas e o arquivo em disco
+     * @param NewConfigHash Hash da nova configuração de erosão
+     */
+    void Invalidate(uint32 NewConfigHash);
+
+    /**
+     * Grava as entradas pendentes em disco e remapeia o arquivo
+     * @return true se gravou com sucesso
+     */
+    bool Flush();
+
+    uint32 GetConfigHash() const;
+    int32 GetNumEntries() const;
+
+    /** Bytes comprimidos de todas as entradas (em disco e pendentes) */
+    int64 GetLiveBytes() const;
+
+    /** Limite de bytes das entradas; reduzir poda na hora */
+    void SetMaxBytes(int64 InMaxBytes);
+    void GetStats(int32& OutHits, int32& OutMisses) const;
+
+    /**
+     * Monta a chave de um patch
+     * @param PatchSeed Seed do patch
+     * @param Resolution Resolução da grade
+     * @param InputHash Hash das alturas de entrada (protege contra mudanças no noise)
+     */
+    static uint64 MakeKey(uint32 PatchSeed, int32 Resolution, uint32 InputHash);
+
+private:
+    /** Entrada do índice; o payload vive no arquivo mapeado ou em PendingPayload */
+    struct FEntry
+    {
+        int64 Offset = 0;
+        int32 CompressedSize = 0;
+        int32 NumDeltas = 0;
+        float Scale = 0.0f;
+        mutable uint64 LastUse = 0;
+        TArray<uint8> PendingPayload;
+
+        bool IsPending() const { return PendingPayload.Num() > 0; }
+    };
+
+    const uint8* GetPayload(const FEntry& Entry) const;
+
+    /** Mapeia o arquivo atual sem mexer no índice em memória */
+    bool MapFile();
+    void CloseMapping();
+
+    /** Descarta as entradas usadas há mais tempo até caber em TargetBytes */
+    void PruneToBudget(int64 TargetBytes);
+
+    /** Acrescenta payloads pendentes, índice e rodapé ao fim do arquivo */
+    bool AppendPending();
+
+    /** Reescreve o arquivo só com as entradas vivas */
+    bool Rewrite();
+
+    FString FilePath;
+    uint32 ConfigHash = 0;
+    int64 MaxBytes = DefaultMaxBytes;
+    bool bDirty = false;
+
+    /** Um append falhou no meio: o fim do arquivo não é confiável até a próxima reescrita */
+    bool bNeedsRewrite = false;
+
+    TMap<uint64, FEntry> Entries;
+    int64 LiveBytes = 0;
+    int64 FileSize = 0;
+    mutable uint64 UseClock = 0;
+
+    TUniquePtr<IMappedFileHandle> MappedFile;
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+
+    mutable FCriticalSection Mutex;
+    mutable int32 Hits = 0;
+    mutable int32 Misses = 0;
+};
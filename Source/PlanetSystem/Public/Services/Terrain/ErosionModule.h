@@ -3,6 +3,8 @@
 #include "UObject/NoExportTypes.h"
 #include "ErosionModule.generated.h"
 
+class FErosionDeltaCache;
+
 UCLASS(Blueprintable, ClassGroup=(Procedural), meta=(BlueprintSpawnableComponent))
 class PLANETSYSTEM_API UErosionModule : public UObject
 {
@@ -26,5 +28,40 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Erosion")
     int32 MaxSteps = 30;
 
+    /** Maior variação de altura que a erosão aplica em um vértice; os limites estimados do LOD contam com ela */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Erosion", meta=(ClampMin="0"))
+    float MaxHeightChange = 50.0f;
+
+    /** Reaproveita deltas de erosão gravados em disco entre execuções */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Erosion|Cache")
+    bool bEnableDeltaCache = true;
+
+    /** Limite do arquivo de deltas; acima dele saem as entradas usadas há mais tempo */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Erosion|Cache", meta=(ClampMin="1"))
+    int32 DeltaCacheMaxMB = 128;
+
     void ApplyHydraulicErosion(TArray<FVector>& Vertices, int32 Resolution, uint32 Seed);
+
+    /**
+     * Abre (mapeia) o cache de deltas de erosão em disco
+     * @param CacheFilePath Caminho do arquivo de cache
+     */
+    void InitializeDeltaCache(const FString& CacheFilePath);
+
+    /** Grava em disco as entradas novas do cache de deltas */
+    void FlushDeltaCache();
+
+    /** Quanto a erosão pode subir ou descer um vértice (0 se desligada) */
+    float GetMaxHeightChange() const { return bEnableHydraulic ? MaxHeightChange : 0.f; }
+
+    /** Hash dos parâmetros que afetam o resultado da erosão */
+    uint32 GetConfigHash() const;
+
+protected:
+    virtual void BeginDestroy() override;
+
+private:
+    void SimulateHydraulicErosion(TArray<float>& HeightMap, int32 Resolution, uint32 Seed) const;
+
+    TSharedPtr<FErosionDeltaCache, ESPMode::ThreadSafe> DeltaCache;
 };
@@ -0,0 +1,111 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Extração de rede de rios por acumulação de fluxo em tiles de altura
+ * Cada tile é processado de forma independente (em paralelo): preenchimento de depressões
+ * por priority-flood com fila de buckets (tempo linear), direções D8 e acumulação em ordem topológica,
+ * com as bordas do tile como saídas. Toda célula drena para uma saída de borda, e as bacias dessas
+ * saídas formam um grafo pequeno: bacias vizinhas através de uma borda se ligam com peso igual à
+ * elevação de transbordo (a maior das duas alturas). Um priority-flood sobre esse grafo, a partir do
+ * sumidouro (bordas sem tile vizinho), diz para qual bacia cada uma verte. O resultado é uma árvore,
+ * então a vazão atravessa as bordas em uma única passada, sem ciclos e sem subir ladeira.
+ * Os tiles são reamostrados para um tamanho fixo e agrupados em camadas (ex.: nível de LOD):
+ * só tiles da mesma camada trocam água.
+ */
+class PLANETSYSTEM_API FRiverNetworkBuilder
+{
+public:
+    /** Tile de entrada em uma grade 2D de tiles (coordenadas inteiras) */
+    struct FTileInput
+    {
+        FIntPoint Coord = FIntPoint::ZeroValue;
+        int32 Layer = 0;                // tiles só trocam água com a mesma camada (ex.: nível de LOD)
+        int32 Size = 0;                 // lado da grade (Size x Size alturas), reamostrada para GetTileSize()
+        TArray<float> Heights;
+        TArray<FVector> Positions;      // opcional: posição de mundo de cada célula para as polylines
+    };
+
+    /** Número de buckets da fila de prioridade do preenchimento */
+    static constexpr int32 NumHeightBuckets = 4096;
+
+    /** Lado padrão dos tiles depois da reamostragem */
+    static constexpr int32 DefaultTileSize = 65;
+
+    explicit FRiverNetworkBuilder(int32 InTileSize = DefaultTileSize);
+
+    /**
+     * Adiciona ou substitui um tile (processado no próximo Build)
+     * Grades de outro tamanho são reamostradas (bilinear) para GetTileSize()
+     * @param Input Alturas do tile
+     */
+    void SetTile(FTileInput&& Input);
+
+    /** Remove um tile; a vazão que ele mandava aos vizinhos some no próximo Build */
+    void RemoveTile(const FIntPoint& Coord, int32 Layer);
+
+    /** Remove todos os tiles */
+    void Reset();
+
+    /**
+     * Processa os tiles alterados em paralelo e refaz o roteamento entre tiles pelo grafo de transbordo
+     * @return Número de tiles cuja acumulação mudou
+     */
+    int32 Build();
+
+    /**
+     * Gera polylines de rios nas células com acumulação acima do limiar
+     * @param Threshold Acumulação mínima (em células drenadas)
+     * @param OutRivers Polylines (cada uma com pelo menos 2 pontos)
+     */
+    void ExtractRivers(float Threshold, TArray<TArray<FVector>>& OutRivers) const;
+
+    /** Polylines de um único tile (rios que entram por outro tile começam na célula de entrada) */
+    void ExtractRivers(const FIntPoint& Coord, int32 Layer, float Threshold, TArray<TArray<FVector>>& OutRivers) const;
+
+    /** Acumulação total de uma célula (0 se o tile não existir) */
+    float GetAccumulation(const FIntPoint& Coord, int32 Layer, int32 X, int32 Y) const;
+
+    int32 GetNumTiles() const { return Tiles.Num(); }
+    int32 GetTileSize() const { return TileSize; }
+
+private:
+    /** Valor de Down das saídas de borda: a água deixa o tile */
+    static constexpr int32 ExitsTile = -1;
+
+    struct FTile
+    {
+        FTileInput Input;
+        TArray<float> Filled;               // alturas após o preenchimento
+        TArray<int32> Down;                 // célula a jusante no tile, ou ExitsTile
+        TArray<int32> Order;                // ordem topológica (montante primeiro)
+        TArray<int32> Outlets;              // células com ExitsTile
+        TArray<int32> Outlet;               // por célula: índice em Outlets da saída para onde drena
+        TArray<float> Local;                // acumulação só das células do próprio tile
+        TMap<int32, float> Inflow;          // vazão de outros tiles por célula de entrada
+        TArray<float> Total;                // Local + Inflow roteado até a saída
+        bool bDirty = true;
+    };
+
+    /** Chave de um tile: (Coord.X, Coord.Y, Layer) */
+    static FIntVector MakeKey(const FIntPoint& Coord, int32 Layer) { return FIntVector(Coord.X, Coord.Y, Layer); }
+
+    void Resample(FTileInput& Input) const;
+
+    static void FillDepressions(const TArray<float>& Heights, int32 Size, TArray<float>& OutFilled);
+    static void ComputeFlow(FTile& Tile);
+    static void Accumulate(FTile& Tile);
+
+    /** Soma Amount em Total ao longo do caminho D8 de Cell até a saída */
+    static void AddAlongPath(FTile& Tile, int32 Cell, float Amount);
+
+    /** Priority-flood no grafo de bacias: vazão que entra em cada tile, por célula de entrada */
+    void RouteBetweenTiles(TMap<FIntVector, TMap<int32, float>>& OutInflow) const;
+
+    void ExtractTileRivers(const FTile& Tile, float Threshold, TArray<TArray<FVector>>& OutRivers) const;
+    FIntPoint GlobalCell(const FTile& Tile, int32 Index) const;
+    FVector GetCellPosition(const FTile& Tile, int32 Index) const;
+
+    int32 TileSize = DefaultTileSize;
+    TMap<FIntVector, FTile> Tiles;
+};